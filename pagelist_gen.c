@@ -1,26 +1,142 @@
+#include "trace.h"
 #include "types.h"
+#include "util.h"
 #include <assert.h>
+#include <math.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <strings.h>
 #include <time.h>
+#include <unistd.h>
+
+#define USAGE                                                                  \
+  "Usage: %s [-t] [-i <trace_file>] [-b <trace_file>] "                       \
+  "[-w uniform|zipf|phases|scan|loop] [-s <seed>] <num_lines> "               \
+  "<locality_percentage> [<avg_lifetime>]\n"
+
+// random number generator behind every choice, seeded with -s or the time
+static rng_t rng;
+// write percentage of each region of the address space
+static const int write_percent[WORKLOAD_REGIONS] = WORKLOAD_WRITE_PERCENT;
+
+// start the workload model of a new process over, with a hot set shuffled
+// across its address space (Fisher-Yates) and a loop starting anywhere
+void start_workload(workload_state_t *ws) {
+  for (int i = 0; i < PROC_MAX_PAGES; i++) {
+    ws->hot_pages[i] = i;
+  }
+  for (int i = PROC_MAX_PAGES - 1; i > 0; i--) {
+    const int j = rng_below(&rng, i + 1);
+    const int page = ws->hot_pages[i];
+    ws->hot_pages[i] = ws->hot_pages[j];
+    ws->hot_pages[j] = page;
+  }
+
+  ws->accesses = 0;
+  ws->scan_left = 0;
+  ws->scan_page = 0;
+  ws->loop_start = rng_below(&rng, PROC_MAX_PAGES);
+}
+
+// draw the next page of a process from its workload model, zipf being the
+// alias table of the Zipf ranks
+int draw_page(const workload_model_t model, workload_state_t *ws,
+              const alias_table_t *zipf) {
+  switch (model) {
+  case WORKLOAD_ZIPF:
+  case WORKLOAD_SCAN:
+    return ws->hot_pages[alias_sample(zipf, &rng)];
+  case WORKLOAD_PHASES: {
+    // the ranks move over the shuffled pages, so every phase has a hot set of
+    // its own
+    const long shift = ws->accesses / WORKLOAD_PHASE_LENGTH *
+                       WORKLOAD_PHASE_SHIFT;
+    return ws->hot_pages[(alias_sample(zipf, &rng) + shift) % PROC_MAX_PAGES];
+  }
+  case WORKLOAD_LOOP:
+    return (ws->loop_start + ws->accesses % WORKLOAD_LOOP_PAGES) %
+           PROC_MAX_PAGES;
+  default:
+    return rng_below(&rng, PROC_MAX_PAGES);
+  }
+}
 
 // writes a filename with num_lines of: <00-(MAX_PAGES-1) page> <R/W operation>
-void write_pagelist(const char *filename, int num_lines,
-                    int locality_percentage) {
+// pages are drawn from the workload model, or with locality_percentage chance
+// are a step from the last page, except during scans. writes make up
+// write_percent of the accesses to the page's region
+// if avg_lifetime is positive, the process exits after avg_lifetime accesses on
+// average, writing an X line, followed by up to PROC_MAX_IDLE_ROUNDS idle "-"
+// lines and an S line for the next process spawning in the same slot.
+// every line gets an arrival time, with random gaps averaging
+// TRACE_MEAN_GAP * proc_id, written at the start of the line if timestamped.
+// lines are also stored in records, when not NULL, for interleaved traces
+void write_pagelist(const char *filename, int proc_id, int num_lines,
+                    int locality_percentage, int avg_lifetime,
+                    bool timestamped, const workload_model_t model,
+                    const alias_table_t *zipf, trace_record_t *records) {
   FILE *file = fopen(filename, "w");
   if (file == NULL) {
     perror("Error opening file");
     exit(1);
   }
 
+  workload_state_t ws;
+  start_workload(&ws);
+
   int last_page = -1;
+  // rounds left until the next process spawns, -1 while a process is running
+  int idle_rounds = -1;
+  long timestamp = 0;
 
   for (int i = 0; i < num_lines; i++) {
-    int page;
+    int page = -1;
+    char operation;
 
-    if (last_page != -1 && (rand() % 100) < locality_percentage) {
+    timestamp += 1 + rng_below(&rng, 2 * TRACE_MEAN_GAP * proc_id);
+    if (timestamped)
+      fprintf(file, "%ld ", timestamp);
+
+    if (idle_rounds == 0) {
+      // new process, with no locality relative to the previous one
+      operation = 'S';
+      idle_rounds = -1;
+      last_page = -1;
+      start_workload(&ws);
+    } else if (idle_rounds > 0) {
+      operation = '-';
+      idle_rounds--;
+    } else if (avg_lifetime > 0 && i > 0 &&
+               rng_below(&rng, avg_lifetime) == 0) {
+      operation = 'X';
+      idle_rounds = rng_below(&rng, PROC_MAX_IDLE_ROUNDS + 1);
+    } else {
+      operation = 0; // memory access, decided below
+    }
+
+    if (operation != 0) {
+      fprintf(file, "%c\n", operation);
+      if (records != NULL)
+        records[i] = (trace_record_t){timestamp, -1, proc_id, operation, 0};
+      continue;
+    }
+
+    // periodic scans go through the address space in order
+    if (model == WORKLOAD_SCAN && ws.accesses > 0 &&
+        ws.accesses % WORKLOAD_SCAN_INTERVAL == 0) {
+      ws.scan_left = WORKLOAD_SCAN_LENGTH;
+      ws.scan_page = rng_below(&rng, PROC_MAX_PAGES);
+    }
+
+    if (ws.scan_left > 0) {
+      page = ws.scan_page;
+      ws.scan_page = (ws.scan_page + 1) % PROC_MAX_PAGES;
+      ws.scan_left--;
+    } else if (last_page != -1 &&
+               rng_below(&rng, 100) < locality_percentage) {
       // local
-      int locality_choice = rand() % 3;
+      int locality_choice = rng_below(&rng, 3);
       if (locality_choice == 0) {
         // same page
         page = last_page;
@@ -32,14 +148,17 @@ void write_pagelist(const char *filename, int num_lines,
         page = (last_page - 1 + PROC_MAX_PAGES) % PROC_MAX_PAGES;
       }
     } else {
-      // random
-      page = rand() % PROC_MAX_PAGES;
+      page = draw_page(model, &ws, zipf);
     }
 
     last_page = page;
+    ws.accesses++;
 
-    char operation = (rand() % 2) ? 'R' : 'W';
+    const int region = page / (PROC_MAX_PAGES / WORKLOAD_REGIONS);
+    operation = rng_below(&rng, 100) < write_percent[region] ? 'W' : 'R';
     fprintf(file, "%02d %c\n", page, operation);
+    if (records != NULL)
+      records[i] = (trace_record_t){timestamp, page, proc_id, operation, 0};
   }
 
   printf("Generated %s with %d IO operations, %d%% locality\n", filename,
@@ -48,24 +167,138 @@ void write_pagelist(const char *filename, int num_lines,
   fclose(file);
 }
 
+// merge the records of the four processes by timestamp into an interleaved
+// trace (k-way merge), ties going to the lowest process ID
+void write_interleaved_trace(const char *filename, const bool binary,
+                             trace_record_t **records, int num_lines) {
+  trace_file_t *trace = trace_create(filename, binary);
+  int next[4] = {0};
+
+  for (int i = 0; i < num_lines * 4; i++) {
+    int earliest = -1;
+
+    for (int p = 0; p < 4; p++) {
+      if (next[p] < num_lines &&
+          (earliest == -1 || records[p][next[p]].timestamp <
+                                 records[earliest][next[earliest]].timestamp))
+        earliest = p;
+    }
+
+    trace_write(trace, &records[earliest][next[earliest]++]);
+  }
+
+  printf("Generated %s %s trace with %d records\n", filename,
+         binary ? "binary" : "text", num_lines * 4);
+
+  trace_close(trace);
+}
+
 int main(int argc, char **argv) {
-  if (argc != 3) {
-    fprintf(stderr, "Usage: %s <num_lines> <locality_percentage>\n", argv[0]);
+  bool timestamped = false;
+  const char *trace_filename = NULL;
+  bool trace_binary = false;
+  workload_model_t model = WORKLOAD_UNIFORM;
+  const char *model_name = "uniform";
+  uint64_t seed = time(NULL);
+
+  // parse command line options
+  int opt;
+  while ((opt = getopt(argc, argv, "ti:b:w:s:")) != -1) {
+    switch (opt) {
+    case 't':
+      timestamped = true;
+      break;
+    case 'i':
+      trace_filename = optarg;
+      trace_binary = false;
+      break;
+    case 'b':
+      trace_filename = optarg;
+      trace_binary = true;
+      break;
+    case 'w':
+      model_name = optarg;
+      if (strcasecmp(optarg, "uniform") == 0) {
+        model = WORKLOAD_UNIFORM;
+      } else if (strcasecmp(optarg, "zipf") == 0) {
+        model = WORKLOAD_ZIPF;
+      } else if (strcasecmp(optarg, "phases") == 0) {
+        model = WORKLOAD_PHASES;
+      } else if (strcasecmp(optarg, "scan") == 0) {
+        model = WORKLOAD_SCAN;
+      } else if (strcasecmp(optarg, "loop") == 0) {
+        model = WORKLOAD_LOOP;
+      } else {
+        fprintf(stderr, "Error: Invalid workload model %s\n", optarg);
+        fprintf(stderr, USAGE, argv[0]);
+        exit(2);
+      }
+      break;
+    case 's':
+      seed = strtoull(optarg, NULL, 10);
+      break;
+    default:
+      fprintf(stderr, USAGE, argv[0]);
+      exit(2);
+    }
+  }
+
+  // remaining positional args
+  char **args = argv + optind;
+  const int num_args = argc - optind;
+
+  if (num_args != 2 && num_args != 3) {
+    fprintf(stderr, USAGE, argv[0]);
     exit(2);
   }
 
-  int num_lines = atoi(argv[1]);
-  int locality_percentage = atoi(argv[2]);
+  int num_lines = atoi(args[0]);
+  int locality_percentage = atoi(args[1]);
+  int avg_lifetime = num_args == 3 ? atoi(args[2]) : 0;
   assert(num_lines > 0);
   assert(locality_percentage >= 0 && locality_percentage <= 100);
+  assert(avg_lifetime >= 0);
 
-  srand(time(NULL));
+  // regions must tile the address space
+  assert(PROC_MAX_PAGES % WORKLOAD_REGIONS == 0);
+  assert(WORKLOAD_LOOP_PAGES <= PROC_MAX_PAGES);
+  rng_seed(&rng, seed);
+  printf("Workload %s, seed %llu\n", model_name, (unsigned long long)seed);
 
-  write_pagelist(PAGELIST_P1_FILE, num_lines, locality_percentage);
-  write_pagelist(PAGELIST_P2_FILE, num_lines, locality_percentage);
-  write_pagelist(PAGELIST_P3_FILE, num_lines, locality_percentage);
-  write_pagelist(PAGELIST_P4_FILE, num_lines, locality_percentage);
+  // the Zipf weight of the page at each rank of a hot set
+  double weights[PROC_MAX_PAGES];
+  for (int i = 0; i < PROC_MAX_PAGES; i++) {
+    weights[i] = pow(i + 1, -WORKLOAD_ZIPF_THETA);
+  }
+  alias_table_t *zipf = create_alias_table(weights, PROC_MAX_PAGES);
+
+  const char *pagelist_files[] = {PAGELIST_P1_FILE, PAGELIST_P2_FILE,
+                                  PAGELIST_P3_FILE, PAGELIST_P4_FILE};
+  trace_record_t *records[4] = {NULL};
+
+  for (int p = 0; p < 4; p++) {
+    if (trace_filename != NULL) {
+      records[p] =
+          (trace_record_t *)malloc(num_lines * sizeof(trace_record_t));
+      if (records[p] == NULL) {
+        fprintf(stderr, "Malloc error\n");
+        exit(1);
+      }
+    }
+
+    write_pagelist(pagelist_files[p], p + 1, num_lines, locality_percentage,
+                   avg_lifetime, timestamped, model, zipf, records[p]);
+  }
+
+  if (trace_filename != NULL) {
+    write_interleaved_trace(trace_filename, trace_binary, records, num_lines);
+
+    for (int p = 0; p < 4; p++) {
+      free(records[p]);
+    }
+  }
 
+  free_alias_table(zipf);
   printf("Finished\n");
 
   return 0;
@@ -1,13 +1,111 @@
+#include "trace.h"
 #include "types.h"
 #include "util.h"
 #include <assert.h>
 #include <fcntl.h>
 #include <semaphore.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+// exit on a malformed pagelist line
+static void pagelist_error(const int proc_id, const int line,
+                           const char *what) {
+  fprintf(stderr, "Error in pagelist_P%d line %d: %s\n", proc_id, line, what);
+  exit(13);
+}
+
+// simulates a single process: waits for its semaphore to be posted by
+// vmem_sim, then sends the next memory io request from its pagelist through
+// its pipe. each process runs in its own child, so that vmem_sim may schedule
+// them in any order, or not at all (e.g. while suspended by load control).
+// timestamped pagelists have an arrival time at the start of each line
+static void run_process(const int proc_id, const char *sem_name,
+                        const char *pagelist_file, const int pipe_write,
+                        const int num_rounds, const bool timestamped) {
+  sem_t *sem = sem_open(sem_name, 0);
+  if (sem == SEM_FAILED) {
+    perror("Sem error");
+    exit(2);
+  }
+
+  FILE *pagelist = fopen(pagelist_file, "r");
+  if (pagelist == NULL) {
+    perror("File error");
+    exit(6);
+  }
+
+  long last_timestamp = 0;
+
+  // main loop, wait for sem and send memory io request through pipe
+  for (int i = 0; i < num_rounds; i++) {
+    vmem_io_request_t req;
+    char token[16];
+
+    sem_wait(sem);
+
+    req.timestamp = 0;
+    if (timestamped) {
+      if (fscanf(pagelist, "%ld", &req.timestamp) != 1) {
+        fprintf(stderr, "Error reading pagelist_P%d\n", proc_id);
+        exit(7);
+      }
+      if (req.timestamp < last_timestamp)
+        pagelist_error(proc_id, i + 1, "timestamps must be non-decreasing");
+      last_timestamp = req.timestamp;
+    }
+
+    // each line is either "<page> <R/W operation>" or a lifecycle event
+    if (fscanf(pagelist, "%15s", token) != 1) {
+      fprintf(stderr, "Error reading pagelist_P%d\n", proc_id);
+      exit(7);
+    }
+    req.proc_id = proc_id;
+    req.shared_id = 0;
+
+    long page;
+    char event;
+    if (!trace_parse_token(token, &page, &event))
+      pagelist_error(proc_id, i + 1, "invalid page ID");
+
+    if (event != '\0') {
+      req.proc_page_id = -1;
+      req.operation = event;
+    } else {
+      if (fscanf(pagelist, " %c", &req.operation) != 1) {
+        fprintf(stderr, "Error reading pagelist_P%d\n", proc_id);
+        exit(7);
+      }
+      // a page ID in place of the operation is the page of a timestamped line
+      if (req.operation >= '0' && req.operation <= '9')
+        pagelist_error(proc_id, i + 1,
+                       "timestamped pagelists must be run with -m");
+      if (page < 0 || page >= PROC_MAX_PAGES)
+        pagelist_error(proc_id, i + 1, "page ID out of range");
+      req.proc_page_id = (int)page;
+      if (req.operation != 'R' && req.operation != 'W')
+        pagelist_error(proc_id, i + 1, "invalid operation");
+    }
+    if (write(pipe_write, &req, sizeof(req)) == -1) {
+      perror("Pipe write error");
+      exit(8);
+    }
+
+    dmsg("procs_sim sent P%d: %02d %c", proc_id, req.proc_page_id,
+         req.operation);
+  }
+
+  // cleanup
+  sem_close(sem);
+  close(pipe_write);
+  fclose(pagelist);
+
+  dmsg("procs_sim P%d finished", proc_id);
+}
+
 int main(void) {
   dmsg("procs_sim started");
   int pipe_P1[2], pipe_P2[2], pipe_P3[2], pipe_P4[2];
@@ -22,6 +120,7 @@ int main(void) {
   const char *pipe_P4_read_str = getenv("PIPE_P4_READ");
   const char *pipe_P4_write_str = getenv("PIPE_P4_WRITE");
   const char *num_rounds_str = getenv("NUM_ROUNDS");
+  const bool timestamped = getenv("TIMESTAMPED") != NULL;
 
   const int num_rounds = atoi(num_rounds_str);
   pipe_P1[PIPE_READ] = atoi(pipe_P1_read_str);
@@ -40,139 +139,42 @@ int main(void) {
   close(pipe_P3[PIPE_READ]);
   close(pipe_P4[PIPE_READ]);
 
-  // open syncing semaphores
-  sem_t *sem_P1, *sem_P2, *sem_P3, *sem_P4;
-
-  sem_P1 = sem_open(SEM_P1_NAME, 0);
-  if (sem_P1 == SEM_FAILED) {
-    perror("Sem error");
-    exit(2);
-  }
-  sem_P2 = sem_open(SEM_P2_NAME, 0);
-  if (sem_P2 == SEM_FAILED) {
-    perror("Sem error");
-    exit(2);
-  }
-  sem_P3 = sem_open(SEM_P3_NAME, 0);
-  if (sem_P3 == SEM_FAILED) {
-    perror("Sem error");
-    exit(2);
-  }
-  sem_P4 = sem_open(SEM_P4_NAME, 0);
-  if (sem_P4 == SEM_FAILED) {
-    perror("Sem error");
-    exit(2);
-  }
-
-  // open pagelist files containing the memory io requests
-  FILE *pagelist_P1 = fopen(PAGELIST_P1_FILE, "r");
-  if (pagelist_P1 == NULL) {
-    perror("File error");
-    exit(6);
-  }
-  FILE *pagelist_P2 = fopen(PAGELIST_P2_FILE, "r");
-  if (pagelist_P2 == NULL) {
-    perror("File error");
-    exit(6);
-  }
-  FILE *pagelist_P3 = fopen(PAGELIST_P3_FILE, "r");
-  if (pagelist_P3 == NULL) {
-    perror("File error");
-    exit(6);
-  }
-  FILE *pagelist_P4 = fopen(PAGELIST_P4_FILE, "r");
-  if (pagelist_P4 == NULL) {
-    perror("File error");
-    exit(6);
-  }
-
-  // main loop, wait for sem and send memory io request through pipes
-  for (int i = 0; i < num_rounds; i++) {
-    vmem_io_request_t req;
-
-    // Process 1
-    sem_wait(sem_P1);
-
-    if (fscanf(pagelist_P1, "%d %c", &req.proc_page_id, &req.operation) != 2) {
-      fprintf(stderr, "Error reading pagelist_P1\n");
-      exit(7);
-    }
-    req.proc_id = 1;
-    assert(req.proc_page_id >= 0 && req.proc_page_id < PROC_MAX_PAGES);
-    assert(req.operation == 'R' || req.operation == 'W');
-    if (write(pipe_P1[PIPE_WRITE], &req, sizeof(req)) == -1) {
-      perror("Pipe write error");
-      exit(8);
+  const char *sem_names[] = {SEM_P1_NAME, SEM_P2_NAME, SEM_P3_NAME,
+                             SEM_P4_NAME};
+  const char *pagelist_files[] = {PAGELIST_P1_FILE, PAGELIST_P2_FILE,
+                                  PAGELIST_P3_FILE, PAGELIST_P4_FILE};
+  const int pipe_writes[] = {pipe_P1[PIPE_WRITE], pipe_P2[PIPE_WRITE],
+                             pipe_P3[PIPE_WRITE], pipe_P4[PIPE_WRITE]};
+
+  // spawn a child for each simulated process (P1, P2, P3, P4)
+  for (int p = 0; p < 4; p++) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      perror("Fork error");
+      exit(5);
+    } else if (pid == 0) {
+      // child, keeping only its own pipe write open, so the pipe closes if
+      // it exits early
+      for (int other = 0; other < 4; other++) {
+        if (other != p)
+          close(pipe_writes[other]);
+      }
+
+      run_process(p + 1, sem_names[p], pagelist_files[p], pipe_writes[p],
+                  num_rounds, timestamped);
+      exit(EXIT_SUCCESS);
     }
-
-    dmsg("procs_sim sent P1: %02d %c", req.proc_page_id, req.operation);
-
-    // Process 2
-    sem_wait(sem_P2);
-
-    if (fscanf(pagelist_P2, "%d %c", &req.proc_page_id, &req.operation) != 2) {
-      fprintf(stderr, "Error reading pagelist_P2\n");
-      exit(7);
-    }
-    req.proc_id = 2;
-    assert(req.proc_page_id >= 0 && req.proc_page_id < PROC_MAX_PAGES);
-    assert(req.operation == 'R' || req.operation == 'W');
-    if (write(pipe_P2[PIPE_WRITE], &req, sizeof(req)) == -1) {
-      perror("Pipe write error");
-      exit(8);
-    }
-    dmsg("procs_sim sent P2: %02d %c", req.proc_page_id, req.operation);
-
-    // Process 3
-    sem_wait(sem_P3);
-
-    if (fscanf(pagelist_P3, "%d %c", &req.proc_page_id, &req.operation) != 2) {
-      fprintf(stderr, "Error reading pagelist_P3\n");
-      exit(7);
-    }
-    req.proc_id = 3;
-    assert(req.proc_page_id >= 0 && req.proc_page_id < PROC_MAX_PAGES);
-    assert(req.operation == 'R' || req.operation == 'W');
-    if (write(pipe_P3[PIPE_WRITE], &req, sizeof(req)) == -1) {
-      perror("Pipe write error");
-      exit(8);
-    }
-
-    dmsg("procs_sim sent P3: %02d %c", req.proc_page_id, req.operation);
-
-    // Process 4
-    sem_wait(sem_P4);
-
-    if (fscanf(pagelist_P4, "%d %c", &req.proc_page_id, &req.operation) != 2) {
-      fprintf(stderr, "Error reading pagelist_P4\n");
-      exit(7);
-    }
-    req.proc_id = 4;
-    assert(req.proc_page_id >= 0 && req.proc_page_id < PROC_MAX_PAGES);
-    assert(req.operation == 'R' || req.operation == 'W');
-    if (write(pipe_P4[PIPE_WRITE], &req, sizeof(req)) == -1) {
-      perror("Pipe write error");
-      exit(8);
-    }
-
-    dmsg("procs_sim sent P4: %02d %c", req.proc_page_id, req.operation);
-
-    dmsg("procs_sim finished round %d", i);
   }
 
-  // cleanup
-  sem_close(sem_P1);
-  sem_close(sem_P2);
-  sem_close(sem_P3);
-  sem_close(sem_P4);
+  // cleanup, the children hold their own copies of the pipe writes
   close(pipe_P1[PIPE_WRITE]);
   close(pipe_P2[PIPE_WRITE]);
   close(pipe_P3[PIPE_WRITE]);
   close(pipe_P4[PIPE_WRITE]);
-  fclose(pagelist_P1);
-  fclose(pagelist_P2);
-  fclose(pagelist_P3);
-  fclose(pagelist_P4);
+
+  for (int p = 0; p < 4; p++) {
+    wait(NULL);
+  }
 
   dmsg("procs_sim finished");
 
@@ -0,0 +1,255 @@
+#include "trace.h"
+#include "types.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// documentation is provided in trace.h
+
+// exit on a malformed trace record
+static void trace_error(const trace_file_t *trace, const char *what) {
+  if (trace->binary) {
+    fprintf(stderr, "Error in trace %s: %s\n", trace->name, what);
+  } else {
+    fprintf(stderr, "Error in trace %s line %ld: %s\n", trace->name,
+            trace->line, what);
+  }
+  exit(13);
+}
+
+// forget the regions a process' address records were given, on its spawn or
+// exit
+static void reset_addresses(trace_file_t *trace, const int proc_id) {
+  trace->used_regions[proc_id - 1] = 0;
+  for (int i = 0; i < PROC_MAX_PAGES / HUGE_PAGES; i++) {
+    trace->region_of[proc_id - 1][i] = -1;
+  }
+}
+
+// get the page ID of a virtual page accessed by a process. its aligned region
+// of HUGE_PAGES pages is given the lowest region slot the process hasn't used
+// yet on its first touch, and the page keeps its offset within the region, so
+// that huge pages, strides and sequential runs follow the addresses
+static int32_t map_address(trace_file_t *trace, const int proc_id,
+                           const int64_t vpn) {
+  int64_t *region_of = trace->region_of[proc_id - 1];
+  uint32_t *used = &trace->used_regions[proc_id - 1];
+  const int64_t region = vpn >> HUGE_ORDER;
+  const int32_t offset = (int32_t)(vpn & (HUGE_PAGES - 1));
+
+  for (int i = 0; i < PROC_MAX_PAGES / HUGE_PAGES; i++) {
+    if (region_of[i] == region)
+      return i << HUGE_ORDER | offset;
+  }
+  for (int i = 0; i < PROC_MAX_PAGES / HUGE_PAGES; i++) {
+    if (!(*used & (1u << i))) {
+      *used |= 1u << i;
+      region_of[i] = region;
+      return i << HUGE_ORDER | offset;
+    }
+  }
+
+  trace_error(trace, "too many distinct regions for a process");
+  return -1;
+}
+
+// check record fields and ordering
+static void validate_record(trace_file_t *trace, const trace_record_t *rec) {
+  if (rec->proc_id < 1 || rec->proc_id > 4)
+    trace_error(trace, "invalid process ID");
+
+  if (rec->operation == 'R' || rec->operation == 'W' ||
+      rec->operation == 'M' || rec->operation == 'C') {
+    if (rec->proc_page_id < 0 || rec->proc_page_id >= PROC_MAX_PAGES)
+      trace_error(trace, "invalid page ID");
+  } else if (rec->operation != 'S' && rec->operation != 'X' &&
+             rec->operation != '-') {
+    trace_error(trace, "invalid operation");
+  }
+
+  if ((rec->operation == 'M' || rec->operation == 'C') &&
+      (rec->shared_id < 0 || rec->shared_id >= SHARED_MAX_PAGES))
+    trace_error(trace, "invalid shared page ID");
+
+  if (rec->timestamp < trace->last_time)
+    trace_error(trace, "timestamps must be non-decreasing");
+  trace->last_time = rec->timestamp;
+}
+
+trace_file_t *trace_open(const char *filename) {
+  trace_file_t *trace = (trace_file_t *)malloc(sizeof(trace_file_t));
+  if (trace == NULL) {
+    fprintf(stderr, "Malloc error\n");
+    exit(6);
+  }
+
+  trace->file = fopen(filename, "rb");
+  if (trace->file == NULL) {
+    perror("File error");
+    exit(6);
+  }
+  trace->line = 0;
+  trace->last_time = 0;
+  trace->name = filename;
+  for (int p = 1; p <= 4; p++) {
+    reset_addresses(trace, p);
+  }
+
+  // detect binary traces by their magic header
+  char magic[sizeof(TRACE_BINARY_MAGIC) - 1];
+  trace->binary =
+      fread(magic, 1, sizeof(magic), trace->file) == sizeof(magic) &&
+      memcmp(magic, TRACE_BINARY_MAGIC, sizeof(magic)) == 0;
+  if (!trace->binary)
+    rewind(trace->file);
+
+  return trace;
+}
+
+trace_file_t *trace_create(const char *filename, const bool binary) {
+  trace_file_t *trace = (trace_file_t *)malloc(sizeof(trace_file_t));
+  if (trace == NULL) {
+    fprintf(stderr, "Malloc error\n");
+    exit(6);
+  }
+
+  trace->file = fopen(filename, binary ? "wb" : "w");
+  if (trace->file == NULL) {
+    perror("File error");
+    exit(6);
+  }
+  trace->binary = binary;
+  trace->line = 0;
+  trace->last_time = 0;
+  trace->name = filename;
+
+  if (binary)
+    fwrite(TRACE_BINARY_MAGIC, 1, sizeof(TRACE_BINARY_MAGIC) - 1, trace->file);
+
+  return trace;
+}
+
+bool trace_read(trace_file_t *trace, trace_record_t *rec) {
+  if (trace->binary) {
+    size_t n = fread(rec, 1, sizeof(*rec), trace->file);
+    if (n == 0)
+      return false;
+    if (n != sizeof(*rec))
+      trace_error(trace, "truncated record");
+  } else {
+    long timestamp;
+    int proc_id;
+    char token[24];
+
+    trace->line++;
+    int n = fscanf(trace->file, "%ld %d %23s", &timestamp, &proc_id, token);
+    if (n == EOF)
+      return false;
+    if (n != 3)
+      trace_error(trace, "expected <timestamp> <proc_id> <page> <op>");
+
+    rec->timestamp = timestamp;
+    rec->proc_id = proc_id;
+    rec->shared_id = 0;
+
+    const bool address_token =
+        token[0] == '0' && (token[1] == 'x' || token[1] == 'X');
+    long page = -1;
+    char event = '\0';
+    if (!address_token && !trace_parse_token(token, &page, &event))
+      trace_error(trace, "invalid page ID");
+
+    if (event != '\0') {
+      // lifecycle event, no page
+      rec->proc_page_id = -1;
+      rec->operation = event;
+      if (proc_id >= 1 && proc_id <= 4 && event != '-')
+        reset_addresses(trace, proc_id);
+    } else if (proc_id < 1 || proc_id > 4) {
+      trace_error(trace, "invalid process ID");
+    } else {
+      if (address_token) {
+        // virtual address, mapped to the page ID of the page holding it
+        char *end;
+        const unsigned long long address = strtoull(token, &end, 16);
+        if (end == token + 2 || *end != '\0')
+          trace_error(trace, "invalid address");
+        rec->proc_page_id =
+            map_address(trace, proc_id, address >> TRACE_PAGE_SHIFT);
+      } else {
+        rec->proc_page_id =
+            page >= 0 && page < PROC_MAX_PAGES ? (int32_t)page : -1;
+
+        // regions given to addresses can't be named directly as well
+        if (rec->proc_page_id != -1) {
+          const int slot = rec->proc_page_id >> HUGE_ORDER;
+          if (trace->region_of[proc_id - 1][slot] != -1)
+            trace_error(trace, "page ID already given to an address");
+          trace->used_regions[proc_id - 1] |= 1u << slot;
+        }
+      }
+      if (fscanf(trace->file, " %c", &rec->operation) != 1)
+        trace_error(trace, "missing operation");
+
+      if (rec->operation == 'M' || rec->operation == 'C') {
+        // shared mapping declaration
+        int shared_id;
+        if (fscanf(trace->file, "%d", &shared_id) != 1)
+          trace_error(trace, "missing shared page ID");
+        rec->shared_id = shared_id >= 0 && shared_id < SHARED_MAX_PAGES
+                             ? (int8_t)shared_id
+                             : -1;
+      }
+    }
+  }
+
+  validate_record(trace, rec);
+  return true;
+}
+
+void trace_write(trace_file_t *trace, const trace_record_t *rec) {
+  if (trace->binary) {
+    fwrite(rec, sizeof(*rec), 1, trace->file);
+  } else if (rec->operation == 'R' || rec->operation == 'W') {
+    fprintf(trace->file, "%ld %d %02d %c\n", (long)rec->timestamp,
+            rec->proc_id, rec->proc_page_id, rec->operation);
+  } else if (rec->operation == 'M' || rec->operation == 'C') {
+    fprintf(trace->file, "%ld %d %02d %c %d\n", (long)rec->timestamp,
+            rec->proc_id, rec->proc_page_id, rec->operation, rec->shared_id);
+  } else {
+    fprintf(trace->file, "%ld %d %c\n", (long)rec->timestamp, rec->proc_id,
+            rec->operation);
+  }
+}
+
+void trace_close(trace_file_t *trace) {
+  fclose(trace->file);
+  free(trace);
+}
+
+bool trace_parse_token(const char *token, long *page, char *event) {
+  *page = -1;
+  *event = '\0';
+  if ((token[0] == 'S' || token[0] == 'X' || token[0] == '-') &&
+      token[1] == '\0') {
+    *event = token[0];
+    return true;
+  }
+
+  char *end;
+  *page = strtol(token, &end, 10);
+  return end != token && *end == '\0';
+}
+
+vmem_io_request_t trace_record_to_request(const trace_record_t *rec) {
+  vmem_io_request_t req;
+
+  req.timestamp = rec->timestamp;
+  req.proc_id = rec->proc_id;
+  req.proc_page_id = rec->proc_page_id;
+  req.operation = rec->operation;
+  req.shared_id = rec->shared_id;
+
+  return req;
+}
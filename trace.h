@@ -0,0 +1,45 @@
+#pragma once
+
+#include "types.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+// interleaved trace file, opened for reading or writing
+typedef struct {
+  FILE *file;
+  bool binary;       // whether records are binary trace_record_t
+  long line;         // current line for text traces, for error messages
+  int64_t last_time; // timestamp of the last record, to check ordering
+  const char *name;  // file name, for error messages
+  // virtual region of HUGE_PAGES pages given each region slot of each process
+  // by address records, -1 if none, and the region slots each process has
+  // used, by address or by number
+  int64_t region_of[4][PROC_MAX_PAGES / HUGE_PAGES];
+  uint32_t used_regions[4];
+} trace_file_t;
+
+// open an interleaved trace for reading, binary traces are detected by their
+// magic header
+trace_file_t *trace_open(const char *filename);
+
+// create an interleaved trace for writing, as binary or text
+trace_file_t *trace_create(const char *filename, const bool binary);
+
+// read the next record of a trace, returns false at the end of the trace.
+// malformed or out of order records exit with code 13
+bool trace_read(trace_file_t *trace, trace_record_t *rec);
+
+// append a record to a trace opened with trace_create
+void trace_write(trace_file_t *trace, const trace_record_t *rec);
+
+// close a trace, freeing it
+void trace_close(trace_file_t *trace);
+
+// parse the page token of a pagelist line or text trace record: a bare
+// lifecycle event S, X or - is returned in event with page -1, a decimal page
+// ID in page with event '\0'. returns false if the token is neither, pages
+// are not range checked
+bool trace_parse_token(const char *token, long *page, char *event);
+
+// convert a trace record to the request sent through the processes' pipes
+vmem_io_request_t trace_record_to_request(const trace_record_t *rec);
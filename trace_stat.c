@@ -0,0 +1,394 @@
+#include "trace.h"
+#include "types.h"
+#include "util.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define USAGE "Usage: %s [-t] [-i <trace_file>]\n"
+
+// locality stats of each process slot
+static stat_proc_t stats[4];
+// latest access time of each page of each process, marked with a 1, so that
+// the distinct pages accessed after a time are the marks after it
+static fenwick_t *marks[4];
+
+// get the histogram bucket of a distance: 0, 1, under 4, under 8, and so on,
+// the last one holding every larger distance
+static int get_bucket(const long distance) {
+  int bucket = 0;
+  for (long d = distance; d > 0 && bucket < STAT_HIST_BUCKETS - 1; d >>= 1) {
+    bucket++;
+  }
+
+  return bucket;
+}
+
+// forget the reference string of a process slot, when its process exits or a
+// new one spawns in it, with a new address space
+static void start_over(stat_proc_t *s, fenwick_t *ft) {
+  for (int page = 0; page < PROC_MAX_PAGES; page++) {
+    s->last_time[page] = -1;
+    s->last_access[page] = -1;
+  }
+  fenwick_clear(ft);
+
+  s->next_time = 0;
+  s->prev_page = -1;
+  s->run = 0;
+  s->touched = 0;
+  s->window_touched = 0;
+  s->incarnation_accesses = 0;
+}
+
+// renumber the marked access times 0, 1, 2... in order, once the tree is full.
+// only the latest access of each page is marked, so at most PROC_MAX_PAGES
+// times are kept
+static void compact_times(stat_proc_t *s, fenwick_t *ft) {
+  int order[PROC_MAX_PAGES];
+  int n = 0;
+
+  // insertion sort of the accessed pages by their latest access time
+  for (int page = 0; page < PROC_MAX_PAGES; page++) {
+    if (s->last_time[page] == -1)
+      continue;
+
+    int i = n++;
+    while (i > 0 && s->last_time[order[i - 1]] > s->last_time[page]) {
+      order[i] = order[i - 1];
+      i--;
+    }
+    order[i] = page;
+  }
+
+  fenwick_clear(ft);
+  for (int i = 0; i < n; i++) {
+    s->last_time[order[i]] = i;
+    fenwick_add(ft, i, 1);
+  }
+  s->next_time = n;
+}
+
+// account a memory access of a process slot
+static void record_access(const int proc_id, const int page,
+                          const char operation) {
+  stat_proc_t *s = &stats[proc_id - 1];
+  fenwick_t *ft = marks[proc_id - 1];
+
+  s->accesses++;
+  if (operation == 'W')
+    s->writes++;
+  else
+    s->reads++;
+
+  if (s->last_time[page] == -1) {
+    s->cold++;
+  } else {
+    // distinct pages accessed since this page's latest access
+    const long reuse = fenwick_sum(ft, s->next_time - 1) -
+                       fenwick_sum(ft, s->last_time[page]);
+    const long gap = s->incarnation_accesses - s->last_access[page];
+
+    s->reuse_sum += reuse;
+    s->reuse_hist[get_bucket(reuse)]++;
+    s->gap_sum += gap;
+    s->gap_hist[get_bucket(gap)]++;
+    // the page is marked again at its new time, compaction must not keep the
+    // old mark
+    fenwick_add(ft, s->last_time[page], -1);
+    s->last_time[page] = -1;
+  }
+
+  if (s->next_time == STAT_TIME_WINDOW)
+    compact_times(s, ft);
+  fenwick_add(ft, s->next_time, 1);
+  s->last_time[page] = s->next_time++;
+  s->last_access[page] = s->incarnation_accesses;
+
+  if (s->prev_page != -1) {
+    const int stride =
+        ((page - s->prev_page) % PROC_MAX_PAGES + PROC_MAX_PAGES) %
+        PROC_MAX_PAGES;
+    s->strides[stride]++;
+    s->run = stride == 1 ? s->run + 1 : 1;
+  } else {
+    s->run = 1;
+  }
+  if (s->run > s->longest_run)
+    s->longest_run = s->run;
+  s->prev_page = page;
+
+  s->touched |= 1u << page;
+  s->window_touched |= 1u << page;
+  s->incarnation_accesses++;
+
+  // footprint after a power of two accesses
+  const long n = s->incarnation_accesses;
+  if ((n & (n - 1)) == 0) {
+    const int point = __builtin_ctzl(n);
+    if (point < STAT_FOOTPRINT_POINTS) {
+      s->footprint_sum[point] += __builtin_popcount(s->touched);
+      s->footprint_count[point]++;
+    }
+  }
+
+  if (n % STAT_FOOTPRINT_WINDOW == 0) {
+    const int pages = __builtin_popcount(s->window_touched);
+
+    if (s->windows == 0 || pages < s->window_min)
+      s->window_min = pages;
+    if (s->windows == 0 || pages > s->window_max)
+      s->window_max = pages;
+    s->window_sum += pages;
+    s->windows++;
+    s->window_touched = 0;
+  }
+}
+
+// account a request of a process slot, a memory access or a lifecycle event
+static void record_request(const int proc_id, const int page,
+                           const char operation) {
+  stat_proc_t *s = &stats[proc_id - 1];
+
+  switch (operation) {
+  case 'R':
+  case 'W':
+    record_access(proc_id, page, operation);
+    break;
+  case 'S':
+    s->spawns++;
+    start_over(s, marks[proc_id - 1]);
+    break;
+  case 'X':
+    s->exits++;
+    start_over(s, marks[proc_id - 1]);
+    break;
+  case '-':
+    s->idle++;
+    break;
+  default:
+    // shared mapping declarations don't access memory
+    break;
+  }
+}
+
+// exit on a malformed pagelist line
+static void pagelist_error(const char *filename, const long line,
+                           const char *what) {
+  fprintf(stderr, "Error in %s line %ld: %s\n", filename, line, what);
+  exit(13);
+}
+
+// read the pagelist of a process slot, one request at a time
+static void read_pagelist(const char *filename, const int proc_id,
+                          const bool timestamped) {
+  FILE *pagelist = fopen(filename, "r");
+  if (pagelist == NULL) {
+    perror("File error");
+    exit(6);
+  }
+
+  for (long line = 1;; line++) {
+    long timestamp;
+    char token[16];
+
+    if (timestamped) {
+      const int read = fscanf(pagelist, "%ld", &timestamp);
+      if (read == EOF)
+        break;
+      if (read != 1) {
+        fprintf(stderr, "Error reading pagelist_P%d\n", proc_id);
+        exit(7);
+      }
+    }
+
+    // each line is either "<page> <R/W operation>" or a lifecycle event
+    const int read = fscanf(pagelist, "%15s", token);
+    if (read == EOF && !timestamped)
+      break;
+    if (read != 1) {
+      fprintf(stderr, "Error reading pagelist_P%d\n", proc_id);
+      exit(7);
+    }
+
+    long page;
+    char event;
+    if (!trace_parse_token(token, &page, &event))
+      pagelist_error(filename, line, "invalid page ID");
+
+    if (event != '\0') {
+      record_request(proc_id, -1, event);
+      continue;
+    }
+
+    char operation;
+    if (fscanf(pagelist, " %c", &operation) != 1) {
+      fprintf(stderr, "Error reading pagelist_P%d\n", proc_id);
+      exit(7);
+    }
+    // a page ID in place of the operation is the page of a timestamped line
+    if (operation >= '0' && operation <= '9')
+      pagelist_error(filename, line,
+                     "timestamped pagelists must be read with -t");
+    if (page < 0 || page >= PROC_MAX_PAGES)
+      pagelist_error(filename, line, "page ID out of range");
+    if (operation != 'R' && operation != 'W')
+      pagelist_error(filename, line, "invalid operation");
+
+    record_request(proc_id, (int)page, operation);
+  }
+
+  fclose(pagelist);
+}
+
+// print the access mix and locality stats of a process slot
+static void print_proc_stats(const int proc_id) {
+  const stat_proc_t *s = &stats[proc_id - 1];
+  const long reuses = s->accesses - s->cold;
+
+  printf("\n--- P%d ---\n", proc_id);
+  printf("Accesses:          %11ld\n", s->accesses);
+  printf("Reads:             %11ld\n", s->reads);
+  printf("Writes:            %11ld\n", s->writes);
+  printf("Write Ratio:       %10.2f%%\n",
+         s->accesses > 0 ? (s->writes / (double)s->accesses) * 100 : 0.0);
+  printf("Spawns:            %11ld\n", s->spawns);
+  printf("Exits:             %11ld\n", s->exits);
+  printf("Idle Rounds:       %11ld\n", s->idle);
+  if (s->accesses == 0)
+    return;
+
+  printf("Cold Accesses:     %11ld\n", s->cold);
+  printf("Avg Reuse Dist:    %11.2f\n",
+         reuses > 0 ? s->reuse_sum / (double)reuses : 0.0);
+  printf("Avg Gap:           %11.2f\n",
+         reuses > 0 ? s->gap_sum / (double)reuses : 0.0);
+
+  // consecutive accesses of the same process, the first one after a spawn
+  // having no stride
+  long moves = 0;
+  int top_stride = -1;
+  for (int stride = 0; stride < PROC_MAX_PAGES; stride++) {
+    moves += s->strides[stride];
+    if (stride > 1 && stride < PROC_MAX_PAGES - 1 &&
+        (top_stride == -1 || s->strides[stride] > s->strides[top_stride]))
+      top_stride = stride;
+  }
+  printf("Repeats:           %10.2f%%\n",
+         moves > 0 ? (s->strides[0] / (double)moves) * 100 : 0.0);
+  printf("Sequential:        %10.2f%%\n",
+         moves > 0 ? (s->strides[1] / (double)moves) * 100 : 0.0);
+  printf("Reverse:           %10.2f%%\n",
+         moves > 0 ? (s->strides[PROC_MAX_PAGES - 1] / (double)moves) * 100
+                   : 0.0);
+  // strides are taken modulo PROC_MAX_PAGES, shown as the shortest one
+  printf("Top Other Stride:  %11d (%.2f%%)\n",
+         top_stride > PROC_MAX_PAGES / 2 ? top_stride - PROC_MAX_PAGES
+                                         : top_stride,
+         moves > 0 ? (s->strides[top_stride] / (double)moves) * 100 : 0.0);
+  printf("Longest Seq Run:   %11d\n", s->longest_run);
+  printf("Window Footprint:  %11.2f (min %d, max %d, %d accesses)\n",
+         s->windows > 0 ? s->window_sum / (double)s->windows : 0.0,
+         s->window_min, s->window_max, STAT_FOOTPRINT_WINDOW);
+
+  // a reuse at distance d hits in an LRU memory of more than d frames, so the
+  // running total is the LRU hit rate of each size
+  printf("Reuse Distance     Accesses   LRU Hit%%\n");
+  long hits = 0;
+  for (int b = 0; b < STAT_HIST_BUCKETS; b++) {
+    hits += s->reuse_hist[b];
+    if (s->reuse_hist[b] == 0)
+      continue;
+
+    if (b == 0)
+      printf("  =  %-8d %10ld %9.2f%%\n", 0, s->reuse_hist[b],
+             (hits / (double)s->accesses) * 100);
+    else if (b == STAT_HIST_BUCKETS - 1)
+      printf("  >= %-8d %10ld %9.2f%%\n", 1 << (b - 1), s->reuse_hist[b],
+             (hits / (double)s->accesses) * 100);
+    else
+      printf("  <  %-8d %10ld %9.2f%%\n", 1 << b, s->reuse_hist[b],
+             (hits / (double)s->accesses) * 100);
+  }
+
+  printf("Inter-Ref Gap      Accesses\n");
+  for (int b = 1; b < STAT_HIST_BUCKETS; b++) {
+    if (s->gap_hist[b] == 0)
+      continue;
+
+    if (b == STAT_HIST_BUCKETS - 1)
+      printf("  >= %-8d %10ld\n", 1 << (b - 1), s->gap_hist[b]);
+    else
+      printf("  <  %-8d %10ld\n", 1 << b, s->gap_hist[b]);
+  }
+
+  // averaged over the processes that made that many accesses
+  printf("Accesses          Footprint\n");
+  for (int point = 0; point < STAT_FOOTPRINT_POINTS; point++) {
+    if (s->footprint_count[point] == 0)
+      break;
+
+    printf("  %-14ld %10.2f\n", 1L << point,
+           s->footprint_sum[point] / (double)s->footprint_count[point]);
+  }
+}
+
+int main(int argc, char **argv) {
+  bool timestamped = false;
+  const char *trace_filename = NULL;
+
+  // parse command line options
+  int opt;
+  while ((opt = getopt(argc, argv, "ti:")) != -1) {
+    switch (opt) {
+    case 't':
+      timestamped = true;
+      break;
+    case 'i':
+      trace_filename = optarg;
+      break;
+    default:
+      fprintf(stderr, USAGE, argv[0]);
+      exit(3);
+    }
+  }
+
+  if (optind != argc || (timestamped && trace_filename != NULL)) {
+    fprintf(stderr, USAGE, argv[0]);
+    exit(3);
+  }
+
+  for (int p = 0; p < 4; p++) {
+    stats[p] = (stat_proc_t){0};
+    marks[p] = create_fenwick(STAT_TIME_WINDOW);
+    start_over(&stats[p], marks[p]);
+  }
+
+  if (trace_filename != NULL) {
+    // records of every process are interleaved, each one going to its slot
+    trace_file_t *trace = trace_open(trace_filename);
+    trace_record_t rec;
+
+    while (trace_read(trace, &rec)) {
+      record_request(rec.proc_id, rec.proc_page_id, rec.operation);
+    }
+    trace_close(trace);
+  } else {
+    const char *pagelist_files[] = {PAGELIST_P1_FILE, PAGELIST_P2_FILE,
+                                    PAGELIST_P3_FILE, PAGELIST_P4_FILE};
+
+    for (int p = 0; p < 4; p++) {
+      read_pagelist(pagelist_files[p], p + 1, timestamped);
+    }
+  }
+
+  printf("Analyzed %s\n", trace_filename != NULL ? trace_filename
+                                                 : "pagelists");
+  for (int p = 0; p < 4; p++) {
+    print_proc_stats(p + 1);
+    free_fenwick(marks[p]);
+  }
+
+  return 0;
+}
@@ -1,4 +1,17 @@
 #include "types.h"
 
-const char *PAGE_ALGO_STR[] = {"Not Recently Used", "Second Chance",
-                               "Least Recently Used (Aging)", "Working Set(k)"};
+const char *PAGE_ALGO_STR[] = {"Not Recently Used",
+                               "Second Chance",
+                               "Least Recently Used (Aging)",
+                               "WSClock(k)",
+                               "Clean-First LRU",
+                               "Write-Cost Aging",
+                               "Write-Cost Second Chance",
+                               "Adaptive Replacement Cache",
+                               "CLOCK with Adaptive Replacement",
+                               "Low Inter-reference Recency Set",
+                               "CLOCK-Pro",
+                               "Multi-Generational LRU",
+                               "Least Frequently Used",
+                               "Least Recently/Frequently Used",
+                               "Set Dueling (NRU/2ndC/Aging/WS)"};
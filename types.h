@@ -11,11 +11,13 @@
  * 08 - pipe write error
  * 09 - pipe read error
  * 10 - invalid process ID
- * 11 - k_param too large for current pagelist
+ * 12 - invalid process lifecycle event
+ * 13 - invalid trace record
  */
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
 // enable debug output
@@ -41,6 +43,54 @@
 #define PROC_MAX_PAGES 32
 // amount of total page frames the simulated physical main memory has
 #define RAM_MAX_PAGES 16
+// max amount of rounds a process slot stays empty between a process exiting
+// and the next one being spawned, used by pagelist_gen
+#define PROC_MAX_IDLE_ROUNDS 8
+
+// magic bytes at the start of binary interleaved traces
+#define TRACE_BINARY_MAGIC "VMTR"
+// text traces may give a virtual address instead of a page ID. the aligned
+// region of HUGE_PAGES pages holding it, with pages of 2^TRACE_PAGE_SHIFT
+// bytes, is given the lowest region of page IDs its process hasn't used yet on
+// its first touch, and the page keeps its offset within the region
+#define TRACE_PAGE_SHIFT 12
+// when replaying timestamped traces, the periodic end of round work (R bit
+// clearing, aging, working sets, load control) runs every TRACE_ROUND_TIME
+// time units of the trace, so that idle gaps age pages like a real clock
+#define TRACE_ROUND_TIME 4
+// average gap between accesses of P1 in timestamped pagelists generated by
+// pagelist_gen, each following process is proportionally slower
+#define TRACE_MEAN_GAP 2
+
+// trace_stat marks the latest access of every page in a Fenwick tree over
+// STAT_TIME_WINDOW access times, renumbering the marked ones in order when the
+// window fills up, so that its memory doesn't grow with the trace. reuse
+// distances and inter-reference gaps go into STAT_HIST_BUCKETS power-of-two
+// buckets, footprints are sampled after 2^i accesses, for i up to
+// STAT_FOOTPRINT_POINTS - 1, and counted over windows of STAT_FOOTPRINT_WINDOW
+// accesses
+#define STAT_TIME_WINDOW 1024
+#define STAT_HIST_BUCKETS 12
+#define STAT_FOOTPRINT_POINTS 40
+#define STAT_FOOTPRINT_WINDOW 100
+
+// synthetic workload models of pagelist_gen, picked with -w. zipf draws pages
+// from a Zipfian distribution with exponent WORKLOAD_ZIPF_THETA over a hot set
+// shuffled across the address space. phases also shifts the hot set by
+// WORKLOAD_PHASE_SHIFT ranks every WORKLOAD_PHASE_LENGTH accesses. scan
+// interrupts the zipf hot set with a sequential scan of WORKLOAD_SCAN_LENGTH
+// pages every WORKLOAD_SCAN_INTERVAL accesses. loop cycles over
+// WORKLOAD_LOOP_PAGES pages, more than main memory holds. in every model, the
+// address space is split into WORKLOAD_REGIONS regions, with writes making up
+// WORKLOAD_WRITE_PERCENT of the accesses to each
+#define WORKLOAD_ZIPF_THETA 0.99
+#define WORKLOAD_PHASE_LENGTH 100
+#define WORKLOAD_PHASE_SHIFT 8
+#define WORKLOAD_SCAN_INTERVAL 100
+#define WORKLOAD_SCAN_LENGTH 24
+#define WORKLOAD_LOOP_PAGES 24
+#define WORKLOAD_REGIONS 4
+#define WORKLOAD_WRITE_PERCENT {50, 50, 50, 50}
 
 // how often should the R bits be cleared, as well as aging shifted, in rounds
 #define REF_CLEAR_INTERVAL 4
@@ -49,24 +99,362 @@
 #define PAGE_REFERENCED_BIT 0b00000010
 #define PAGE_MODIFIED_BIT 0b00000100
 
+// load control, checked every LOAD_CONTROL_WINDOW rounds when enabled.
+// the system is considered to be thrashing when the fault rate over the last
+// window is at or above LOAD_CONTROL_HIGH_PCT, in which case the process with
+// the most faults in that window is swapped out. a swapped out process is
+// resumed once the fault rate falls to LOAD_CONTROL_LOW_PCT or below, or after
+// LOAD_CONTROL_MAX_SUSPEND rounds, so that it can't starve
+#define LOAD_CONTROL_WINDOW 8
+#define LOAD_CONTROL_HIGH_PCT 70
+#define LOAD_CONTROL_LOW_PCT 40
+#define LOAD_CONTROL_MAX_SUSPEND 64
+
+// event-driven mode timings, in simulated time units. each memory access (or
+// page fault being handled) takes EVENT_ACCESS_TIME of CPU time. a faulting
+// process then blocks for EVENT_SWAP_IN_TIME, plus EVENT_WRITEBACK_TIME if the
+// replaced page was dirty, while the other processes keep running
+#define EVENT_ACCESS_TIME 1
+#define EVENT_SWAP_IN_TIME 40
+#define EVENT_WRITEBACK_TIME 40
+// max amount of swap io requests the swap device serves at once, the rest wait
+// in a FIFO queue
+#define EVENT_SWAP_QUEUE_DEPTH 2
+
+// background page cleaner, run every CLEANER_INTERVAL rounds when enabled. a
+// process' cold pages are the ones its algorithm is likely to evict next. when
+// fewer than CLEANER_LOW_WATERMARK of them are clean, up to CLEANER_BATCH of
+// the coldest dirty ones are written back in the background
+#define CLEANER_INTERVAL 2
+#define CLEANER_LOW_WATERMARK 2
+#define CLEANER_BATCH 2
+
+// WSClock schedules writebacks for the dirty pages its hand finds outside the
+// working set, up to WSCLOCK_MAX_PENDING in flight per process. they complete
+// in the background at the end of the round they were scheduled in
+#define WSCLOCK_MAX_PENDING 4
+
+// readahead, enabled with -r. a process whose latest move between pages was at
+// most READAHEAD_MAX_STRIDE pages, forward or backward, prefetches the next
+// pages along that stride on each fault. its window starts at
+// READAHEAD_INIT_WINDOW pages, doubles on each prefetch hit and halves on each
+// prefetched page evicted before being accessed, between READAHEAD_MIN_WINDOW
+// and READAHEAD_MAX_WINDOW
+#define READAHEAD_MAX_STRIDE 2
+#define READAHEAD_INIT_WINDOW 2
+#define READAHEAD_MIN_WINDOW 1
+#define READAHEAD_MAX_WINDOW 8
+
+// TLB, enabled with -T private or -T shared. TLB_ENTRIES entries in total,
+// either split evenly into one TLB per process, or in a single TLB shared by
+// every process and tagged with ASIDs (the process ID). TLBs are TLB_WAYS-way
+// set associative, with LRU replacement within each set
+#define TLB_ENTRIES 32
+#define TLB_WAYS 2
+// estimated cycles of a TLB lookup, of the page walk after a TLB miss, and of
+// a shootdown when a page with a cached translation is evicted
+#define TLB_HIT_CYCLES 1
+#define TLB_WALK_CYCLES 30
+#define TLB_SHOOTDOWN_CYCLES 100
+
+// page table organisation, selected with -p. the flat table is an array of
+// PROC_MAX_PAGES entries per process. the radix table has PT_RADIX_LEVELS
+// levels of 2^PT_RADIX_BITS entries, with tables allocated on demand, as in
+// x86-64's 4-level paging. the hashed inverted table has one entry per page
+// frame, chained from PT_HASH_BUCKETS anchors
+#define PT_RADIX_LEVELS 4
+#define PT_RADIX_BITS 9
+#define PT_RADIX_FANOUT (1 << PT_RADIX_BITS)
+#define PT_HASH_BUCKETS RAM_MAX_PAGES
+// modelled size in bytes of a page table entry, of an inverted table entry
+// (ASID, virtual page number, chain link) and of a hash anchor
+#define PT_ENTRY_SIZE 8
+#define PT_INVERTED_ENTRY_SIZE 16
+#define PT_ANCHOR_SIZE 4
+// the pages of a process are spread in regions of PT_REGION_PAGES pages over a
+// sparse 48-bit address space (code, heap, mmap and stack), so that the radix
+// and hashed tables see realistic virtual page numbers
+#define PT_REGION_PAGES 8
+
+// huge pages, enabled with -H eager or -H collapse. a huge page maps an aligned
+// region of 2^HUGE_ORDER pages of a process to as many contiguous page frames,
+// aligned to the same size, and takes a single TLB entry. eager promotion
+// builds a huge page on a fault in its region, like THP's "always" mode, while
+// collapse promotion builds one every HUGE_SCAN_INTERVAL rounds for a region
+// with at least HUGE_COLLAPSE_MIN resident pages, like khugepaged. missing
+// pages are read in, and the pages in the way of the aligned frames are
+// migrated. huge pages are split when one of their pages is evicted, or when
+// HUGE_MAX_IDLE of their pages are still unused HUGE_SCAN_INTERVAL rounds
+// after the promotion, which swaps those pages out
+#define HUGE_ORDER 1
+#define HUGE_PAGES (1 << HUGE_ORDER)
+#define HUGE_SCAN_INTERVAL 8
+#define HUGE_COLLAPSE_MIN (HUGE_PAGES - HUGE_PAGES / 4)
+#define HUGE_MAX_IDLE (HUGE_PAGES / 2)
+
+// shared pages, declared by 'M' (shared) and 'C' (copy-on-write) records of
+// interleaved traces, with IDs from 0 to SHARED_MAX_PAGES - 1. the frame of a
+// shared page is charged to the mapping that faulted it in, its owner, and the
+// other mappings point to it through reverse mappings, without frames of their
+// own. accesses through those are accounted to the owner's page
+#define SHARED_MAX_PAGES 16
+
+// compressed swap pool (zswap), enabled with -z. ZSWAP_POOL_PCT percent of the
+// page frames are set aside for the pool, and evicted pages are compressed
+// into it before reaching the backing store. a page compresses to between
+// ZSWAP_MIN_SIZE_PCT and ZSWAP_MAX_SIZE_PCT percent of a page, and pages
+// compressing worse than ZSWAP_REJECT_PCT go straight to the backing store.
+// when the pool is full, its least recently stored pages are written back to
+// the backing store, or just dropped if the backing store is up to date
+#define ZSWAP_POOL_PCT 25
+#define ZSWAP_POOL_FRAMES (RAM_MAX_PAGES * ZSWAP_POOL_PCT / 100)
+#define ZSWAP_MIN_SIZE_PCT 10
+#define ZSWAP_MAX_SIZE_PCT 90
+#define ZSWAP_REJECT_PCT 75
+// time to decompress a page on a fault served from the pool, taken on the CPU
+// instead of blocking on the swap device for EVENT_SWAP_IN_TIME
+#define ZSWAP_LOAD_TIME 4
+
+// NUMA, enabled with -N first-touch|interleave|preferred. page frames are split
+// into NUMA_NODES nodes of consecutive frames, and each process is pinned to
+// the home node (proc_id - 1) % NUMA_NODES. an access from a node to a page
+// frame on another costs NUMA_DISTANCES[from][to] time units, as in ACPI's
+// SLIT table. first-touch places a faulting page on its process' home node,
+// interleave spreads pages round-robin over the nodes and preferred places
+// every page on NUMA_PREFERRED_NODE, all falling back to the nearest node with
+// a free frame. every NUMA_SCAN_INTERVAL rounds, pages accessed at least
+// NUMA_HOT_ACCESSES times from a remote node since the last scan are migrated
+// to their process' home node, taking NUMA_MIGRATE_TIME to copy each page
+#define NUMA_NODES 2
+#define NUMA_NODE_FRAMES (RAM_MAX_PAGES / NUMA_NODES)
+#define NUMA_DISTANCES {{10, 21}, {21, 10}}
+#define NUMA_PREFERRED_NODE 0
+#define NUMA_SCAN_INTERVAL 8
+#define NUMA_HOT_ACCESSES 4
+#define NUMA_MIGRATE_TIME 40
+
+// swap file, enabled with -S <swap_file>. every page frame is backed by a
+// SWAPFILE_PAGE_SIZE bytes slot of an mmap'd arena holding its contents, and
+// pages evicted or cleaned while modified are written to a slot of the swap
+// file, given out by a slot allocator, from which they're read back on a
+// fault. io is queued in batches of up to SWAPFILE_BATCH requests, and a batch
+// stays in flight while the next one is queued. with SWAPFILE_URING, batches
+// are submitted to an io_uring instance, falling back to SWAPFILE_THREADS
+// worker threads with pread and pwrite if the kernel doesn't allow it, or
+// always without it. latencies go into SWAPFILE_HIST_BUCKETS power-of-two
+// buckets, in microseconds. with SWAPFILE_SYNC, the file is opened with
+// O_DSYNC so writes reach the disk
+#define SWAPFILE_PAGE_SIZE 4096
+#define SWAPFILE_SLOTS (4 * PROC_MAX_PAGES)
+#define SWAPFILE_BATCH 16
+#define SWAPFILE_URING true
+#define SWAPFILE_THREADS 4
+#define SWAPFILE_HIST_BUCKETS 16
+#define SWAPFILE_SYNC true
+
+// memory cgroups, enabled with -g. processes are assigned to a hierarchy of
+// CGROUP_COUNT groups, the first being the root, and every group limits the
+// page frames charged to the processes in it and in its descendants with a
+// hard limit (like memory.max), that a fault can't exceed without reclaiming
+// from the group, a soft limit (like memory.high), past which the group is
+// reclaimed from first when main memory is full, in proportion to its excess,
+// and a protection (like memory.low), under which its processes are passed over
+// when reclaiming from an ancestor or from another process. limits of
+// RAM_MAX_PAGES or more don't limit anything
+#define CGROUP_COUNT 3
+#define CGROUP_NAMES {"root", "web", "batch"}
+#define CGROUP_PARENTS {-1, 0, 0}
+#define CGROUP_MAX {RAM_MAX_PAGES, 10, 7}
+#define CGROUP_HIGH {RAM_MAX_PAGES, 8, 5}
+#define CGROUP_LOW {0, 4, 2}
+// group of each process
+#define CGROUP_OF_PROC {1, 1, 2, 2}
+
+// workingset tracking, enabled with -w. an evicted page keeps a shadow entry
+// in its page table entry, packing the round it was evicted on in
+// WORKINGSET_ROUND_BITS bits and its process' eviction counter in
+// WORKINGSET_EVICTION_BITS bits, so shadows take no memory beyond the page
+// tables however large the address spaces are. both wrap around, so distances
+// and times past them alias to shorter ones. when the page faults back in, its
+// refault distance is the number of pages its process evicted in between, and
+// it's a workingset refault if the distance is within the page frames the
+// process holds, its reuse distance fitting in twice the process' memory.
+// distances go into WORKINGSET_HIST_BUCKETS power-of-two buckets. a process
+// with WORKINGSET_THRASH_REFAULTS workingset refaults or more in a window of
+// WORKINGSET_WINDOW rounds is thrashing
+#define WORKINGSET_EVICTION_BITS 16
+#define WORKINGSET_ROUND_BITS 15
+#define WORKINGSET_HIST_BUCKETS 8
+#define WORKINGSET_WINDOW 20
+#define WORKINGSET_THRASH_REFAULTS 4
+
+// all-k working set analysis, enabled with -a. the inter-reference gaps of
+// every process are recorded in a single pass, in its own virtual time, and
+// the average working set size and fault rate of a working set of window k are
+// derived from them for every k up to WSCURVE_MAX_K at once (Denning). gaps
+// past WSCURVE_MAX_K are kept together, as they're outside every window
+#define WSCURVE_MAX_K (2 * RAM_MAX_PAGES)
+
+// write-cost-aware algorithms. writing back a dirty page costs
+// WRITE_COST_FACTOR times as much as dropping a clean one. CFLRU evicts the
+// least recently used clean page among the CFLRU_WINDOW least recently used
+// pages of a process, falling back to the least recently used page
+#define WRITE_COST_FACTOR 4
+#define CFLRU_WINDOW 4
+
+// amount of samples of the ARC/CAR adaptation parameter p kept for each
+// process. once full, every other sample is dropped and samples are taken half
+// as often, so the history always spans the whole run
+#define ARC_P_HISTORY 16
+
+// share of a process' page frames set aside for resident HIR pages in LIRS,
+// and for cold pages at the start of CLOCK-Pro, at least 1 frame
+#define LIRS_HIR_PCT 10
+
+// multi-generational LRU. each process keeps up to MGLRU_GENS generations, aged
+// every REF_CLEAR_INTERVAL rounds. pages faulted back in shortly after being
+// evicted are refaults, and go up one tier, up to MGLRU_TIERS - 1. generation
+// sizes are sampled at each aging pass, keeping up to MGLRU_HISTORY samples
+// like ARC_P_HISTORY
+#define MGLRU_GENS 4
+#define MGLRU_TIERS 4
+#define MGLRU_HISTORY 16
+
+// O(1) LFU keeps resident pages in one LRU ordered list per access count.
+// counts are capped at LFU_MAX_FREQ and halved every LFU_AGING_INTERVAL
+// rounds, so that pages that were popular long ago can still be evicted
+#define LFU_MAX_FREQ 32
+#define LFU_AGING_INTERVAL 32
+// LRFU weight. the combined recency-frequency (CRF) value of a page decays by
+// 2^-LRFU_LAMBDA on each access of its process, closer to 0 behaves as LFU and
+// 1 as LRU. must be above 0, which also bounds the CRF
+#define LRFU_LAMBDA 0.1
+
+// set dueling between NRU, 2ndC, Aging and WS. every process keeps a shadow
+// cache per candidate policy, fed only with the pages whose ID is a multiple of
+// DUEL_SAMPLE_STRIDE and sized to the process' page frames divided by the
+// stride. every DUEL_EPOCH rounds, each process switches its live policy to the
+// candidate with the fewest shadow faults in that epoch. the WS candidate uses
+// the k param when given, or DUEL_WS_K otherwise
+#define DUEL_CANDIDATES 4
+#define DUEL_SAMPLE_STRIDE 2
+#define DUEL_EPOCH 16
+#define DUEL_WS_K 4
+
 // used to identify the algorithm being used in this execution
 typedef enum {
   ALGO_NRU,  // Not Recently Used
   ALGO_2ndC, // Second Chance
   ALGO_LRU,  // Least Recently Used/Aging
-  ALGO_WS    // Working Set (takes k param)
+  ALGO_WS,   // WSClock (takes k param)
+  ALGO_CFLRU,   // Clean-First LRU
+  ALGO_LRU_WC,  // Aging weighted by write cost
+  ALGO_2ndC_WC, // Second Chance weighted by write cost
+  ALGO_ARC,     // Adaptive Replacement Cache
+  ALGO_CAR,     // CLOCK with Adaptive Replacement
+  ALGO_LIRS,     // Low Inter-reference Recency Set
+  ALGO_CLOCKPRO, // CLOCK-Pro
+  ALGO_MGLRU,    // Multi-Generational LRU
+  ALGO_LFU,      // Least Frequently Used
+  ALGO_LRFU,     // Least Recently/Frequently Used
+  ALGO_DUEL      // Set dueling between NRU, 2ndC, Aging and WS
 } page_algo_t;
 extern const char *PAGE_ALGO_STR[];
 
 // data being sent from procs_sim to vmem_sim through processes' pipes
 typedef struct {
+  long timestamp;   // arrival time, only set for timestamped traces
   int proc_id;      // 1-4 process ID
-  int proc_page_id; // 0-31 page ID within the process' memory
-  char operation;   // 'R' or 'W' for read or write
+  int proc_page_id; // 0-31 page ID within the process' memory, -1 for events
+  char operation;   // 'R' or 'W' for read or write, or a lifecycle event:
+  // 'S' for a process spawning in this slot, 'X' for the process exiting and
+  // '-' for an idle turn while the slot has no process. traces may also
+  // declare the page as a mapping of a shared page, with 'M' if it's shared
+  // or 'C' if it's copy-on-write
+  int shared_id; // shared page ID for 'M' and 'C', 0 otherwise
 } vmem_io_request_t;
 
-// function pointer type for page replacement algorithms
-typedef void (*page_algo_func_t)(const vmem_io_request_t);
+// interleaved trace record. text traces have one record per line, as
+// "<timestamp> <proc_id> <page> <op>", and binary traces hold these records as
+// is, after TRACE_BINARY_MAGIC. op may also be a lifecycle event (S, X or -)
+// with page -1. in text traces, page may also be a hexadecimal virtual address
+// ("0x..."), see TRACE_PAGE_SHIFT. shared mapping declarations are written as
+// "<timestamp> <proc_id> <page> <M|C> <shared_id>"
+typedef struct {
+  int64_t timestamp;    // arrival time, non-decreasing along the trace
+  int32_t proc_page_id; // 0-31 page ID, -1 for lifecycle events
+  int16_t proc_id;      // 1-4 process ID
+  char operation;       // 'R', 'W', 'S', 'X', '-', 'M' or 'C'
+  int8_t shared_id;     // shared page ID for 'M' and 'C', 0 otherwise
+} trace_record_t;
+
+// access pattern of the pagelists generated by pagelist_gen
+typedef enum {
+  WORKLOAD_UNIFORM, // uniformly random pages
+  WORKLOAD_ZIPF,    // Zipfian hot set
+  WORKLOAD_PHASES,  // Zipfian hot set, shifting every phase
+  WORKLOAD_SCAN,    // Zipfian hot set with periodic sequential scans
+  WORKLOAD_LOOP     // cyclic loop over more pages than main memory holds
+} workload_model_t;
+
+// workload model state of a process in pagelist_gen, started over when a new
+// process spawns
+typedef struct {
+  int hot_pages[PROC_MAX_PAGES]; // page of each Zipf rank
+  long accesses;                 // accesses made since the spawn
+  int scan_left;                 // pages left in the current scan
+  int scan_page;                 // next page of the current scan
+  int loop_start;                // first page of the loop
+} workload_state_t;
+
+// locality stats of a process slot in trace_stat. a spawn starts an address
+// space over, making every page cold again
+typedef struct {
+  // reference string state
+  int last_time[PROC_MAX_PAGES];    // tree position of the latest access, or -1
+  long last_access[PROC_MAX_PAGES]; // accesses made before the latest one
+  int next_time;                    // tree position of the next access
+  int prev_page;                    // page of the previous access, or -1
+  int run;                          // sequential accesses in a row so far
+  uint32_t touched;                 // pages accessed since the spawn
+  uint32_t window_touched;          // pages accessed in the current window
+  long incarnation_accesses;        // accesses made since the spawn
+
+  // access mix
+  long accesses, reads, writes;
+  long spawns, exits, idle;
+
+  // reuse distances, distinct pages accessed between two accesses to a page
+  long cold; // first accesses, with no reuse distance
+  long reuse_sum;
+  long reuse_hist[STAT_HIST_BUCKETS];
+  // inter-reference gaps, accesses made between two accesses to a page
+  long gap_sum;
+  long gap_hist[STAT_HIST_BUCKETS];
+
+  // strides between consecutive pages, modulo PROC_MAX_PAGES
+  long strides[PROC_MAX_PAGES];
+  int longest_run;
+
+  // pages accessed in the first 2^i accesses since a spawn, summed over the
+  // processes that made that many
+  long footprint_sum[STAT_FOOTPRINT_POINTS];
+  long footprint_count[STAT_FOOTPRINT_POINTS];
+  long windows, window_sum; // pages accessed over every full window
+  int window_min, window_max;
+} stat_proc_t;
+
+// outcome of a memory io request
+typedef enum {
+  REQ_HIT,         // page was already in memory, or lifecycle event
+  REQ_CLEAN_FAULT, // page fault that didn't need a writeback
+  REQ_DIRTY_FAULT, // page fault that replaced a modified page
+  REQ_POOL_FAULT   // page fault served from the zswap pool, without swap io
+} req_result_t;
+
+// function pointer type for page replacement algorithms,
+// returns the ID of the process' page that should be swapped out
+typedef int (*page_algo_func_t)(const int proc_id);
 
 // page flags bits
 typedef uint8_t page_flags_t;
@@ -79,6 +467,7 @@ typedef struct {
   // page entry data
   int page_id;        // 0-31 page ID
   int page_frame;     // page index in main memory, -1 if not in memory
+  int shared_id;      // shared page mapped by this page, -1 if private
   page_flags_t flags; // page flags
   /*
    * Bit 0b00000001: Valid      (page is in main memory)
@@ -88,13 +477,382 @@ typedef struct {
 
   // algorithm-specific data
   page_age_bits_t age_bits; // page age bit vector, LRU
-  int age_clock; // latest page access clock time according to clock_counter, WS
+  int age_clock; // virtual time of the process' latest access to this page, WS
+  int last_ref_round; // round of the latest access to this page, load control
+  bool cleaned; // written back by the page cleaner and not modified since
+  int clock_passes; // times a dirty page was passed over by the hand, 2ndC-WC
+  bool writeback_pending; // writeback scheduled by the WSClock hand, WS
+  bool prefetched; // loaded by readahead and not accessed since
+  uint32_t shadow; // eviction round and counter of an evicted page, workingset
 
   // page entry statistics
   int read_count;           // amount of R requests to this page
   int write_count;          // amount of W requests to this page
   int page_fault_count;     // amount of total page faults caused by this page
   int modified_fault_count; // amount of dirty page faults caused by this page
+  int pool_fault_count;     // amount of page faults served from the zswap pool
   // "caused by this page" meaning that it happened when this page was requested
   // by a process
 } page_table_entry_t;
+
+// reverse mapping of a page frame to the page occupying it. frames owned by the
+// same process are linked together, so that the resident pages of a process
+// can be visited in O(resident pages)
+typedef struct {
+  int proc_id; // owner process ID, 0 if the frame isn't mapped
+  int page_id; // page ID within the owner process
+  int prev;    // previous frame owned by the same process, -1 if none
+  int next;    // next frame owned by the same process, -1 if none
+} frame_entry_t;
+
+// load control state of a process
+typedef struct {
+  bool suspended;    // whether the process is currently swapped out
+  int suspended_at;  // round in which the process was last swapped out
+  uint32_t wset;     // working set bitmask saved at swap out, for prepaging
+  int window_faults; // page faults in the current load control window
+
+  // load control statistics
+  int swap_out_count;   // amount of times the process was swapped out
+  int swapped_pages;    // amount of pages freed by swapping the process out
+  int swapped_dirty;    // amount of those pages that had to be written back
+  int prepaged_pages;   // amount of pages brought back in by prepaging
+  int prepaged_dirty;   // amount of dirty pages evicted to make room for them
+  int suspended_rounds; // amount of rounds spent swapped out
+} load_control_t;
+
+// readahead state of a process
+typedef struct {
+  int last_page; // page of the process' latest access, -1 if none
+  int stride;    // latest move between pages, 0 if too far to prefetch along
+  int window;    // amount of pages prefetched on the next fault
+
+  // readahead statistics
+  int prefetched;      // pages loaded by readahead
+  int hits;            // prefetched pages accessed while still in memory
+  int wasted;          // prefetched pages evicted before being accessed
+  int evictions;       // resident pages evicted to make room for prefetches
+  int dirty_evictions; // amount of those pages that had to be written back
+} readahead_t;
+
+// how translations are cached
+typedef enum {
+  TLB_OFF,     // no TLB, every request goes straight to the page tables
+  TLB_PRIVATE, // one TLB per process
+  TLB_SHARED   // a single TLB, with entries tagged by ASID
+} tlb_mode_t;
+
+// how page frames are placed on NUMA nodes
+typedef enum {
+  NUMA_OFF,         // a single node, with uniform access costs
+  NUMA_FIRST_TOUCH, // on the home node of the process faulting a page in
+  NUMA_INTERLEAVE,  // round-robin over the nodes
+  NUMA_PREFERRED    // on NUMA_PREFERRED_NODE
+} numa_policy_t;
+
+// cached translation of a page
+typedef struct {
+  bool valid;    // whether the entry holds a translation
+  bool huge;     // whether the entry maps a huge page
+  int asid;      // owner process ID
+  int page_id;   // page ID within the owner process, or huge page region
+  long last_use; // lookup count at the entry's latest use, for LRU
+} tlb_entry_t;
+
+// page table organisation
+typedef enum {
+  PT_FLAT,  // array indexed by page ID
+  PT_RADIX, // multi-level radix tree indexed by virtual page number
+  PT_HASHED // global inverted table indexed by page frame, found by hashing
+} pt_format_t;
+
+// table of a radix page table level. inner tables point to the next level's
+// tables, and leaf tables hold page frames
+typedef struct pt_node {
+  struct pt_node *child[PT_RADIX_FANOUT]; // next level tables, NULL if absent
+  int frame[PT_RADIX_FANOUT];             // page frames, -1 if not present
+} pt_node_t;
+
+// entry of the hashed inverted page table, for the page occupying a frame
+typedef struct {
+  int asid; // owner process ID, 0 if the frame isn't mapped
+  long vpn; // virtual page number within the owner process
+  int next; // next frame in the same hash chain, -1 if none
+} pt_inverted_entry_t;
+
+// huge page promotion policy
+typedef enum {
+  HUGE_OFF,     // base pages only
+  HUGE_EAGER,   // promote a region on a fault, like THP's "always" mode
+  HUGE_COLLAPSE // promote well populated regions periodically, like khugepaged
+} huge_policy_t;
+
+// huge page state of a process
+typedef struct {
+  // regions mapped as huge pages, and the round of their latest promotion
+  bool huge[PROC_MAX_PAGES / HUGE_PAGES];
+  int promoted_round[PROC_MAX_PAGES / HUGE_PAGES];
+  uint32_t touched; // pages used since being loaded, bitmask
+
+  // huge page statistics
+  int promotions;        // regions promoted to huge pages
+  int failed_promotions; // promotions without enough frames to take
+  int bloat_reads;       // pages read only to complete a huge page
+  int dirty_evictions;   // dirty pages evicted to make room for those
+  int migrations;        // pages moved to free aligned frames
+  int splits;            // huge pages split to evict one of their pages
+  int idle_splits;       // huge pages split for having too many unused pages
+  int idle_freed;        // unused pages swapped out by those splits
+} huge_state_t;
+
+// shared page, mapped by pages of one or more processes
+typedef struct {
+  bool cow;             // whether a write gives the writer its own copy
+  int owner_proc;       // process whose page holds the frame, 0 if none
+  int owner_page;       // page ID within the owner process
+  uint32_t declared[4]; // pages of each process mapping it, bitmask
+  uint32_t mapped[4];   // those pointing to its frame, the reverse mappings
+  int mapcount;         // amount of reverse mappings, the owner's included
+} shared_page_t;
+
+// page held by the zswap pool. entries are linked in the order they were
+// stored, the least recently stored being the first written back
+typedef struct {
+  bool stored; // whether the page is in the pool
+  bool dirty;  // whether the backing store doesn't hold its latest contents
+  int size;    // compressed size, in percent of a page
+  int prev;    // previously stored entry, -1 if none
+  int next;    // next stored entry, -1 if none
+} zswap_entry_t;
+
+// memory cgroup state and stats. requests, faults and the frames reclaimed from
+// a group include those of its descendants
+typedef struct {
+  long credit;        // excess accumulated over soft limit reclaims
+  int requests;       // memory requests of its processes
+  int faults;         // page faults of its processes
+  int limit_reclaims; // faults that hit its hard limit
+  int soft_reclaims;  // times it was chosen for being past its soft limit
+  int reclaimed;      // frames taken from its processes
+  int scanned;        // pages looked at by reclaim to take those
+  int peak_usage;     // most frames charged to it at once
+  long usage_sum;     // frames charged to it, summed over every round
+} cgroup_t;
+
+// header stamped at the start of a page's contents before it's written to the
+// swap file, checked when the page is read back
+typedef struct {
+  uint32_t proc_id; // process owning the page
+  uint32_t page_id; // page ID within the process
+  uint32_t version; // writes to the page so far
+  uint32_t seq;     // swap file write that stored these contents
+} swapfile_header_t;
+
+// queued swap file io request
+typedef struct {
+  bool write;   // whether the page is written to its slot, or read from it
+  int slot;     // swap slot in the file
+  int frame;    // page frame read into, -1 for writes
+  uint8_t *buf; // page contents, a copy for writes so the frame can be reused
+  long start;   // time the request was submitted, in nanoseconds
+  long latency; // time taken by the request, in nanoseconds
+  // header a read should find in the contents
+  swapfile_header_t expected;
+} swapfile_io_t;
+
+// ARC/CAR list holding a page. T1 holds pages seen once recently and T2 pages
+// seen at least twice, B1 and B2 are their ghost lists, holding the IDs of
+// pages recently evicted from T1 and T2
+typedef enum { ARC_NONE = -1, ARC_T1, ARC_T2, ARC_B1, ARC_B2 } arc_list_t;
+
+// ARC/CAR state of a process. pages are linked through index arrays, so that
+// every list operation is O(1) and the lists never hold more than
+// PROC_MAX_PAGES entries. lists go from head (LRU, or the clock hand for CAR's
+// T1 and T2) to tail (MRU)
+typedef struct {
+  arc_list_t list[PROC_MAX_PAGES]; // list holding each page
+  int prev[PROC_MAX_PAGES];        // previous page in the list, -1 if none
+  int next[PROC_MAX_PAGES];        // next page in the list, -1 if none
+  bool ref[PROC_MAX_PAGES];        // CAR reference bits
+  int head[4];
+  int tail[4];
+  int size[4];
+  int p;             // target size of T1, adapted on ghost hits
+  bool last_miss_b2; // whether the fault being handled hit B2
+
+  // adaptation statistics
+  int b1_hits; // ghost hits in B1, each one grows p
+  int b2_hits; // ghost hits in B2, each one shrinks p
+  int p_min;
+  int p_max;
+  long p_sum;                   // sum of p over every round, for the average
+  int p_history[ARC_P_HISTORY]; // samples of p, see ARC_P_HISTORY
+  int p_history_len;
+} arc_state_t;
+
+// LIRS status of a page
+typedef enum {
+  LIRS_NONE,     // not tracked
+  LIRS_LIR,      // resident, with low inter-reference recency
+  LIRS_HIR,      // resident, with high inter-reference recency
+  LIRS_HIR_GHOST // not resident, kept in the stack to measure its next IRR
+} lirs_status_t;
+
+// LIRS state of a process. the stack S holds pages by recency, with a LIR page
+// at its bottom, and the queue Q holds the resident HIR pages, which are the
+// eviction candidates. both are linked through index arrays, so the metadata
+// never holds more than PROC_MAX_PAGES entries
+typedef struct {
+  lirs_status_t status[PROC_MAX_PAGES];
+  bool in_stack[PROC_MAX_PAGES];
+  int stack_prev[PROC_MAX_PAGES]; // towards the bottom, -1 if none
+  int stack_next[PROC_MAX_PAGES]; // towards the top, -1 if none
+  int queue_prev[PROC_MAX_PAGES]; // towards the front, -1 if none
+  int queue_next[PROC_MAX_PAGES]; // towards the end, -1 if none
+  int stack_bottom;
+  int stack_top;
+  int queue_front;
+  int queue_end;
+  int lir_count;
+  int hir_count; // resident HIR pages, the size of Q
+
+  // statistics
+  int promotions; // HIR pages that became LIR
+  int demotions;  // LIR pages that became HIR
+  int ghost_hits; // faults on non-resident HIR pages still in the stack
+  int pruned;     // HIR entries pruned from the stack bottom
+} lirs_state_t;
+
+// CLOCK-Pro state of a process. a single clock holds hot and cold resident
+// pages, plus non-resident cold pages still in their test period. hot pages
+// are hand_hot's job, cold pages hand_cold's, and hand_test ends test periods
+typedef struct {
+  bool in_clock[PROC_MAX_PAGES];
+  bool resident[PROC_MAX_PAGES];
+  bool hot[PROC_MAX_PAGES];
+  bool ref[PROC_MAX_PAGES];  // reference bit, set on hits
+  bool test[PROC_MAX_PAGES]; // whether a cold page is in its test period
+  int prev[PROC_MAX_PAGES];
+  int next[PROC_MAX_PAGES];
+  int hand_hot; // also the clock's head, where pages are inserted behind
+  int hand_cold;
+  int hand_test;
+  int hot_count;
+  int cold_count;  // resident cold pages
+  int test_count;  // non-resident cold pages in their test period
+  int cold_target; // adaptive target amount of resident cold pages
+
+  // statistics
+  int promotions; // cold pages that became hot
+  int demotions;  // hot pages that became cold
+  int test_hits;  // faults on non-resident pages in their test period
+  int test_ends;  // test periods ended without a re-access
+} clockpro_state_t;
+
+// MGLRU state of a process. generations are numbered by an increasing sequence
+// number, from min_seq (oldest) to max_seq (youngest), and stored in slot
+// seq % MGLRU_GENS. pages are linked within their generation through index
+// arrays, and only move between generations on aging passes or eviction scans
+typedef struct {
+  int seq[PROC_MAX_PAGES];  // generation holding each resident page, -1 if none
+  int prev[PROC_MAX_PAGES]; // previous page in the generation, -1 if none
+  int next[PROC_MAX_PAGES]; // next page in the generation, -1 if none
+  int head[MGLRU_GENS];     // oldest page of each generation slot
+  int tail[MGLRU_GENS];     // newest page of each generation slot
+  int size[MGLRU_GENS];
+  int min_seq;
+  int max_seq;
+  int tier[PROC_MAX_PAGES];        // refault tier of each page
+  int evicted_seq[PROC_MAX_PAGES]; // max_seq at the page's last eviction
+
+  // statistics
+  int promotions;                  // referenced pages moved to a younger gen
+  int refaults;                    // faults on recently evicted pages
+  int tier_evictions[MGLRU_TIERS]; // evictions from each tier
+} mglru_state_t;
+
+// LFU/LRFU state of a process. for LFU, resident pages are linked in one list
+// per access count through index arrays, from LRU (head) to MRU (tail). for
+// LRFU, resident pages are kept in a min-heap on their key, log2(CRF) +
+// LRFU_LAMBDA * last access, which orders pages by their current CRF without
+// having to decay every page on each access
+typedef struct {
+  int freq[PROC_MAX_PAGES]; // access count of each resident page, 0 if none
+  int prev[PROC_MAX_PAGES]; // previous page with the same count, -1 if none
+  int next[PROC_MAX_PAGES]; // next page with the same count, -1 if none
+  int head[LFU_MAX_FREQ + 1];
+  int tail[LFU_MAX_FREQ + 1];
+  int min_freq; // lowest count held by a resident page, 0 if none
+
+  double crf[PROC_MAX_PAGES];      // CRF of each page as of its last access
+  double key[PROC_MAX_PAGES];      // heap key of each page
+  int last_access[PROC_MAX_PAGES]; // vtime of the page's last access
+  int heap[PROC_MAX_PAGES];        // resident pages, lowest key first
+  int heap_pos[PROC_MAX_PAGES];    // index of each page in heap, -1 if none
+  int heap_size;
+  int vtime; // accesses of the process so far
+
+  // statistics
+  int evictions;
+  double victim_value_sum; // count (LFU) or CRF (LRFU) of the evicted pages
+} lfu_state_t;
+
+// candidate policies of set dueling
+typedef enum { DUEL_NRU, DUEL_2ndC, DUEL_AGING, DUEL_WS } duel_policy_t;
+
+// replacement state of one set dueling candidate over a set of pages, either
+// the process' resident pages or a sampled shadow cache. pages are bits in the
+// masks, as in load_control_t's wset
+typedef struct {
+  uint32_t resident;                        // pages in the (shadow) cache
+  uint32_t referenced;                      // R bits, NRU/2ndC/Aging
+  uint32_t modified;                        // M bits, NRU
+  page_age_bits_t age_bits[PROC_MAX_PAGES]; // Aging
+  int last_use[PROC_MAX_PAGES];             // vtime of the last access, WS
+  int fifo[PROC_MAX_PAGES];                 // circular 2ndC queue
+  int fifo_head;
+  int fifo_len;
+  int hand; // page ID where the WS hand resumes its scan
+} duel_tracker_t;
+
+// set dueling state of a process. every candidate tracks the resident pages,
+// so that the live policy can be switched at any time, and has its own shadow
+// cache to count the faults it would have caused on the sampled pages
+typedef struct {
+  duel_policy_t live;                         // policy picking the victims
+  duel_tracker_t live_state[DUEL_CANDIDATES]; // over the resident pages
+  duel_tracker_t shadow[DUEL_CANDIDATES];     // over the sampled pages
+  int vtime; // accesses of the process so far
+
+  // statistics
+  int epoch_faults[DUEL_CANDIDATES]; // shadow faults in the current epoch
+  int total_faults[DUEL_CANDIDATES]; // shadow faults over the whole run
+  int live_faults; // shadow faults of the candidate live in each epoch
+  int rounds_live[DUEL_CANDIDATES];
+  int switches;
+} duel_state_t;
+
+// scheduling state of a process in event-driven mode
+typedef enum {
+  PROC_READY,    // waiting in the ready queue for the CPU
+  PROC_RUNNING,  // using the CPU for its current request
+  PROC_BLOCKED,  // waiting for swap io after a page fault
+  PROC_SLEEPING, // process slot is empty for this turn
+  PROC_PARKED,   // suspended by load control, out of the ready queue
+  PROC_DONE      // all requests have been sent
+} proc_state_t;
+
+// event-driven scheduling data of a process
+typedef struct {
+  proc_state_t state;
+  long io_time;     // service time of the swap io the process is waiting on
+  bool io_dirty;    // whether that swap io includes a writeback
+  bool in_device;   // whether that swap io is being served by the swap device
+  long block_start; // time at which the process last blocked
+
+  // event-driven statistics
+  long cpu_time;           // time spent running on the CPU
+  long clean_blocked_time; // time spent blocked on clean faults
+  long dirty_blocked_time; // time spent blocked on dirty faults
+  long queued_time;        // part of the blocked time spent in the swap queue
+} proc_sched_t;
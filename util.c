@@ -193,3 +193,280 @@ void set_to_str(const set_t *set, char *buffer, size_t buffer_size) {
     }
   }
 }
+
+/*
+ * Priority queue implementation
+ */
+
+// returns whether heap item a should be popped before item b
+static inline bool pq_before(const pqueue_item_t *a, const pqueue_item_t *b) {
+  return a->priority < b->priority ||
+         (a->priority == b->priority && a->seq < b->seq);
+}
+
+pqueue_t *create_pqueue(void) {
+  pqueue_t *pq = (pqueue_t *)malloc(sizeof(pqueue_t));
+  if (pq == NULL) {
+    fprintf(stderr, "Malloc error\n");
+    exit(6);
+  }
+
+  pq->capacity = 16;
+  pq->size = 0;
+  pq->next_seq = 0;
+  pq->items = (pqueue_item_t *)malloc(pq->capacity * sizeof(pqueue_item_t));
+  if (pq->items == NULL) {
+    fprintf(stderr, "Malloc error\n");
+    exit(6);
+  }
+
+  return pq;
+}
+
+void free_pqueue(pqueue_t *pq) {
+  free(pq->items);
+  free(pq);
+}
+
+void pq_push(pqueue_t *pq, long priority, int value) {
+  if (pq->size == pq->capacity) {
+    pq->capacity *= 2;
+    pq->items = (pqueue_item_t *)realloc(
+        pq->items, pq->capacity * sizeof(pqueue_item_t));
+    if (pq->items == NULL) {
+      fprintf(stderr, "Malloc error\n");
+      exit(6);
+    }
+  }
+
+  // sift up from the new leaf
+  pqueue_item_t item = {priority, pq->next_seq++, value};
+  int i = pq->size++;
+
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    if (!pq_before(&item, &pq->items[parent]))
+      break;
+
+    pq->items[i] = pq->items[parent];
+    i = parent;
+  }
+
+  pq->items[i] = item;
+}
+
+int pq_pop(pqueue_t *pq, long *priority_out) {
+  if (pq->size == 0)
+    return -1;
+
+  pqueue_item_t top = pq->items[0];
+  pqueue_item_t last = pq->items[--pq->size];
+  int i = 0;
+
+  // sift the last leaf down from the root
+  while (2 * i + 1 < pq->size) {
+    int child = 2 * i + 1;
+    if (child + 1 < pq->size &&
+        pq_before(&pq->items[child + 1], &pq->items[child]))
+      child++;
+
+    if (!pq_before(&pq->items[child], &last))
+      break;
+
+    pq->items[i] = pq->items[child];
+    i = child;
+  }
+
+  pq->items[i] = last;
+
+  if (priority_out != NULL)
+    *priority_out = top.priority;
+
+  return top.data;
+}
+
+bool pq_empty(const pqueue_t *pq) { return pq->size == 0; }
+
+/*
+ * Random number generator implementation
+ */
+
+// rotate the bits of x left by k
+static inline uint64_t rotl(const uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+void rng_seed(rng_t *rng, uint64_t seed) {
+  for (int i = 0; i < 4; i++) {
+    uint64_t z = (seed += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    rng->s[i] = z ^ (z >> 31);
+  }
+}
+
+uint64_t rng_next(rng_t *rng) {
+  uint64_t *s = rng->s;
+  const uint64_t result = rotl(s[1] * 5, 7) * 9;
+  const uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+
+  return result;
+}
+
+int rng_below(rng_t *rng, int bound) {
+  assert(bound > 0);
+
+  // scale the top 32 bits to the bound, without a slow modulo
+  return (int)(((rng_next(rng) >> 32) * (uint64_t)bound) >> 32);
+}
+
+double rng_double(rng_t *rng) {
+  // the top 53 bits fill a double's mantissa
+  return (rng_next(rng) >> 11) * 0x1.0p-53;
+}
+
+/*
+ * Alias table implementation
+ */
+
+alias_table_t *create_alias_table(const double *weights, int size) {
+  assert(size > 0);
+
+  alias_table_t *table = (alias_table_t *)malloc(sizeof(alias_table_t));
+  double *scaled = (double *)malloc(size * sizeof(double));
+  int *small = (int *)malloc(size * sizeof(int));
+  int *large = (int *)malloc(size * sizeof(int));
+  if (table == NULL || scaled == NULL || small == NULL || large == NULL) {
+    fprintf(stderr, "Malloc error\n");
+    exit(6);
+  }
+
+  table->size = size;
+  table->prob = (double *)malloc(size * sizeof(double));
+  table->alias = (int *)malloc(size * sizeof(int));
+  if (table->prob == NULL || table->alias == NULL) {
+    fprintf(stderr, "Malloc error\n");
+    exit(6);
+  }
+
+  double total = 0;
+  for (int i = 0; i < size; i++) {
+    assert(weights[i] >= 0);
+    total += weights[i];
+  }
+  assert(total > 0);
+
+  // scale the weights to an average of 1, and split them into the columns
+  // under it and the ones over it
+  int num_small = 0, num_large = 0;
+  for (int i = 0; i < size; i++) {
+    scaled[i] = weights[i] * size / total;
+    if (scaled[i] < 1)
+      small[num_small++] = i;
+    else
+      large[num_large++] = i;
+  }
+
+  // fill each column under the average with the excess of one over it
+  while (num_small > 0 && num_large > 0) {
+    const int s = small[--num_small];
+    const int l = large[--num_large];
+
+    table->prob[s] = scaled[s];
+    table->alias[s] = l;
+    scaled[l] += scaled[s] - 1;
+    if (scaled[l] < 1)
+      small[num_small++] = l;
+    else
+      large[num_large++] = l;
+  }
+
+  // the columns left are full, up to rounding errors
+  while (num_large > 0) {
+    const int l = large[--num_large];
+    table->prob[l] = 1;
+    table->alias[l] = l;
+  }
+  while (num_small > 0) {
+    const int s = small[--num_small];
+    table->prob[s] = 1;
+    table->alias[s] = s;
+  }
+
+  free(scaled);
+  free(small);
+  free(large);
+
+  return table;
+}
+
+void free_alias_table(alias_table_t *table) {
+  free(table->prob);
+  free(table->alias);
+  free(table);
+}
+
+int alias_sample(const alias_table_t *table, rng_t *rng) {
+  const int column = rng_below(rng, table->size);
+  return rng_double(rng) < table->prob[column] ? column : table->alias[column];
+}
+
+/*
+ * Fenwick tree implementation
+ */
+
+fenwick_t *create_fenwick(int size) {
+  assert(size > 0);
+
+  fenwick_t *ft = (fenwick_t *)malloc(sizeof(fenwick_t));
+  if (ft == NULL) {
+    fprintf(stderr, "Malloc error\n");
+    exit(6);
+  }
+
+  ft->size = size;
+  ft->tree = (long *)calloc(size + 1, sizeof(long));
+  if (ft->tree == NULL) {
+    fprintf(stderr, "Malloc error\n");
+    exit(6);
+  }
+
+  return ft;
+}
+
+void free_fenwick(fenwick_t *ft) {
+  free(ft->tree);
+  free(ft);
+}
+
+void fenwick_add(fenwick_t *ft, int index, long delta) {
+  assert(index >= 0 && index < ft->size);
+
+  for (int i = index + 1; i <= ft->size; i += i & -i) {
+    ft->tree[i] += delta;
+  }
+}
+
+long fenwick_sum(const fenwick_t *ft, int index) {
+  assert(index < ft->size);
+  long sum = 0;
+
+  for (int i = index + 1; i > 0; i -= i & -i) {
+    sum += ft->tree[i];
+  }
+
+  return sum;
+}
+
+void fenwick_clear(fenwick_t *ft) {
+  for (int i = 0; i <= ft->size; i++) {
+    ft->tree[i] = 0;
+  }
+}
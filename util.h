@@ -21,6 +21,40 @@ typedef struct {
   uint32_t bitmask;
 } set_t;
 
+// priority queue item
+typedef struct {
+  long priority; // lowest priority is popped first
+  long seq;      // insertion order, to break ties in FIFO order
+  int data;
+} pqueue_item_t;
+
+// priority queue, implemented as a binary min-heap that grows as needed
+typedef struct {
+  pqueue_item_t *items;
+  int size;
+  int capacity;
+  long next_seq;
+} pqueue_t;
+
+// xoshiro256** pseudorandom number generator state
+typedef struct {
+  uint64_t s[4];
+} rng_t;
+
+// alias table (Vose) to draw from a discrete distribution in O(1)
+typedef struct {
+  double *prob; // chance of keeping each column's own value
+  int *alias;   // value drawn instead, for the rest of each column
+  int size;
+} alias_table_t;
+
+// Fenwick tree (binary indexed tree) of counts at positions 0 to size - 1,
+// with point updates and prefix sums in O(log size)
+typedef struct {
+  long *tree; // 1-based, tree[i] sums the counts in (i - (i & -i), i]
+  int size;
+} fenwick_t;
+
 // unbuffered printf + timestamp, includes newline
 void msg(const char *format, ...);
 
@@ -61,3 +95,56 @@ bool set_contains(const set_t *set, int value);
 // print set contents to a string buffer,
 // format: int1, int2, int3.. (no newline, no leading/trailing comma)
 void set_to_str(const set_t *set, char *buffer, size_t buffer_size);
+
+// allocate a priority queue
+pqueue_t *create_pqueue(void);
+
+// free an allocated priority queue
+void free_pqueue(pqueue_t *pq);
+
+// push int with the given priority
+void pq_push(pqueue_t *pq, long priority, int value);
+
+// pop the int with the lowest priority, storing its priority in
+// priority_out if not NULL. returns -1 if the priority queue is empty
+int pq_pop(pqueue_t *pq, long *priority_out);
+
+// returns whether the priority queue is empty
+bool pq_empty(const pqueue_t *pq);
+
+// seed a generator, expanding the seed into its state with splitmix64
+void rng_seed(rng_t *rng, uint64_t seed);
+
+// get the next 64 random bits
+uint64_t rng_next(rng_t *rng);
+
+// get a random int in [0, bound), with a bias under bound / 2^32
+int rng_below(rng_t *rng, int bound);
+
+// get a random double in [0, 1)
+double rng_double(rng_t *rng);
+
+// allocate an alias table for values 0 to size - 1, drawn in proportion to
+// their weights
+alias_table_t *create_alias_table(const double *weights, int size);
+
+// free an allocated alias table
+void free_alias_table(alias_table_t *table);
+
+// draw a value from an alias table
+int alias_sample(const alias_table_t *table, rng_t *rng);
+
+// allocate a Fenwick tree of the given size, with every count at 0
+fenwick_t *create_fenwick(int size);
+
+// free an allocated Fenwick tree
+void free_fenwick(fenwick_t *ft);
+
+// add delta to the count at a position
+void fenwick_add(fenwick_t *ft, int index, long delta);
+
+// get the sum of the counts at positions 0 to index, 0 if index is negative
+long fenwick_sum(const fenwick_t *ft, int index);
+
+// set every count back to 0
+void fenwick_clear(fenwick_t *ft);
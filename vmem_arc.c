@@ -0,0 +1,340 @@
+#include "vmem_arc.h"
+#include "types.h"
+#include "util.h"
+#include "vmem_helpers.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// documentation is provided in vmem_arc.h
+
+extern page_algo_t algorithm;
+
+// ARC/CAR state of each process
+static arc_state_t arc_state[4];
+// rounds between samples of p, doubled whenever the history fills up
+static int p_interval;
+// rounds since p was last sampled
+static int rounds_since_sample;
+// rounds in which p was accounted for, for the average
+static int sampled_rounds;
+
+// get the ARC/CAR state of the specified process
+static arc_state_t *get_arc_state(const int proc_id) {
+  assert(algorithm == ALGO_ARC || algorithm == ALGO_CAR);
+
+  if (proc_id < 1 || proc_id > 4) {
+    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
+    exit(10);
+  }
+
+  return &arc_state[proc_id - 1];
+}
+
+// unlink a page from the list holding it
+static void list_remove(arc_state_t *arc, const int page) {
+  const arc_list_t l = arc->list[page];
+  assert(l != ARC_NONE);
+
+  if (arc->prev[page] != -1)
+    arc->next[arc->prev[page]] = arc->next[page];
+  else
+    arc->head[l] = arc->next[page];
+
+  if (arc->next[page] != -1)
+    arc->prev[arc->next[page]] = arc->prev[page];
+  else
+    arc->tail[l] = arc->prev[page];
+
+  arc->list[page] = ARC_NONE;
+  arc->prev[page] = -1;
+  arc->next[page] = -1;
+  arc->size[l]--;
+}
+
+// push a page to the tail (MRU end) of a list, unlinking it first if needed
+static void list_push(arc_state_t *arc, const arc_list_t l, const int page) {
+  if (arc->list[page] != ARC_NONE)
+    list_remove(arc, page);
+
+  arc->list[page] = l;
+  arc->prev[page] = arc->tail[l];
+  arc->next[page] = -1;
+
+  if (arc->tail[l] != -1)
+    arc->next[arc->tail[l]] = page;
+  else
+    arc->head[l] = page;
+
+  arc->tail[l] = page;
+  arc->size[l]++;
+}
+
+// the cache size of a process is its current page frame count
+static inline int get_cache_size(const int proc_id) {
+  return get_amount_page_frames(proc_id);
+}
+
+void arc_init(void) {
+  for (int p = 0; p < 4; p++) {
+    arc_state_t *arc = &arc_state[p];
+
+    for (int i = 0; i < PROC_MAX_PAGES; i++) {
+      arc->list[i] = ARC_NONE;
+      arc->prev[i] = -1;
+      arc->next[i] = -1;
+      arc->ref[i] = false;
+    }
+    for (int l = 0; l < 4; l++) {
+      arc->head[l] = -1;
+      arc->tail[l] = -1;
+      arc->size[l] = 0;
+    }
+
+    arc->p = 0;
+    arc->last_miss_b2 = false;
+    arc->b1_hits = 0;
+    arc->b2_hits = 0;
+    arc->p_min = 0;
+    arc->p_max = 0;
+    arc->p_sum = 0;
+    arc->p_history_len = 0;
+  }
+
+  p_interval = 1;
+  rounds_since_sample = 0;
+  sampled_rounds = 0;
+}
+
+void arc_hit(const int proc_id, const int proc_page_id) {
+  arc_state_t *arc = get_arc_state(proc_id);
+  assert(arc->list[proc_page_id] == ARC_T1 ||
+         arc->list[proc_page_id] == ARC_T2);
+
+  if (algorithm == ALGO_ARC) {
+    // seen at least twice, becomes the MRU page of T2
+    list_push(arc, ARC_T2, proc_page_id);
+  } else {
+    // CAR only sets the reference bit, pages move when the hand passes them
+    arc->ref[proc_page_id] = true;
+  }
+}
+
+void arc_miss(const int proc_id, const int proc_page_id) {
+  arc_state_t *arc = get_arc_state(proc_id);
+  const int c = get_cache_size(proc_id);
+
+  arc->last_miss_b2 = false;
+
+  if (arc->list[proc_page_id] == ARC_B1) {
+    // T1 was too small to keep this page, favor recency
+    const int delta =
+        arc->size[ARC_B2] > arc->size[ARC_B1]
+            ? arc->size[ARC_B2] / arc->size[ARC_B1]
+            : 1;
+    arc->p = arc->p + delta < c ? arc->p + delta : c;
+    arc->b1_hits++;
+
+    dmsg("ARC P%d: ghost hit in B1 for page %02d, p -> %d", proc_id,
+         proc_page_id, arc->p);
+  } else if (arc->list[proc_page_id] == ARC_B2) {
+    // T2 was too small to keep this page, favor frequency
+    const int delta =
+        arc->size[ARC_B1] > arc->size[ARC_B2]
+            ? arc->size[ARC_B1] / arc->size[ARC_B2]
+            : 1;
+    arc->p = arc->p - delta > 0 ? arc->p - delta : 0;
+    arc->last_miss_b2 = true;
+    arc->b2_hits++;
+
+    dmsg("ARC P%d: ghost hit in B2 for page %02d, p -> %d", proc_id,
+         proc_page_id, arc->p);
+  }
+}
+
+// ARC's REPLACE, evict the LRU page of T1 if T1 is larger than its target p,
+// or the LRU page of T2 otherwise
+static int select_victim_ARC(arc_state_t *arc) {
+  const int t1 = arc->size[ARC_T1];
+
+  if (t1 > 0 &&
+      (t1 > arc->p || (arc->last_miss_b2 && t1 == arc->p) ||
+       arc->size[ARC_T2] == 0))
+    return arc->head[ARC_T1];
+
+  return arc->head[ARC_T2];
+}
+
+// CAR's REPLACE, sweep the T1 clock while T1 is at or above its target p, or
+// the T2 clock otherwise. referenced pages have their bit cleared and move to
+// the tail of T2, as they have been seen at least twice
+static int select_victim_CAR(arc_state_t *arc) {
+  const int target = arc->p > 1 ? arc->p : 1;
+
+  while (true) {
+    const bool from_t1 =
+        arc->size[ARC_T1] > 0 &&
+        (arc->size[ARC_T1] >= target || arc->size[ARC_T2] == 0);
+    const int hand = from_t1 ? arc->head[ARC_T1] : arc->head[ARC_T2];
+    assert(hand != -1); // there should be a page in memory
+
+    if (!arc->ref[hand])
+      return hand;
+
+    arc->ref[hand] = false;
+    list_push(arc, ARC_T2, hand);
+  }
+}
+
+int arc_select_victim(const int proc_id) {
+  arc_state_t *arc = get_arc_state(proc_id);
+
+  if (algorithm == ALGO_ARC)
+    return select_victim_ARC(arc);
+
+  return select_victim_CAR(arc);
+}
+
+void arc_insert(const int proc_id, const int proc_page_id) {
+  arc_state_t *arc = get_arc_state(proc_id);
+  const arc_list_t l = arc->list[proc_page_id];
+  const int c = get_cache_size(proc_id);
+  assert(l != ARC_T1 && l != ARC_T2);
+
+  // a ghost hit means the page was seen before, so it goes to T2
+  list_push(arc, l == ARC_NONE ? ARC_T1 : ARC_T2, proc_page_id);
+  arc->ref[proc_page_id] = false;
+  arc->last_miss_b2 = false;
+
+  // trim the ghost lists, dropping their LRU entries, so that T1 and B1 hold
+  // at most c pages, and all four lists at most 2c
+  while (arc->size[ARC_T1] + arc->size[ARC_B1] > c && arc->size[ARC_B1] > 0) {
+    list_remove(arc, arc->head[ARC_B1]);
+  }
+  while (arc->size[ARC_T1] + arc->size[ARC_T2] + arc->size[ARC_B1] +
+                 arc->size[ARC_B2] >
+             2 * c &&
+         arc->size[ARC_B1] + arc->size[ARC_B2] > 0) {
+    list_remove(arc, arc->size[ARC_B2] > 0 ? arc->head[ARC_B2]
+                                           : arc->head[ARC_B1]);
+  }
+}
+
+void arc_evict(const int proc_id, const int proc_page_id) {
+  arc_state_t *arc = get_arc_state(proc_id);
+  const arc_list_t l = arc->list[proc_page_id];
+  assert(l == ARC_T1 || l == ARC_T2);
+
+  // remember the evicted page as the MRU entry of the matching ghost list
+  list_push(arc, l == ARC_T1 ? ARC_B1 : ARC_B2, proc_page_id);
+  arc->ref[proc_page_id] = false;
+}
+
+void arc_move(const int proc_id, const int proc_page_id, const int heir_proc,
+              const int heir_page) {
+  arc_state_t *arc = get_arc_state(proc_id);
+  arc_state_t *heir = get_arc_state(heir_proc);
+  const arc_list_t l = arc->list[proc_page_id];
+  const bool ref = arc->ref[proc_page_id];
+  assert(l == ARC_T1 || l == ARC_T2);
+
+  list_remove(arc, proc_page_id);
+  arc->ref[proc_page_id] = false;
+  // a ghost entry of the heir is dropped without a ghost hit, its history
+  // doesn't apply to the frame it's taking
+  list_push(heir, l, heir_page);
+  heir->ref[heir_page] = ref;
+}
+
+void arc_clear(const int proc_id) {
+  arc_state_t *arc = get_arc_state(proc_id);
+
+  for (int i = 0; i < PROC_MAX_PAGES; i++) {
+    if (arc->list[i] != ARC_NONE)
+      list_remove(arc, i);
+    arc->ref[i] = false;
+  }
+
+  arc->p = 0;
+  arc->last_miss_b2 = false;
+}
+
+int arc_eviction_rank(const int proc_id, const int proc_page_id) {
+  arc_state_t *arc = get_arc_state(proc_id);
+
+  if (arc->list[proc_page_id] != ARC_T1 || arc->ref[proc_page_id])
+    return -1;
+
+  // position from the LRU end (or the clock hand) of T1
+  int rank = 0;
+  for (int i = arc->head[ARC_T1]; i != proc_page_id; i = arc->next[i]) {
+    rank++;
+  }
+
+  return rank;
+}
+
+void arc_sample_p(void) {
+  sampled_rounds++;
+  rounds_since_sample++;
+  const bool sample = rounds_since_sample == p_interval;
+  // when the history is full, keep every other sample, so that the kept ones
+  // and the new one are all 2 * p_interval rounds apart
+  const bool compact = sample && arc_state[0].p_history_len == ARC_P_HISTORY;
+
+  for (int p = 0; p < 4; p++) {
+    arc_state_t *arc = &arc_state[p];
+
+    if (arc->p < arc->p_min)
+      arc->p_min = arc->p;
+    if (arc->p > arc->p_max)
+      arc->p_max = arc->p;
+    arc->p_sum += arc->p;
+
+    if (!sample)
+      continue;
+
+    if (compact) {
+      for (int i = 0; i < ARC_P_HISTORY / 2; i++) {
+        arc->p_history[i] = arc->p_history[i * 2];
+      }
+      arc->p_history_len = ARC_P_HISTORY / 2;
+    }
+    arc->p_history[arc->p_history_len++] = arc->p;
+  }
+
+  if (sample) {
+    rounds_since_sample = 0;
+    if (compact)
+      p_interval *= 2;
+  }
+}
+
+void arc_print_stats(void) {
+  char buffer[256];
+
+  putchar('\n');
+  msg("--- %s Stats ---", algorithm == ALGO_ARC ? "ARC" : "CAR");
+
+  for (int p = 0; p < 4; p++) {
+    const arc_state_t *arc = &arc_state[p];
+    int len = 0;
+
+    buffer[0] = '\0';
+    for (int i = 0; i < arc->p_history_len; i++) {
+      len += snprintf(buffer + len, sizeof(buffer) - len, "%s%d",
+                      i > 0 ? " " : "", arc->p_history[i]);
+    }
+
+    msg("P%d B1/B2 Hits:     %5d/%d", p + 1, arc->b1_hits, arc->b2_hits);
+    msg("P%d p Min/Avg/Max:  %5d/%.2f/%d", p + 1, arc->p_min,
+        sampled_rounds > 0 ? arc->p_sum / (double)sampled_rounds : 0.0,
+        arc->p_max);
+    msg("P%d T1/T2/B1/B2:    %5d/%d/%d/%d", p + 1, arc->size[ARC_T1],
+        arc->size[ARC_T2], arc->size[ARC_B1], arc->size[ARC_B2]);
+    msg("P%d p History:      %s", p + 1, buffer);
+  }
+
+  msg("History Interval:  %11d rounds", p_interval);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "types.h"
+#include <stdbool.h>
+
+// reset the ARC/CAR lists and adaptation parameter of every process
+void arc_init(void);
+
+// update the lists after a hit to a resident page
+void arc_hit(const int proc_id, const int proc_page_id);
+
+// adapt p after a page fault, if the requested page is in a ghost list. must be
+// called before a victim is selected for the fault
+void arc_miss(const int proc_id, const int proc_page_id);
+
+// get the page to swap out of the process' T1 or T2, according to ARC or CAR
+int arc_select_victim(const int proc_id);
+
+// move a page being loaded into memory to T2 if it's in a ghost list, or to
+// T1 otherwise, then trim the ghost lists to the process' page frame count
+void arc_insert(const int proc_id, const int proc_page_id);
+
+// move a page being swapped out of memory from T1 or T2 to its ghost list
+void arc_evict(const int proc_id, const int proc_page_id);
+
+// hand a resident page's place in T1 or T2 over to another page, which may be
+// of another process, taking over its frame. nothing goes to a ghost list and
+// p doesn't move
+void arc_move(const int proc_id, const int proc_page_id, const int heir_proc,
+              const int heir_page);
+
+// drop every list entry of the specified process, along with its p
+void arc_clear(const int proc_id);
+
+// rank a resident page by how soon it's likely to be evicted, lower meaning
+// sooner, or -1 if the page is in T2 or was referenced (CAR)
+int arc_eviction_rank(const int proc_id, const int proc_page_id);
+
+// sample the p of every process, called once per round
+void arc_sample_p(void);
+
+// print the adaptation stats of every process
+void arc_print_stats(void);
@@ -0,0 +1,199 @@
+#include "vmem_cgroup.h"
+#include "types.h"
+#include "util.h"
+#include "vmem_helpers.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// documentation is provided in vmem_cgroup.h
+
+// hierarchy and limits of the groups, and the group of each process
+static const char *names[CGROUP_COUNT] = CGROUP_NAMES;
+static const int parents[CGROUP_COUNT] = CGROUP_PARENTS;
+static const int max_limits[CGROUP_COUNT] = CGROUP_MAX;
+static const int high_limits[CGROUP_COUNT] = CGROUP_HIGH;
+static const int low_limits[CGROUP_COUNT] = CGROUP_LOW;
+static const int proc_groups[4] = CGROUP_OF_PROC;
+
+// state and stats of every group
+static cgroup_t groups[CGROUP_COUNT];
+static int sampled_rounds;
+
+// get the group of a process, exiting on an invalid process ID
+static inline int get_group(const int proc_id) {
+  if (proc_id < 1 || proc_id > 4) {
+    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
+    exit(10);
+  }
+
+  return proc_groups[proc_id - 1];
+}
+
+// returns whether a group is a process' group or one of its ancestors
+static bool contains(const int group, const int proc_id) {
+  for (int g = get_group(proc_id); g != -1; g = parents[g]) {
+    if (g == group)
+      return true;
+  }
+
+  return false;
+}
+
+// get the page frames charged to a group, held by its processes and by the
+// processes of its descendants
+static int get_usage(const int group) {
+  int usage = 0;
+  for (int proc_id = 1; proc_id <= 4; proc_id++) {
+    if (contains(group, proc_id))
+      usage += get_amount_page_frames(proc_id);
+  }
+
+  return usage;
+}
+
+void cgroup_init(void) {
+  for (int g = 0; g < CGROUP_COUNT; g++) {
+    // groups come after their parent, so the hierarchy has no cycles
+    assert(g == 0 ? parents[g] == -1 : parents[g] >= 0 && parents[g] < g);
+    assert(low_limits[g] <= high_limits[g] && high_limits[g] <= max_limits[g]);
+    assert(max_limits[g] >= 1);
+    groups[g] = (cgroup_t){0};
+  }
+  for (int p = 0; p < 4; p++) {
+    assert(proc_groups[p] >= 0 && proc_groups[p] < CGROUP_COUNT);
+  }
+
+  sampled_rounds = 0;
+}
+
+int cgroup_select_victim(const int proc_id, const bool memory_full) {
+  for (int g = get_group(proc_id); g != -1; g = parents[g]) {
+    if (max_limits[g] < RAM_MAX_PAGES && get_usage(g) >= max_limits[g]) {
+      groups[g].limit_reclaims++;
+      return g;
+    }
+  }
+
+  if (!memory_full)
+    return -1;
+
+  // every group past its soft limit earns credit in proportion to its excess,
+  // and the one with the most credit pays the whole reclaim, so that groups
+  // are picked as often as their share of the excess
+  int victim = -1;
+  long total_excess = 0;
+  for (int g = 0; g < CGROUP_COUNT; g++) {
+    const int excess = get_usage(g) - high_limits[g];
+    if (high_limits[g] >= RAM_MAX_PAGES || excess <= 0)
+      continue;
+
+    groups[g].credit += excess;
+    total_excess += excess;
+    if (victim == -1 || groups[g].credit > groups[victim].credit)
+      victim = g;
+  }
+
+  if (victim != -1) {
+    groups[victim].credit -= total_excess;
+    groups[victim].soft_reclaims++;
+  }
+
+  return victim;
+}
+
+int cgroup_select_proc(const int group) {
+  int victim = -1, most_frames = 0;
+  bool victim_protected = true;
+
+  for (int proc_id = 1; proc_id <= 4; proc_id++) {
+    const int frames = get_amount_page_frames(proc_id);
+    const bool protect = cgroup_is_protected(proc_id);
+
+    if (!contains(group, proc_id) || frames == 0 ||
+        (protect && !victim_protected))
+      continue;
+
+    if (victim == -1 || (victim_protected && !protect) ||
+        frames > most_frames) {
+      victim = proc_id;
+      most_frames = frames;
+      victim_protected = protect;
+    }
+  }
+  // a group is only reclaimed from when it holds page frames
+  assert(victim != -1);
+
+  return victim;
+}
+
+bool cgroup_can_charge(const int proc_id) {
+  for (int g = get_group(proc_id); g != -1; g = parents[g]) {
+    if (max_limits[g] < RAM_MAX_PAGES && get_usage(g) >= max_limits[g])
+      return false;
+  }
+
+  return true;
+}
+
+bool cgroup_is_protected(const int proc_id) {
+  const int group = get_group(proc_id);
+  return get_usage(group) <= low_limits[group];
+}
+
+void cgroup_count_request(const int proc_id, const bool fault) {
+  for (int g = get_group(proc_id); g != -1; g = parents[g]) {
+    groups[g].requests++;
+    if (fault)
+      groups[g].faults++;
+  }
+}
+
+void cgroup_count_reclaim(const int proc_id, const int scanned) {
+  for (int g = get_group(proc_id); g != -1; g = parents[g]) {
+    groups[g].reclaimed++;
+    groups[g].scanned += scanned;
+  }
+}
+
+void cgroup_sample(void) {
+  for (int g = 0; g < CGROUP_COUNT; g++) {
+    const int usage = get_usage(g);
+
+    groups[g].usage_sum += usage;
+    if (usage > groups[g].peak_usage)
+      groups[g].peak_usage = usage;
+  }
+  sampled_rounds++;
+}
+
+void cgroup_print_stats(void) {
+  putchar('\n');
+  msg("--- Cgroup Stats ---");
+
+  for (int g = 0; g < CGROUP_COUNT; g++) {
+    const cgroup_t *cg = &groups[g];
+
+    if (g > 0)
+      putchar('\n');
+    msg("Group:             %11s", names[g]);
+    msg("Parent:            %11s", g > 0 ? names[parents[g]] : "-");
+    msg("Low/High/Max:       %3d/%3d/%3d", low_limits[g], high_limits[g],
+        max_limits[g]);
+    msg("Final Usage:       %11d", get_usage(g));
+    msg("Peak Usage:        %11d", cg->peak_usage);
+    msg("Avg Usage:         %11.2f",
+        sampled_rounds > 0 ? cg->usage_sum / (double)sampled_rounds : 0.0);
+    msg("Requests:          %11d", cg->requests);
+    msg("Page Faults:       %11d", cg->faults);
+    msg("Page Fault Rate:   %10.2f%%",
+        cg->requests > 0 ? (cg->faults / (double)cg->requests) * 100 : 0.0);
+    msg("Limit Reclaims:    %11d", cg->limit_reclaims);
+    msg("Soft Reclaims:     %11d", cg->soft_reclaims);
+    msg("Reclaimed Frames:  %11d", cg->reclaimed);
+    // frames reclaimed per page looked at, referenced pages being passed over
+    msg("Scan Efficiency:   %10.2f%%",
+        cg->scanned > 0 ? (cg->reclaimed / (double)cg->scanned) * 100 : 0.0);
+  }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "types.h"
+#include <stdbool.h>
+
+// reset the state and stats of every memory cgroup
+void cgroup_init(void);
+
+// get the group to reclaim a frame from before a process can take one: the
+// innermost of its groups at its hard limit, or else, if main memory is full,
+// one of the groups past their soft limit, chosen in proportion to their
+// excess. -1 if there's none, leaving the usual replacement to it
+int cgroup_select_victim(const int proc_id, const bool memory_full);
+
+// get the process of a group or of its descendants to take a frame from, the
+// one with the most page frames, passing over the ones whose group is within
+// its protection unless there's no other
+int cgroup_select_proc(const int group);
+
+// returns whether a process can be charged another page frame, none of its
+// groups being at its hard limit
+bool cgroup_can_charge(const int proc_id);
+
+// returns whether the group of a process is within its protection
+bool cgroup_is_protected(const int proc_id);
+
+// account a memory request of a process, and whether it faulted
+void cgroup_count_request(const int proc_id, const bool fault);
+
+// account a frame reclaimed from a process, and the pages looked at to find it
+void cgroup_count_reclaim(const int proc_id, const int scanned);
+
+// sample the frames charged to every group, at the end of each round
+void cgroup_sample(void);
+
+// print the limits, usage, fault rates and reclaim efficiency of every group
+void cgroup_print_stats(void);
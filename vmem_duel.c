@@ -0,0 +1,404 @@
+#include "vmem_duel.h"
+#include "types.h"
+#include "util.h"
+#include "vmem_helpers.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// documentation is provided in vmem_duel.h
+
+extern page_algo_t algorithm;
+extern int current_round;
+extern int k_param;
+
+// names of the candidate policies, indexed by duel_policy_t
+static const char *DUEL_POLICY_STR[DUEL_CANDIDATES] = {"NRU", "2ndC", "Aging",
+                                                       "WS"};
+
+// set dueling state of each process
+static duel_state_t duel_state[4];
+// epochs evaluated so far
+static int epochs;
+
+// get the set dueling state of the specified process
+static duel_state_t *get_duel_state(const int proc_id) {
+  assert(algorithm == ALGO_DUEL);
+
+  if (proc_id < 1 || proc_id > 4) {
+    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
+    exit(10);
+  }
+
+  return &duel_state[proc_id - 1];
+}
+
+// the WS candidate's window, in accesses of the process
+static inline int get_ws_window(void) {
+  return k_param > 0 ? k_param : DUEL_WS_K;
+}
+
+// reset a tracker to an empty cache
+static void tracker_reset(duel_tracker_t *t) {
+  *t = (duel_tracker_t){0};
+}
+
+// record an access to a page, whether it's in the cache or not
+static void tracker_access(duel_tracker_t *t, const int page, const bool write,
+                           const int vtime) {
+  t->referenced |= 1u << page;
+  if (write)
+    t->modified |= 1u << page;
+  t->last_use[page] = vtime;
+}
+
+// add a page to the cache, at the back of the 2ndC queue
+static void tracker_insert(duel_tracker_t *t, const int page) {
+  assert(!(t->resident & (1u << page)));
+  assert(t->fifo_len < PROC_MAX_PAGES);
+
+  t->resident |= 1u << page;
+  t->age_bits[page] = 0;
+  t->fifo[(t->fifo_head + t->fifo_len++) % PROC_MAX_PAGES] = page;
+}
+
+// drop a page from the cache, clearing its bits as swap_out_page does
+static void tracker_remove(duel_tracker_t *t, const int page) {
+  assert(t->resident & (1u << page));
+
+  t->resident &= ~(1u << page);
+  t->referenced &= ~(1u << page);
+  t->modified &= ~(1u << page);
+  t->age_bits[page] = 0;
+
+  // close the gap in the 2ndC queue
+  int j = 0;
+  for (int i = 0; i < t->fifo_len; i++) {
+    const int p = t->fifo[(t->fifo_head + i) % PROC_MAX_PAGES];
+    if (p != page)
+      t->fifo[(t->fifo_head + j++) % PROC_MAX_PAGES] = p;
+  }
+  t->fifo_len = j;
+}
+
+// NRU, the first page of the lowest (R, M) category
+static int select_NRU(const duel_tracker_t *t) {
+  int victim = -1, victim_class = 4;
+
+  for (int i = 0; i < PROC_MAX_PAGES; i++) {
+    if (!(t->resident & (1u << i)))
+      continue;
+
+    const int class = (t->referenced & (1u << i) ? 2 : 0) +
+                      (t->modified & (1u << i) ? 1 : 0);
+    if (class < victim_class) {
+      victim = i;
+      victim_class = class;
+    }
+  }
+
+  return victim;
+}
+
+// 2ndC, the oldest page of the queue without its R bit. referenced pages get a
+// second chance, moving to the back of the queue
+static int select_2ndC(duel_tracker_t *t) {
+  assert(t->fifo_len > 0); // there should be a page in queue
+
+  while (true) {
+    const int page = t->fifo[t->fifo_head];
+
+    if (!(t->referenced & (1u << page)))
+      return page;
+
+    t->referenced &= ~(1u << page);
+    t->fifo_head = (t->fifo_head + 1) % PROC_MAX_PAGES;
+    t->fifo[(t->fifo_head + t->fifo_len - 1) % PROC_MAX_PAGES] = page;
+  }
+}
+
+// Aging, the page with the lowest age bits
+static int select_aging(const duel_tracker_t *t) {
+  int victim = -1;
+
+  for (int i = 0; i < PROC_MAX_PAGES; i++) {
+    if ((t->resident & (1u << i)) &&
+        (victim == -1 || t->age_bits[i] < t->age_bits[victim]))
+      victim = i;
+  }
+
+  return victim;
+}
+
+// WS, the first page outside the working set from where the hand stopped, or
+// the least recently used page if the whole working set is in the cache
+static int select_WS(duel_tracker_t *t, const int vtime) {
+  int oldest = -1;
+
+  for (int n = 0; n < PROC_MAX_PAGES; n++) {
+    const int page = (t->hand + n) % PROC_MAX_PAGES;
+    if (!(t->resident & (1u << page)))
+      continue;
+
+    if (vtime - t->last_use[page] >= get_ws_window()) {
+      t->hand = (page + 1) % PROC_MAX_PAGES;
+      return page;
+    }
+    if (oldest == -1 || t->last_use[page] < t->last_use[oldest])
+      oldest = page;
+  }
+
+  return oldest;
+}
+
+// get the victim of a candidate policy within a tracker
+static int tracker_select(duel_tracker_t *t, const duel_policy_t policy,
+                          const int vtime) {
+  assert(t->resident != 0); // there should be a page in the cache
+
+  switch (policy) {
+  case DUEL_NRU:
+    return select_NRU(t);
+  case DUEL_2ndC:
+    return select_2ndC(t);
+  case DUEL_AGING:
+    return select_aging(t);
+  case DUEL_WS:
+    return select_WS(t, vtime);
+  default:
+    assert(false);
+    return -1;
+  }
+}
+
+// age the R bits of a tracker at the end of a round, as vmem_sim does for the
+// live algorithm: shifted into the age bits and cleared every round for Aging,
+// cleared every REF_CLEAR_INTERVAL rounds for NRU, and left to the hand for
+// 2ndC. WS only uses the last access times
+static void tracker_tick(duel_tracker_t *t, const duel_policy_t policy) {
+  if (policy == DUEL_AGING) {
+    for (int i = 0; i < PROC_MAX_PAGES; i++) {
+      t->age_bits[i] >>= 1;
+      if (t->referenced & (1u << i))
+        t->age_bits[i] |= 0b10000000;
+    }
+    t->referenced = 0;
+  } else if (policy == DUEL_NRU && current_round % REF_CLEAR_INTERVAL == 0) {
+    t->referenced = 0;
+  }
+}
+
+// simulate an access to a sampled page on the candidate's shadow cache, sized
+// to the process' page frames scaled down by the sampling stride
+static void shadow_access(duel_state_t *s, const duel_policy_t policy,
+                          const int proc_id, const int page, const bool write) {
+  duel_tracker_t *t = &s->shadow[policy];
+  int capacity = get_amount_page_frames(proc_id) / DUEL_SAMPLE_STRIDE;
+  if (capacity < 1)
+    capacity = 1;
+
+  tracker_access(t, page, write, s->vtime);
+  if (t->resident & (1u << page))
+    return;
+
+  s->epoch_faults[policy]++;
+  s->total_faults[policy]++;
+
+  // the process may have lost frames since the last fault
+  while (__builtin_popcount(t->resident) >= capacity) {
+    tracker_remove(t, tracker_select(t, policy, s->vtime));
+  }
+  tracker_insert(t, page);
+}
+
+void duel_init(void) {
+  for (int proc_id = 1; proc_id <= 4; proc_id++) {
+    duel_state[proc_id - 1] = (duel_state_t){0};
+    duel_state[proc_id - 1].live = DUEL_AGING;
+    duel_clear(proc_id);
+  }
+
+  epochs = 0;
+}
+
+void duel_access(const int proc_id, const int proc_page_id, const bool write) {
+  duel_state_t *s = get_duel_state(proc_id);
+  s->vtime++;
+
+  for (int c = 0; c < DUEL_CANDIDATES; c++) {
+    tracker_access(&s->live_state[c], proc_page_id, write, s->vtime);
+
+    if (proc_page_id % DUEL_SAMPLE_STRIDE == 0)
+      shadow_access(s, c, proc_id, proc_page_id, write);
+  }
+}
+
+int duel_select_victim(const int proc_id) {
+  duel_state_t *s = get_duel_state(proc_id);
+
+  return tracker_select(&s->live_state[s->live], s->live, s->vtime);
+}
+
+void duel_insert(const int proc_id, const int proc_page_id) {
+  duel_state_t *s = get_duel_state(proc_id);
+
+  for (int c = 0; c < DUEL_CANDIDATES; c++) {
+    tracker_insert(&s->live_state[c], proc_page_id);
+  }
+}
+
+void duel_evict(const int proc_id, const int proc_page_id) {
+  duel_state_t *s = get_duel_state(proc_id);
+
+  for (int c = 0; c < DUEL_CANDIDATES; c++) {
+    tracker_remove(&s->live_state[c], proc_page_id);
+  }
+}
+
+void duel_move(const int proc_id, const int proc_page_id, const int heir_proc,
+               const int heir_page) {
+  duel_state_t *s = get_duel_state(proc_id);
+  duel_state_t *heir = get_duel_state(heir_proc);
+  const uint32_t bit = 1u << proc_page_id;
+
+  for (int c = 0; c < DUEL_CANDIDATES; c++) {
+    duel_tracker_t *from = &s->live_state[c];
+    duel_tracker_t *to = &heir->live_state[c];
+    const bool referenced = from->referenced & bit;
+    const bool modified = from->modified & bit;
+    const page_age_bits_t age_bits = from->age_bits[proc_page_id];
+
+    tracker_remove(from, proc_page_id);
+    tracker_insert(to, heir_page);
+    if (referenced)
+      to->referenced |= 1u << heir_page;
+    if (modified)
+      to->modified |= 1u << heir_page;
+    to->age_bits[heir_page] = age_bits;
+    to->last_use[heir_page] = heir->vtime;
+  }
+}
+
+void duel_clear(const int proc_id) {
+  duel_state_t *s = get_duel_state(proc_id);
+
+  for (int c = 0; c < DUEL_CANDIDATES; c++) {
+    tracker_reset(&s->live_state[c]);
+    tracker_reset(&s->shadow[c]);
+    s->epoch_faults[c] = 0;
+  }
+
+  s->vtime = 0;
+}
+
+void duel_tick(void) {
+  assert(algorithm == ALGO_DUEL);
+  const bool epoch_end = current_round % DUEL_EPOCH == 0;
+
+  for (int p = 0; p < 4; p++) {
+    duel_state_t *s = &duel_state[p];
+
+    for (int c = 0; c < DUEL_CANDIDATES; c++) {
+      tracker_tick(&s->live_state[c], c);
+      tracker_tick(&s->shadow[c], c);
+    }
+    s->rounds_live[s->live]++;
+
+    if (!epoch_end)
+      continue;
+
+    // switch only when another candidate did strictly better
+    duel_policy_t best = s->live;
+    for (int c = 0; c < DUEL_CANDIDATES; c++) {
+      if (s->epoch_faults[c] < s->epoch_faults[best])
+        best = c;
+    }
+
+    if (best != s->live) {
+      msg("Set dueling: P%d switched from %s to %s (%d vs %d shadow faults)",
+          p + 1, DUEL_POLICY_STR[s->live], DUEL_POLICY_STR[best],
+          s->epoch_faults[s->live], s->epoch_faults[best]);
+      s->switches++;
+    }
+
+    s->live_faults += s->epoch_faults[s->live];
+    s->live = best;
+    for (int c = 0; c < DUEL_CANDIDATES; c++) {
+      s->epoch_faults[c] = 0;
+    }
+  }
+
+  if (epoch_end)
+    epochs++;
+}
+
+int duel_eviction_rank(const int proc_id, const int proc_page_id) {
+  const duel_state_t *s = get_duel_state(proc_id);
+  const duel_tracker_t *t = &s->live_state[s->live];
+  const bool referenced = t->referenced & (1u << proc_page_id);
+
+  switch (s->live) {
+  case DUEL_NRU:
+    return referenced ? -1 : 0;
+  case DUEL_2ndC:
+    if (referenced)
+      return -1;
+    for (int i = 0; i < t->fifo_len; i++) {
+      if (t->fifo[(t->fifo_head + i) % PROC_MAX_PAGES] == proc_page_id)
+        return i;
+    }
+    return -1;
+  case DUEL_AGING:
+    // the MSB holds the reference bit of the last round
+    return (t->age_bits[proc_page_id] & 0b10000000)
+               ? -1
+               : t->age_bits[proc_page_id];
+  case DUEL_WS:
+    return s->vtime - t->last_use[proc_page_id] < get_ws_window()
+               ? -1
+               : t->last_use[proc_page_id];
+  default:
+    assert(false);
+    return -1;
+  }
+}
+
+void duel_print_stats(void) {
+  int fixed_faults[DUEL_CANDIDATES] = {0};
+  int adaptive_faults = 0;
+
+  putchar('\n');
+  msg("--- Set Dueling Stats ---");
+  msg("Epochs:            %11d", epochs);
+
+  for (int p = 0; p < 4; p++) {
+    const duel_state_t *s = &duel_state[p];
+
+    msg("P%d Live Policy:    %11s", p + 1, DUEL_POLICY_STR[s->live]);
+    msg("P%d Switches:       %11d", p + 1, s->switches);
+    msg("P%d Shadow Faults:  NRU %d | 2ndC %d | Aging %d | WS %d", p + 1,
+        s->total_faults[DUEL_NRU], s->total_faults[DUEL_2ndC],
+        s->total_faults[DUEL_AGING], s->total_faults[DUEL_WS]);
+    msg("P%d Rounds Live:    NRU %d | 2ndC %d | Aging %d | WS %d", p + 1,
+        s->rounds_live[DUEL_NRU], s->rounds_live[DUEL_2ndC],
+        s->rounds_live[DUEL_AGING], s->rounds_live[DUEL_WS]);
+
+    // faults of the epoch still in progress count for the live candidate
+    adaptive_faults += s->live_faults + s->epoch_faults[s->live];
+    for (int c = 0; c < DUEL_CANDIDATES; c++) {
+      fixed_faults[c] += s->total_faults[c];
+    }
+  }
+
+  // the same policy for every process over the whole run
+  duel_policy_t best = DUEL_NRU;
+  for (int c = 0; c < DUEL_CANDIDATES; c++) {
+    if (fixed_faults[c] < fixed_faults[best])
+      best = c;
+  }
+
+  msg("Adaptive Faults:   %11d (shadow)", adaptive_faults);
+  msg("Best Fixed Faults: %11d (shadow, %s)", fixed_faults[best],
+      DUEL_POLICY_STR[best]);
+}
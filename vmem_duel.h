@@ -0,0 +1,43 @@
+#pragma once
+
+#include "types.h"
+#include <stdbool.h>
+
+// reset the set dueling state of every process, starting with Aging as the
+// live policy
+void duel_init(void);
+
+// track an access of a process, updating the candidates' view of the resident
+// pages and, for sampled pages, simulating the access on every shadow cache.
+// must be called before a fault for the page is handled
+void duel_access(const int proc_id, const int proc_page_id, const bool write);
+
+// get the page to swap out according to the process' live policy
+int duel_select_victim(const int proc_id);
+
+// track a page being loaded into memory
+void duel_insert(const int proc_id, const int proc_page_id);
+
+// stop tracking a page being swapped out of memory
+void duel_evict(const int proc_id, const int proc_page_id);
+
+// hand a resident page's bits in every candidate over to another page, which
+// may be of another process, taking over its frame
+void duel_move(const int proc_id, const int proc_page_id, const int heir_proc,
+               const int heir_page);
+
+// drop the resident pages and shadow caches of the specified process
+void duel_clear(const int proc_id);
+
+// age the candidates' reference bits, called once per round. every DUEL_EPOCH
+// rounds, switch the live policy of each process to the candidate with the
+// fewest shadow faults, logging the switch
+void duel_tick(void);
+
+// rank a resident page by how soon the process' live policy is likely to evict
+// it, lower meaning sooner, or -1 if the page isn't cold
+int duel_eviction_rank(const int proc_id, const int proc_page_id);
+
+// print the stats of every process, comparing the shadow faults of the
+// adaptive choice with those of the best fixed candidate
+void duel_print_stats(void);
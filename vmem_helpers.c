@@ -1,6 +1,17 @@
 #include "vmem_helpers.h"
 #include "types.h"
 #include "util.h"
+#include "vmem_arc.h"
+#include "vmem_duel.h"
+#include "vmem_lfu.h"
+#include "vmem_lirs.h"
+#include "vmem_mglru.h"
+#include "vmem_pt.h"
+#include "vmem_shared.h"
+#include "vmem_swapfile.h"
+#include "vmem_tlb.h"
+#include "vmem_workingset.h"
+#include "vmem_zswap.h"
 #include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -21,12 +32,40 @@ extern queue_t *page_queue_P1;
 extern queue_t *page_queue_P2;
 extern queue_t *page_queue_P3;
 extern queue_t *page_queue_P4;
-extern set_t *page_wset_P1;
-extern set_t *page_wset_P2;
-extern set_t *page_wset_P3;
-extern set_t *page_wset_P4;
-extern int clock_counter;
-extern bool wset_check_performed;
+extern int proc_vtime[4];
+extern int wsclock_hand[4];
+extern readahead_t readahead[4];
+extern tlb_mode_t tlb_mode;
+extern pt_format_t pt_format;
+extern huge_policy_t huge_policy;
+extern huge_state_t huge_state[4];
+extern bool zswap_enabled;
+extern char *swap_filename;
+extern bool workingset_enabled;
+extern frame_entry_t frame_table[RAM_MAX_PAGES];
+extern int resident_head[4];
+extern int resident_count[4];
+
+bool algo_uses_aging(void) {
+  return algorithm == ALGO_LRU || algorithm == ALGO_CFLRU ||
+         algorithm == ALGO_LRU_WC;
+}
+
+bool algo_uses_queue(void) {
+  return algorithm == ALGO_2ndC || algorithm == ALGO_2ndC_WC;
+}
+
+bool algo_uses_arc(void) {
+  return algorithm == ALGO_ARC || algorithm == ALGO_CAR;
+}
+
+bool algo_uses_lirs(void) {
+  return algorithm == ALGO_LIRS || algorithm == ALGO_CLOCKPRO;
+}
+
+bool algo_uses_lfu(void) {
+  return algorithm == ALGO_LFU || algorithm == ALGO_LRFU;
+}
 
 bool is_in_memory(const vmem_io_request_t req) {
   switch (req.proc_id) {
@@ -259,6 +298,15 @@ void set_page_frame(const int proc_id, const int proc_page_id,
                     const int page_frame) {
   assert((page_frame == -1) || (page_frame >= 0 && page_frame < RAM_MAX_PAGES));
 
+  if (pt_format != PT_FLAT) {
+    // the radix and hashed tables hold the frames instead of the page entries
+    if (page_frame == -1)
+      pt_unmap(proc_id, proc_page_id);
+    else
+      pt_map(proc_id, proc_page_id, page_frame);
+    return;
+  }
+
   switch (proc_id) {
   case 1:
     page_table_P1[proc_page_id].page_frame = page_frame;
@@ -279,6 +327,9 @@ void set_page_frame(const int proc_id, const int proc_page_id,
 }
 
 int get_page_frame(const int proc_id, const int proc_page_id) {
+  if (pt_format != PT_FLAT)
+    return pt_lookup(proc_id, proc_page_id);
+
   switch (proc_id) {
   case 1:
     return page_table_P1[proc_page_id].page_frame;
@@ -296,7 +347,7 @@ int get_page_frame(const int proc_id, const int proc_page_id) {
 
 void set_age_bits(const int proc_id, const int proc_page_id,
                   page_age_bits_t age) {
-  assert(algorithm == ALGO_LRU);
+  assert(algo_uses_aging());
 
   switch (proc_id) {
   case 1:
@@ -318,7 +369,7 @@ void set_age_bits(const int proc_id, const int proc_page_id,
 }
 
 page_age_bits_t get_age_bits(const int proc_id, const int proc_page_id) {
-  assert(algorithm == ALGO_LRU);
+  assert(algo_uses_aging());
 
   switch (proc_id) {
   case 1:
@@ -377,7 +428,7 @@ int get_age_clock(const int proc_id, const int proc_page_id) {
 }
 
 void enqueue_page(const int proc_id, const int proc_page_id) {
-  assert(algorithm == ALGO_2ndC);
+  assert(algo_uses_queue());
 
   switch (proc_id) {
   case 1:
@@ -399,7 +450,7 @@ void enqueue_page(const int proc_id, const int proc_page_id) {
 }
 
 int dequeue_page(const int proc_id) {
-  assert(algorithm == ALGO_2ndC);
+  assert(algo_uses_queue());
   int proc_page_id = -1;
 
   switch (proc_id) {
@@ -424,132 +475,351 @@ int dequeue_page(const int proc_id) {
   return proc_page_id;
 }
 
-void set_add_page(const int proc_id, const int proc_page_id) {
-  assert(algorithm == ALGO_WS);
+queue_t *get_queue(const int proc_id) {
+  assert(algo_uses_queue());
 
   switch (proc_id) {
   case 1:
-    set_add(page_wset_P1, proc_page_id);
-    break;
+    return page_queue_P1;
   case 2:
-    set_add(page_wset_P2, proc_page_id);
-    break;
+    return page_queue_P2;
   case 3:
-    set_add(page_wset_P3, proc_page_id);
-    break;
+    return page_queue_P3;
   case 4:
-    set_add(page_wset_P4, proc_page_id);
-    break;
+    return page_queue_P4;
   default:
     fprintf(stderr, "Invalid process ID: %d\n", proc_id);
     exit(10);
   }
 }
 
-void set_remove_page(const int proc_id, const int proc_page_id) {
+bool in_working_set(const int proc_id, const int proc_page_id) {
   assert(algorithm == ALGO_WS);
+  assert(proc_id >= 1 && proc_id <= 4);
+
+  return proc_vtime[proc_id - 1] - get_age_clock(proc_id, proc_page_id) <
+         k_param;
+}
 
+int get_amount_page_frames(const int proc_id) {
+  assert(proc_id >= 1 && proc_id <= 4);
+
+  return resident_count[proc_id - 1];
+}
+
+int get_first_resident_frame(const int proc_id) {
+  assert(proc_id >= 1 && proc_id <= 4);
+
+  return resident_head[proc_id - 1];
+}
+
+// map a page frame to its page, pushing it to the owner's resident list
+static void link_frame(const int page_frame, const int proc_id,
+                       const int proc_page_id) {
+  frame_entry_t *entry = &frame_table[page_frame];
+  assert(entry->proc_id == 0); // frame should be unmapped
+
+  entry->proc_id = proc_id;
+  entry->page_id = proc_page_id;
+  entry->prev = -1;
+  entry->next = resident_head[proc_id - 1];
+
+  if (entry->next != -1)
+    frame_table[entry->next].prev = page_frame;
+
+  resident_head[proc_id - 1] = page_frame;
+  resident_count[proc_id - 1]++;
+}
+
+// unmap a page frame, removing it from the owner's resident list
+static void unlink_frame(const int page_frame) {
+  frame_entry_t *entry = &frame_table[page_frame];
+  const int proc_id = entry->proc_id;
+  assert(proc_id != 0); // frame should be mapped
+
+  if (entry->prev != -1)
+    frame_table[entry->prev].next = entry->next;
+  else
+    resident_head[proc_id - 1] = entry->next;
+
+  if (entry->next != -1)
+    frame_table[entry->next].prev = entry->prev;
+
+  resident_count[proc_id - 1]--;
+  *entry = (frame_entry_t){0, -1, -1, -1};
+}
+
+page_table_entry_t *get_page_table(const int proc_id) {
   switch (proc_id) {
   case 1:
-    set_remove(page_wset_P1, proc_page_id);
-    break;
+    return page_table_P1;
   case 2:
-    set_remove(page_wset_P2, proc_page_id);
-    break;
+    return page_table_P2;
   case 3:
-    set_remove(page_wset_P3, proc_page_id);
-    break;
+    return page_table_P3;
   case 4:
-    set_remove(page_wset_P4, proc_page_id);
-    break;
+    return page_table_P4;
   default:
     fprintf(stderr, "Invalid process ID: %d\n", proc_id);
     exit(10);
   }
 }
 
-bool set_contains_page(const int proc_id, const int proc_page_id) {
-  assert(algorithm == ALGO_WS);
+void clear_page_queue(const int proc_id) {
+  assert(algo_uses_queue());
+  queue_t *q = get_queue(proc_id);
 
-  switch (proc_id) {
-  case 1:
-    return set_contains(page_wset_P1, proc_page_id);
-  case 2:
-    return set_contains(page_wset_P2, proc_page_id);
-  case 3:
-    return set_contains(page_wset_P3, proc_page_id);
-  case 4:
-    return set_contains(page_wset_P4, proc_page_id);
-  default:
-    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
-    exit(10);
+  while (dequeue(q) != -1)
+    ;
+}
+
+void remove_queued_page(const int proc_id, const int proc_page_id) {
+  assert(algo_uses_queue());
+  queue_t *q = get_queue(proc_id);
+  queue_t *kept = create_queue();
+  int page;
+
+  while ((page = dequeue(q)) != -1) {
+    if (page != proc_page_id)
+      enqueue(kept, page);
   }
+  while ((page = dequeue(kept)) != -1) {
+    enqueue(q, page);
+  }
+
+  free_queue(kept);
 }
 
-queue_t *get_queue(const int proc_id) {
-  assert(algorithm == ALGO_2ndC);
+void swap_in_page(const int proc_id, const int proc_page_id,
+                  const int page_frame) {
+  assert(!get_valid(proc_id, proc_page_id));
+
+  // the refault distance is taken before the page adds to the process' frames
+  if (workingset_enabled)
+    workingset_refault(proc_id, proc_page_id);
+
+  main_memory[page_frame] = true;
+  link_frame(page_frame, proc_id, proc_page_id);
+  set_page_frame(proc_id, proc_page_id, page_frame);
+  set_valid(proc_id, proc_page_id, true);
+  if (get_page_table(proc_id)[proc_page_id].shared_id != -1)
+    shared_set_owner(proc_id, proc_page_id);
+  if (zswap_enabled)
+    zswap_load(proc_id, proc_page_id);
+
+  if (algo_uses_queue()) {
+    // newest page goes to the back of the queue
+    enqueue_page(proc_id, proc_page_id);
+  } else if (algo_uses_arc()) {
+    arc_insert(proc_id, proc_page_id);
+  } else if (algo_uses_lirs()) {
+    lirs_insert(proc_id, proc_page_id);
+  } else if (algorithm == ALGO_MGLRU) {
+    mglru_insert(proc_id, proc_page_id);
+  } else if (algo_uses_lfu()) {
+    lfu_insert(proc_id, proc_page_id);
+  } else if (algorithm == ALGO_DUEL) {
+    duel_insert(proc_id, proc_page_id);
+  }
+}
 
-  switch (proc_id) {
-  case 1:
-    return page_queue_P1;
-  case 2:
-    return page_queue_P2;
-  case 3:
-    return page_queue_P3;
-  case 4:
-    return page_queue_P4;
-  default:
-    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
-    exit(10);
+int swap_out_page(const int proc_id, const int proc_page_id) {
+  const int page_frame = get_page_frame(proc_id, proc_page_id);
+  assert(page_frame != -1); // page should be in memory
+
+  if (algorithm == ALGO_WS && wsclock_hand[proc_id - 1] == page_frame) {
+    // move the hand off the frame being freed, -1 wraps around to the head
+    wsclock_hand[proc_id - 1] = frame_table[page_frame].next;
+  }
+
+  if (in_huge_page(proc_id, proc_page_id)) {
+    // the rest of the huge page stays in memory as base pages
+    split_huge_page(proc_id, proc_page_id);
+    huge_state[proc_id - 1].splits++;
+  }
+  if (huge_policy != HUGE_OFF)
+    huge_state[proc_id - 1].touched &= ~(1u << proc_page_id);
+
+  // the page's translation can't be used once its frame is freed
+  if (tlb_mode != TLB_OFF)
+    tlb_shootdown(proc_id, proc_page_id);
+  // and neither can the other mappings of a shared page pointing to it
+  if (get_page_table(proc_id)[proc_page_id].shared_id != -1)
+    shared_unmap(proc_id, proc_page_id);
+
+  if (workingset_enabled)
+    workingset_evict(proc_id, proc_page_id);
+
+  // update page frame
+  unlink_frame(page_frame);
+  set_page_frame(proc_id, proc_page_id, -1);
+
+  // update flag bits
+  set_valid(proc_id, proc_page_id, false);
+  set_referenced(proc_id, proc_page_id, false);
+  set_modified(proc_id, proc_page_id, false);
+  get_page_table(proc_id)[proc_page_id].cleaned = false;
+
+  if (get_page_table(proc_id)[proc_page_id].prefetched) {
+    // evicted before its first access, the readahead window was too large
+    readahead_t *ra = &readahead[proc_id - 1];
+    ra->wasted++;
+    ra->window = ra->window / 2 > READAHEAD_MIN_WINDOW ? ra->window / 2
+                                                       : READAHEAD_MIN_WINDOW;
+    get_page_table(proc_id)[proc_page_id].prefetched = false;
   }
+
+  // reset algorithm-specific data
+  get_page_table(proc_id)[proc_page_id].clock_passes = 0;
+  if (algo_uses_aging()) {
+    set_age_bits(proc_id, proc_page_id, 0);
+  } else if (algorithm == ALGO_WS) {
+    set_age_clock(proc_id, proc_page_id, 0);
+    // a pending writeback is moot once the page is gone
+    get_page_table(proc_id)[proc_page_id].writeback_pending = false;
+  } else if (algo_uses_arc()) {
+    arc_evict(proc_id, proc_page_id);
+  } else if (algo_uses_lirs()) {
+    lirs_evict(proc_id, proc_page_id);
+  } else if (algorithm == ALGO_MGLRU) {
+    mglru_evict(proc_id, proc_page_id);
+  } else if (algo_uses_lfu()) {
+    lfu_evict(proc_id, proc_page_id);
+  } else if (algorithm == ALGO_DUEL) {
+    duel_evict(proc_id, proc_page_id);
+  }
+
+  return page_frame;
 }
 
-set_t *get_set(const int proc_id) {
-  assert(algorithm == ALGO_WS);
+bool in_huge_page(const int proc_id, const int proc_page_id) {
+  if (huge_policy == HUGE_OFF)
+    return false;
 
-  switch (proc_id) {
-  case 1:
-    return page_wset_P1;
-  case 2:
-    return page_wset_P2;
-  case 3:
-    return page_wset_P3;
-  case 4:
-    return page_wset_P4;
-  default:
+  if (proc_id < 1 || proc_id > 4) {
     fprintf(stderr, "Invalid process ID: %d\n", proc_id);
     exit(10);
   }
+
+  return huge_state[proc_id - 1].huge[proc_page_id >> HUGE_ORDER];
 }
 
-int get_min_page_frames(void) {
-  int min_page_frames = RAM_MAX_PAGES;
+void split_huge_page(const int proc_id, const int proc_page_id) {
+  assert(in_huge_page(proc_id, proc_page_id));
+
+  huge_state[proc_id - 1].huge[proc_page_id >> HUGE_ORDER] = false;
+  // the huge page's TLB entry maps every one of its pages
+  if (tlb_mode != TLB_OFF)
+    tlb_shootdown(proc_id, proc_page_id);
 
-  for (int proc_id = 1; proc_id <= 4; proc_id++) {
-    // count the number of pages that are in memory for each process
-    int page_frames = 0;
+  dmsg("Huge page P%d: split region %02d", proc_id,
+       proc_page_id >> HUGE_ORDER);
+}
 
-    for (int j = 0; j < PROC_MAX_PAGES; j++) {
-      if (get_valid(proc_id, j))
-        page_frames++;
-    }
+// unmap the page held by a frame so that it can be moved to another one. the
+// page keeps its flags and algorithm-specific data
+static void unmap_for_move(const int page_frame, const int proc_id,
+                           const int proc_page_id) {
+  if (algorithm == ALGO_WS && wsclock_hand[proc_id - 1] == page_frame)
+    wsclock_hand[proc_id - 1] = frame_table[page_frame].next;
+
+  unlink_frame(page_frame);
+  set_page_frame(proc_id, proc_page_id, -1);
+  if (tlb_mode != TLB_OFF)
+    tlb_shootdown(proc_id, proc_page_id);
+  if (get_page_table(proc_id)[proc_page_id].shared_id != -1)
+    shared_shootdown(proc_id, proc_page_id);
+}
 
-    if (page_frames < min_page_frames) {
-      min_page_frames = page_frames;
-    }
+void exchange_frames(const int frame_a, const int frame_b) {
+  const frame_entry_t a = frame_table[frame_a];
+  const frame_entry_t b = frame_table[frame_b];
+
+  // the pages' contents move along with them
+  if (swap_filename != NULL)
+    swapfile_exchange(frame_a, frame_b);
+  assert(frame_a != frame_b);
+
+  // unmap both pages before mapping either, as the hashed page table can't
+  // hold a frame twice
+  if (a.proc_id != 0)
+    unmap_for_move(frame_a, a.proc_id, a.page_id);
+  if (b.proc_id != 0)
+    unmap_for_move(frame_b, b.proc_id, b.page_id);
+
+  if (a.proc_id != 0) {
+    link_frame(frame_b, a.proc_id, a.page_id);
+    set_page_frame(a.proc_id, a.page_id, frame_b);
+  }
+  if (b.proc_id != 0) {
+    link_frame(frame_a, b.proc_id, b.page_id);
+    set_page_frame(b.proc_id, b.page_id, frame_a);
   }
 
-  assert(min_page_frames != RAM_MAX_PAGES); // min frames should have changed
-  return min_page_frames;
+  main_memory[frame_a] = b.proc_id != 0;
+  main_memory[frame_b] = a.proc_id != 0;
 }
 
-int get_amount_page_frames(const int proc_id) {
-  int page_frames = 0;
-
-  for (int i = 0; i < PROC_MAX_PAGES; i++) {
-    if (get_valid(proc_id, i))
-      page_frames++;
+void hand_over_frame(const int proc_id, const int proc_page_id,
+                     const int heir_proc, const int heir_page) {
+  const int page_frame = get_page_frame(proc_id, proc_page_id);
+  page_table_entry_t *from = &get_page_table(proc_id)[proc_page_id];
+  page_table_entry_t *to = &get_page_table(heir_proc)[heir_page];
+  assert(page_frame != -1);                 // page should be in memory
+  assert(!get_valid(heir_proc, heir_page)); // and the heir shouldn't
+
+  // the rest of the huge page stays in memory as base pages. the split isn't
+  // counted, as no page was evicted
+  if (in_huge_page(proc_id, proc_page_id))
+    split_huge_page(proc_id, proc_page_id);
+  if (huge_policy != HUGE_OFF)
+    huge_state[proc_id - 1].touched &= ~(1u << proc_page_id);
+
+  unmap_for_move(page_frame, proc_id, proc_page_id);
+  if (from->shared_id != -1)
+    shared_unmap(proc_id, proc_page_id);
+  set_valid(proc_id, proc_page_id, false);
+
+  link_frame(page_frame, heir_proc, heir_page);
+  set_page_frame(heir_proc, heir_page, page_frame);
+  set_valid(heir_proc, heir_page, true);
+  if (to->shared_id != -1)
+    shared_set_owner(heir_proc, heir_page);
+
+  // the flags go along with the frame
+  set_referenced(heir_proc, heir_page, get_referenced(proc_id, proc_page_id));
+  set_modified(heir_proc, heir_page, get_modified(proc_id, proc_page_id));
+  set_referenced(proc_id, proc_page_id, false);
+  set_modified(proc_id, proc_page_id, false);
+  to->cleaned = from->cleaned;
+  to->prefetched = from->prefetched;
+  to->clock_passes = from->clock_passes;
+  from->cleaned = false;
+  from->prefetched = false;
+  from->clock_passes = 0;
+
+  // and so does the algorithm-specific data, without counting an eviction
+  if (algo_uses_aging()) {
+    set_age_bits(heir_proc, heir_page, get_age_bits(proc_id, proc_page_id));
+    set_age_bits(proc_id, proc_page_id, 0);
+  } else if (algorithm == ALGO_WS) {
+    // virtual times are per process, the heir's page starts in its working set
+    set_age_clock(heir_proc, heir_page, proc_vtime[heir_proc - 1]);
+    set_age_clock(proc_id, proc_page_id, 0);
+    to->writeback_pending = from->writeback_pending;
+    from->writeback_pending = false;
+  } else if (algo_uses_queue()) {
+    remove_queued_page(proc_id, proc_page_id);
+    enqueue_page(heir_proc, heir_page);
+  } else if (algo_uses_arc()) {
+    arc_move(proc_id, proc_page_id, heir_proc, heir_page);
+  } else if (algo_uses_lirs()) {
+    lirs_move(proc_id, proc_page_id, heir_proc, heir_page);
+  } else if (algorithm == ALGO_MGLRU) {
+    mglru_move(proc_id, proc_page_id, heir_proc, heir_page);
+  } else if (algo_uses_lfu()) {
+    lfu_move(proc_id, proc_page_id, heir_proc, heir_page);
+  } else if (algorithm == ALGO_DUEL) {
+    duel_move(proc_id, proc_page_id, heir_proc, heir_page);
   }
-
-  return page_frames;
 }
@@ -4,6 +4,21 @@
 #include "util.h"
 #include <stdbool.h>
 
+// returns whether the selected algorithm keeps aging bits, shifted every round
+bool algo_uses_aging(void);
+
+// returns whether the selected algorithm keeps a FIFO page queue per process
+bool algo_uses_queue(void);
+
+// returns whether the selected algorithm keeps ARC/CAR lists per process
+bool algo_uses_arc(void);
+
+// returns whether the selected algorithm keeps LIRS/CLOCK-Pro state per process
+bool algo_uses_lirs(void);
+
+// returns whether the selected algorithm keeps LFU/LRFU state per process
+bool algo_uses_lfu(void);
+
 // returns whether the requested page is in memory, by checking the valid bit
 bool is_in_memory(const vmem_io_request_t req);
 
@@ -62,24 +77,54 @@ void enqueue_page(const int proc_id, const int proc_page_id);
 // dequeue a page from the 2ndC page queue of the specified process
 int dequeue_page(const int proc_id);
 
-// add a page to the working set of the specified process
-void set_add_page(const int proc_id, const int proc_page_id);
-
-// remove a page from the working set of the specified process
-void set_remove_page(const int proc_id, const int proc_page_id);
-
-// returns whether the working set of proc_id contains the specified page
-bool set_contains_page(const int proc_id, const int proc_page_id);
-
 // get the queue for the specified process
 queue_t *get_queue(const int proc_id);
 
-// get the working set for the specified process
-set_t *get_set(const int proc_id);
-
-// get the minimum number of page frames that a process has occupied,
-// called once per execution to check whether Working Set(k) can be run
-int get_min_page_frames(void);
+// returns whether the page was accessed within the last k_param requests of its
+// process, i.e. it's in the process' working set
+bool in_working_set(const int proc_id, const int proc_page_id);
 
 // get the amount of page frames that a process has in memory
 int get_amount_page_frames(const int proc_id);
+
+// get the first page frame in the resident list of the specified process,
+// -1 if it has no pages in memory. follow frame_table[frame].next for the rest
+int get_first_resident_frame(const int proc_id);
+
+// get the page table for the specified process
+page_table_entry_t *get_page_table(const int proc_id);
+
+// remove every page from the 2ndC page queue of the specified process
+void clear_page_queue(const int proc_id);
+
+// remove a page from the middle of the 2ndC page queue of the specified process
+void remove_queued_page(const int proc_id, const int proc_page_id);
+
+// load the requested page into the given page frame, marking it as occupied
+// and updating algorithm-specific data for the newly mapped page. a page
+// mapping a shared page becomes its owner
+void swap_in_page(const int proc_id, const int proc_page_id,
+                  const int page_frame);
+
+// remove the requested page from main memory, clearing its page frame, flag
+// bits and algorithm-specific data, and splitting the huge page holding it.
+// other mappings of a shared page owned by it are unmapped too. the page frame
+// is left occupied, so it can be handed to another page, and is returned
+int swap_out_page(const int proc_id, const int proc_page_id);
+
+// returns whether the requested page is part of a huge page
+bool in_huge_page(const int proc_id, const int proc_page_id);
+
+// demote the huge page holding the requested page back to base pages
+void split_huge_page(const int proc_id, const int proc_page_id);
+
+// swap the pages held by two page frames, either of which may be free, as
+// when migrating pages to compact memory
+void exchange_frames(const int frame_a, const int frame_b);
+
+// hand the frame of a resident page over to a page that isn't in memory,
+// possibly of another process, as when a shared page changes owner. the heir
+// inherits the page's flags and algorithm-specific data, and unlike
+// swap_out_page and swap_in_page, nothing counts as an eviction or a refault
+void hand_over_frame(const int proc_id, const int proc_page_id,
+                     const int heir_proc, const int heir_page);
@@ -0,0 +1,347 @@
+#include "vmem_lfu.h"
+#include "types.h"
+#include "util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// documentation is provided in vmem_lfu.h
+
+extern page_algo_t algorithm;
+
+// LFU/LRFU state of each process
+static lfu_state_t lfu_state[4];
+// LFU aging passes done so far
+static int aging_passes;
+
+// get the LFU/LRFU state of the specified process
+static lfu_state_t *get_lfu_state(const int proc_id) {
+  assert(algorithm == ALGO_LFU || algorithm == ALGO_LRFU);
+
+  if (proc_id < 1 || proc_id > 4) {
+    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
+    exit(10);
+  }
+
+  return &lfu_state[proc_id - 1];
+}
+
+// unlink a page from the list of its access count
+static void freq_remove(lfu_state_t *s, const int page) {
+  const int f = s->freq[page];
+  assert(f > 0);
+
+  if (s->prev[page] != -1)
+    s->next[s->prev[page]] = s->next[page];
+  else
+    s->head[f] = s->next[page];
+
+  if (s->next[page] != -1)
+    s->prev[s->next[page]] = s->prev[page];
+  else
+    s->tail[f] = s->prev[page];
+
+  s->freq[page] = 0;
+  s->prev[page] = -1;
+  s->next[page] = -1;
+}
+
+// push a page to the tail (MRU end) of the list of the given access count
+static void freq_push(lfu_state_t *s, const int f, const int page) {
+  assert(s->freq[page] == 0);
+
+  s->freq[page] = f;
+  s->prev[page] = s->tail[f];
+  s->next[page] = -1;
+
+  if (s->tail[f] != -1)
+    s->next[s->tail[f]] = page;
+  else
+    s->head[f] = page;
+
+  s->tail[f] = page;
+}
+
+// move the lowest count up to the next one holding a page, 0 if none. bounded
+// by LFU_MAX_FREQ, so O(1)
+static void update_min_freq(lfu_state_t *s) {
+  if (s->min_freq == 0)
+    s->min_freq = 1;
+
+  while (s->min_freq <= LFU_MAX_FREQ && s->head[s->min_freq] == -1) {
+    s->min_freq++;
+  }
+
+  if (s->min_freq > LFU_MAX_FREQ)
+    s->min_freq = 0;
+}
+
+// swap two entries of the LRFU heap
+static void heap_swap(lfu_state_t *s, const int i, const int j) {
+  const int a = s->heap[i];
+  const int b = s->heap[j];
+
+  s->heap[i] = b;
+  s->heap[j] = a;
+  s->heap_pos[b] = i;
+  s->heap_pos[a] = j;
+}
+
+// restore the heap order around the entry at index i, after its key changed
+static void heap_fix(lfu_state_t *s, int i) {
+  while (i > 0 && s->key[s->heap[i]] < s->key[s->heap[(i - 1) / 2]]) {
+    heap_swap(s, i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+
+  while (true) {
+    const int left = 2 * i + 1;
+    const int right = left + 1;
+    int lowest = i;
+
+    if (left < s->heap_size && s->key[s->heap[left]] < s->key[s->heap[lowest]])
+      lowest = left;
+    if (right < s->heap_size &&
+        s->key[s->heap[right]] < s->key[s->heap[lowest]])
+      lowest = right;
+
+    if (lowest == i)
+      break;
+
+    heap_swap(s, i, lowest);
+    i = lowest;
+  }
+}
+
+// CRF of a page decayed to the current time
+static inline double lrfu_current_crf(const lfu_state_t *s, const int page) {
+  return s->crf[page] *
+         pow(2, -LRFU_LAMBDA * (s->vtime - s->last_access[page]));
+}
+
+// decay the page's CRF to the current time and add the access being made
+static void lrfu_access(lfu_state_t *s, const int page) {
+  s->crf[page] = 1 + lrfu_current_crf(s, page);
+  s->last_access[page] = s->vtime;
+  s->key[page] = log2(s->crf[page]) + LRFU_LAMBDA * s->vtime;
+}
+
+void lfu_init(void) {
+  for (int proc_id = 1; proc_id <= 4; proc_id++) {
+    lfu_state[proc_id - 1] = (lfu_state_t){0};
+    lfu_clear(proc_id);
+  }
+
+  aging_passes = 0;
+}
+
+void lfu_hit(const int proc_id, const int proc_page_id) {
+  lfu_state_t *s = get_lfu_state(proc_id);
+  s->vtime++;
+
+  if (algorithm == ALGO_LFU) {
+    const int f = s->freq[proc_page_id];
+    assert(f > 0);
+
+    freq_remove(s, proc_page_id);
+    freq_push(s, f < LFU_MAX_FREQ ? f + 1 : f, proc_page_id);
+    if (f == s->min_freq)
+      update_min_freq(s);
+  } else {
+    assert(s->heap_pos[proc_page_id] != -1);
+    lrfu_access(s, proc_page_id);
+    heap_fix(s, s->heap_pos[proc_page_id]);
+  }
+}
+
+int lfu_select_victim(const int proc_id) {
+  lfu_state_t *s = get_lfu_state(proc_id);
+
+  if (algorithm == ALGO_LFU) {
+    // the least recently used page among the least frequently used ones
+    assert(s->min_freq > 0); // there should be a page in memory
+    return s->head[s->min_freq];
+  }
+
+  assert(s->heap_size > 0); // there should be a page in memory
+  return s->heap[0];
+}
+
+void lfu_insert(const int proc_id, const int proc_page_id) {
+  lfu_state_t *s = get_lfu_state(proc_id);
+  s->vtime++;
+
+  if (algorithm == ALGO_LFU) {
+    freq_push(s, 1, proc_page_id);
+    s->min_freq = 1;
+  } else {
+    assert(s->heap_pos[proc_page_id] == -1);
+    lrfu_access(s, proc_page_id);
+    s->heap[s->heap_size] = proc_page_id;
+    s->heap_pos[proc_page_id] = s->heap_size++;
+    heap_fix(s, s->heap_pos[proc_page_id]);
+  }
+}
+
+void lfu_evict(const int proc_id, const int proc_page_id) {
+  lfu_state_t *s = get_lfu_state(proc_id);
+  s->evictions++;
+
+  if (algorithm == ALGO_LFU) {
+    const int f = s->freq[proc_page_id];
+    s->victim_value_sum += f;
+
+    freq_remove(s, proc_page_id);
+    if (f == s->min_freq)
+      update_min_freq(s);
+  } else {
+    const int i = s->heap_pos[proc_page_id];
+    assert(i != -1);
+    s->victim_value_sum += lrfu_current_crf(s, proc_page_id);
+
+    // move the last entry into the freed slot
+    heap_swap(s, i, --s->heap_size);
+    s->heap_pos[proc_page_id] = -1;
+    if (i < s->heap_size)
+      heap_fix(s, i);
+  }
+}
+
+void lfu_move(const int proc_id, const int proc_page_id, const int heir_proc,
+              const int heir_page) {
+  lfu_state_t *s = get_lfu_state(proc_id);
+  lfu_state_t *heir = get_lfu_state(heir_proc);
+
+  if (algorithm == ALGO_LFU) {
+    const int f = s->freq[proc_page_id];
+    freq_remove(s, proc_page_id);
+    if (f == s->min_freq)
+      update_min_freq(s);
+
+    freq_push(heir, f, heir_page);
+    if (heir->min_freq == 0 || f < heir->min_freq)
+      heir->min_freq = f;
+    return;
+  }
+
+  const int i = s->heap_pos[proc_page_id];
+  assert(i != -1 && heir->heap_pos[heir_page] == -1);
+  // the CRF is carried over decayed to now, the heir's clock being its own
+  heir->crf[heir_page] = lrfu_current_crf(s, proc_page_id);
+  heir->last_access[heir_page] = heir->vtime;
+  heir->key[heir_page] =
+      log2(heir->crf[heir_page]) + LRFU_LAMBDA * heir->vtime;
+
+  heap_swap(s, i, --s->heap_size);
+  s->heap_pos[proc_page_id] = -1;
+  if (i < s->heap_size)
+    heap_fix(s, i);
+
+  heir->heap[heir->heap_size] = heir_page;
+  heir->heap_pos[heir_page] = heir->heap_size++;
+  heap_fix(heir, heir->heap_pos[heir_page]);
+}
+
+void lfu_clear(const int proc_id) {
+  lfu_state_t *s = get_lfu_state(proc_id);
+
+  for (int i = 0; i < PROC_MAX_PAGES; i++) {
+    s->freq[i] = 0;
+    s->prev[i] = -1;
+    s->next[i] = -1;
+    s->crf[i] = 0;
+    s->key[i] = 0;
+    s->last_access[i] = 0;
+    s->heap_pos[i] = -1;
+  }
+  for (int f = 0; f <= LFU_MAX_FREQ; f++) {
+    s->head[f] = -1;
+    s->tail[f] = -1;
+  }
+
+  s->min_freq = 0;
+  s->heap_size = 0;
+  s->vtime = 0;
+}
+
+void lfu_age(void) {
+  assert(algorithm == ALGO_LFU);
+
+  for (int p = 0; p < 4; p++) {
+    lfu_state_t *s = &lfu_state[p];
+
+    // lists are visited from the lowest count up, and pages only move to lower
+    // counts, so every page is moved once. pages merged into the same count
+    // stay ordered by their old count, then by recency
+    for (int f = 2; f <= LFU_MAX_FREQ; f++) {
+      int page = s->head[f];
+      s->head[f] = -1;
+      s->tail[f] = -1;
+
+      while (page != -1) {
+        const int next = s->next[page];
+
+        s->freq[page] = 0;
+        freq_push(s, f / 2, page);
+        page = next;
+      }
+    }
+
+    s->min_freq = 0;
+    update_min_freq(s);
+  }
+
+  aging_passes++;
+}
+
+int lfu_eviction_rank(const int proc_id, const int proc_page_id) {
+  const lfu_state_t *s = get_lfu_state(proc_id);
+  int rank = 0;
+
+  if (algorithm == ALGO_LFU) {
+    if (s->freq[proc_page_id] != s->min_freq)
+      return -1;
+
+    // position from the LRU end of the lowest count
+    for (int i = s->head[s->min_freq]; i != proc_page_id; i = s->next[i]) {
+      rank++;
+    }
+
+    return rank;
+  }
+
+  // a fresh access has a CRF of 1, so a lower one is already cold
+  if (lrfu_current_crf(s, proc_page_id) >= 1)
+    return -1;
+
+  for (int i = 0; i < s->heap_size; i++) {
+    if (s->key[s->heap[i]] < s->key[proc_page_id])
+      rank++;
+  }
+
+  return rank;
+}
+
+void lfu_print_stats(void) {
+  putchar('\n');
+  msg("--- %s Stats ---", algorithm == ALGO_LFU ? "LFU" : "LRFU");
+  if (algorithm == ALGO_LFU)
+    msg("Aging Passes:      %11d", aging_passes);
+  else
+    msg("Lambda:            %11.2f", LRFU_LAMBDA);
+
+  for (int p = 0; p < 4; p++) {
+    const lfu_state_t *s = &lfu_state[p];
+
+    const double avg_victim =
+        s->evictions > 0 ? s->victim_value_sum / s->evictions : 0.0;
+
+    msg("P%d Evictions:      %11d", p + 1, s->evictions);
+    if (algorithm == ALGO_LFU)
+      msg("P%d Avg Victim Freq: %10.2f", p + 1, avg_victim);
+    else
+      msg("P%d Avg Victim CRF:  %10.2f", p + 1, avg_victim);
+  }
+}
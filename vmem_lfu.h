@@ -0,0 +1,41 @@
+#pragma once
+
+#include "types.h"
+#include <stdbool.h>
+
+// reset the LFU or LRFU state of every process
+void lfu_init(void);
+
+// count an access to a resident page
+void lfu_hit(const int proc_id, const int proc_page_id);
+
+// get the page to swap out according to LFU or LRFU
+int lfu_select_victim(const int proc_id);
+
+// track a page being loaded into memory, counting the access that faulted it in
+void lfu_insert(const int proc_id, const int proc_page_id);
+
+// stop tracking a page being swapped out of memory. LRFU keeps its CRF, so a
+// page faulted back in resumes with its decayed value
+void lfu_evict(const int proc_id, const int proc_page_id);
+
+// hand a resident page's access count (LFU) or CRF (LRFU) over to another page,
+// which may be of another process, taking over its frame. it isn't counted as
+// an eviction
+void lfu_move(const int proc_id, const int proc_page_id, const int heir_proc,
+              const int heir_page);
+
+// drop every entry of the specified process, along with its LRFU history
+void lfu_clear(const int proc_id);
+
+// halve the access counts of every resident page, called every
+// LFU_AGING_INTERVAL rounds (LFU only)
+void lfu_age(void);
+
+// rank a resident page by how soon it's likely to be evicted, lower meaning
+// sooner, or -1 if the page isn't at the lowest access count (LFU) or its CRF
+// is at least that of a page accessed just now (LRFU)
+int lfu_eviction_rank(const int proc_id, const int proc_page_id);
+
+// print the stats of every process
+void lfu_print_stats(void);
@@ -0,0 +1,665 @@
+#include "vmem_lirs.h"
+#include "types.h"
+#include "util.h"
+#include "vmem_helpers.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// documentation is provided in vmem_lirs.h
+
+extern page_algo_t algorithm;
+
+// LIRS state of each process
+static lirs_state_t lirs_state[4];
+// CLOCK-Pro state of each process
+static clockpro_state_t clockpro_state[4];
+
+// get the LIRS state of the specified process
+static lirs_state_t *get_lirs_state(const int proc_id) {
+  assert(algorithm == ALGO_LIRS);
+
+  if (proc_id < 1 || proc_id > 4) {
+    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
+    exit(10);
+  }
+
+  return &lirs_state[proc_id - 1];
+}
+
+// get the CLOCK-Pro state of the specified process
+static clockpro_state_t *get_clockpro_state(const int proc_id) {
+  assert(algorithm == ALGO_CLOCKPRO);
+
+  if (proc_id < 1 || proc_id > 4) {
+    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
+    exit(10);
+  }
+
+  return &clockpro_state[proc_id - 1];
+}
+
+// amount of page frames of a process set aside for HIR/cold pages
+static inline int get_hir_target(const int proc_id) {
+  const int target = get_amount_page_frames(proc_id) * LIRS_HIR_PCT / 100;
+  return target > 1 ? target : 1;
+}
+
+// amount of page frames of a process left for LIR pages
+static inline int get_lir_target(const int proc_id) {
+  return get_amount_page_frames(proc_id) - get_hir_target(proc_id);
+}
+
+// unlink a page from the LIRS stack
+static void stack_remove(lirs_state_t *s, const int page) {
+  assert(s->in_stack[page]);
+
+  if (s->stack_prev[page] != -1)
+    s->stack_next[s->stack_prev[page]] = s->stack_next[page];
+  else
+    s->stack_bottom = s->stack_next[page];
+
+  if (s->stack_next[page] != -1)
+    s->stack_prev[s->stack_next[page]] = s->stack_prev[page];
+  else
+    s->stack_top = s->stack_prev[page];
+
+  s->in_stack[page] = false;
+  s->stack_prev[page] = -1;
+  s->stack_next[page] = -1;
+}
+
+// move a page to the top of the stack, pushing it if it isn't there
+static void stack_push(lirs_state_t *s, const int page) {
+  if (s->in_stack[page])
+    stack_remove(s, page);
+
+  s->in_stack[page] = true;
+  s->stack_prev[page] = s->stack_top;
+  s->stack_next[page] = -1;
+
+  if (s->stack_top != -1)
+    s->stack_next[s->stack_top] = page;
+  else
+    s->stack_bottom = page;
+
+  s->stack_top = page;
+}
+
+// unlink a page from Q. a page is in Q if and only if it's a resident HIR page
+static void queue_remove(lirs_state_t *s, const int page) {
+  if (s->queue_prev[page] != -1)
+    s->queue_next[s->queue_prev[page]] = s->queue_next[page];
+  else
+    s->queue_front = s->queue_next[page];
+
+  if (s->queue_next[page] != -1)
+    s->queue_prev[s->queue_next[page]] = s->queue_prev[page];
+  else
+    s->queue_end = s->queue_prev[page];
+
+  s->queue_prev[page] = -1;
+  s->queue_next[page] = -1;
+  s->hir_count--;
+}
+
+// push a page to the end of Q, as a resident HIR page
+static void queue_push(lirs_state_t *s, const int page) {
+  s->queue_prev[page] = s->queue_end;
+  s->queue_next[page] = -1;
+
+  if (s->queue_end != -1)
+    s->queue_next[s->queue_end] = page;
+  else
+    s->queue_front = page;
+
+  s->queue_end = page;
+  s->hir_count++;
+}
+
+// remove HIR entries from the stack bottom until a LIR page is at the bottom.
+// non-resident HIR pages leaving the stack are no longer tracked
+static void stack_prune(lirs_state_t *s) {
+  while (s->stack_bottom != -1 && s->status[s->stack_bottom] != LIRS_LIR) {
+    const int page = s->stack_bottom;
+
+    stack_remove(s, page);
+    if (s->status[page] == LIRS_HIR_GHOST)
+      s->status[page] = LIRS_NONE;
+    s->pruned++;
+  }
+}
+
+// turn the LIR page at the stack bottom into a resident HIR page
+static void demote_bottom_lir(lirs_state_t *s) {
+  stack_prune(s);
+  const int page = s->stack_bottom;
+  assert(page != -1 && s->status[page] == LIRS_LIR);
+
+  stack_remove(s, page);
+  s->status[page] = LIRS_HIR;
+  s->lir_count--;
+  queue_push(s, page);
+  s->demotions++;
+
+  stack_prune(s);
+}
+
+// turn a HIR page that was re-accessed while in the stack into a LIR page
+static void promote_to_lir(lirs_state_t *s, const int page) {
+  s->status[page] = LIRS_LIR;
+  s->lir_count++;
+  stack_push(s, page);
+  s->promotions++;
+}
+
+// move a hit page to the top of the stack, updating its status by its new IRR
+static void lirs_hit_LIRS(const int proc_id, const int page) {
+  lirs_state_t *s = get_lirs_state(proc_id);
+
+  if (s->status[page] == LIRS_LIR) {
+    const bool was_bottom = s->stack_bottom == page;
+    stack_push(s, page);
+    if (was_bottom)
+      stack_prune(s);
+  } else if (s->in_stack[page]) {
+    // resident HIR page with a new IRR smaller than the bottom LIR's recency
+    assert(s->status[page] == LIRS_HIR);
+    queue_remove(s, page);
+    promote_to_lir(s, page);
+    if (s->lir_count > get_lir_target(proc_id))
+      demote_bottom_lir(s);
+  } else {
+    // resident HIR page that stays HIR
+    assert(s->status[page] == LIRS_HIR);
+    stack_push(s, page);
+    queue_remove(s, page);
+    queue_push(s, page);
+  }
+}
+
+// get the resident HIR page at the front of Q
+static int lirs_select_victim_LIRS(const int proc_id) {
+  lirs_state_t *s = get_lirs_state(proc_id);
+
+  if (s->queue_front != -1)
+    return s->queue_front;
+
+  // every resident page is LIR, which can happen when the process lost page
+  // frames, evict the LIR page with the largest recency
+  stack_prune(s);
+  assert(s->stack_bottom != -1 && s->status[s->stack_bottom] == LIRS_LIR);
+  return s->stack_bottom;
+}
+
+// track a page loaded into memory in the stack, and in Q if it's HIR
+static void lirs_insert_LIRS(const int proc_id, const int page) {
+  lirs_state_t *s = get_lirs_state(proc_id);
+  const int lir_target = get_lir_target(proc_id);
+
+  if (s->status[page] == LIRS_HIR_GHOST) {
+    // re-accessed while still in the stack, so its IRR is small
+    s->ghost_hits++;
+    promote_to_lir(s, page);
+    if (s->lir_count > lir_target)
+      demote_bottom_lir(s);
+  } else if (s->lir_count < lir_target) {
+    // LIR set is still being filled
+    s->status[page] = LIRS_LIR;
+    s->lir_count++;
+    stack_push(s, page);
+  } else {
+    s->status[page] = LIRS_HIR;
+    stack_push(s, page);
+    queue_push(s, page);
+  }
+}
+
+// update the status of a page leaving memory
+static void lirs_evict_LIRS(const int proc_id, const int page) {
+  lirs_state_t *s = get_lirs_state(proc_id);
+
+  if (s->status[page] == LIRS_HIR) {
+    queue_remove(s, page);
+    // stays in the stack as non-resident, until pruned
+    s->status[page] = s->in_stack[page] ? LIRS_HIR_GHOST : LIRS_NONE;
+  } else {
+    assert(s->status[page] == LIRS_LIR);
+    s->lir_count--;
+    s->status[page] = LIRS_NONE;
+    stack_remove(s, page);
+    stack_prune(s);
+  }
+}
+
+// hand a resident page's status over to another page, dropping a non-resident
+// entry of the heir without counting a ghost hit
+static void lirs_move_LIRS(const int proc_id, const int page,
+                           const int heir_proc, const int heir_page) {
+  lirs_state_t *s = get_lirs_state(proc_id);
+  lirs_state_t *heir = get_lirs_state(heir_proc);
+  const lirs_status_t status = s->status[page];
+
+  if (status == LIRS_HIR) {
+    queue_remove(s, page);
+    if (s->in_stack[page])
+      stack_remove(s, page);
+  } else {
+    assert(status == LIRS_LIR);
+    s->lir_count--;
+    stack_remove(s, page);
+    stack_prune(s);
+  }
+  s->status[page] = LIRS_NONE;
+
+  if (heir->in_stack[heir_page])
+    stack_remove(heir, heir_page);
+  heir->status[heir_page] = status;
+  stack_push(heir, heir_page);
+  if (status == LIRS_HIR) {
+    queue_push(heir, heir_page);
+  } else {
+    heir->lir_count++;
+    if (heir->lir_count > get_lir_target(heir_proc))
+      demote_bottom_lir(heir);
+  }
+}
+
+// drop every LIRS entry of a process
+static void lirs_clear_LIRS(const int proc_id) {
+  lirs_state_t *s = get_lirs_state(proc_id);
+
+  for (int i = 0; i < PROC_MAX_PAGES; i++) {
+    s->status[i] = LIRS_NONE;
+    s->in_stack[i] = false;
+    s->stack_prev[i] = -1;
+    s->stack_next[i] = -1;
+    s->queue_prev[i] = -1;
+    s->queue_next[i] = -1;
+  }
+
+  s->stack_bottom = -1;
+  s->stack_top = -1;
+  s->queue_front = -1;
+  s->queue_end = -1;
+  s->lir_count = 0;
+  s->hir_count = 0;
+}
+
+// unlink a page from the clock, moving hands that point at it to the next page
+static void clock_remove(clockpro_state_t *s, const int page) {
+  assert(s->in_clock[page]);
+  const int next = s->next[page] != page ? s->next[page] : -1;
+
+  if (s->hand_hot == page)
+    s->hand_hot = next;
+  if (s->hand_cold == page)
+    s->hand_cold = next;
+  if (s->hand_test == page)
+    s->hand_test = next;
+
+  if (next != -1) {
+    s->next[s->prev[page]] = s->next[page];
+    s->prev[s->next[page]] = s->prev[page];
+  }
+
+  s->in_clock[page] = false;
+  s->prev[page] = -1;
+  s->next[page] = -1;
+}
+
+// insert a page at the head of the clock, right behind hand_hot, so that it's
+// the last one every hand reaches
+static void clock_insert(clockpro_state_t *s, const int page) {
+  assert(!s->in_clock[page]);
+  s->in_clock[page] = true;
+
+  if (s->hand_hot == -1) {
+    s->prev[page] = page;
+    s->next[page] = page;
+    s->hand_hot = page;
+    s->hand_cold = page;
+    s->hand_test = page;
+    return;
+  }
+
+  const int head = s->hand_hot;
+  s->prev[page] = s->prev[head];
+  s->next[page] = head;
+  s->next[s->prev[head]] = page;
+  s->prev[head] = page;
+}
+
+// end the test period of a non-resident cold page, which leaves the clock. its
+// reuse distance was too large to be worth more cold page frames
+static void end_nonresident_test(clockpro_state_t *s, const int page) {
+  clock_remove(s, page);
+  s->test[page] = false;
+  s->test_count--;
+  s->test_ends++;
+  if (s->cold_target > 1)
+    s->cold_target--;
+}
+
+// run hand_hot until a hot page is demoted to cold. on the way, test periods
+// of cold pages are ended
+static void run_hand_hot(clockpro_state_t *s) {
+  while (s->hot_count > 0) {
+    const int page = s->hand_hot;
+    s->hand_hot = s->next[page];
+
+    if (s->hot[page]) {
+      if (s->ref[page]) {
+        s->ref[page] = false;
+      } else {
+        s->hot[page] = false;
+        s->hot_count--;
+        s->cold_count++;
+        s->demotions++;
+        return;
+      }
+    } else if (!s->resident[page]) {
+      end_nonresident_test(s, page);
+    } else {
+      s->test[page] = false;
+    }
+  }
+}
+
+// run hand_test until a non-resident cold page leaves the clock, keeping the
+// amount of them bounded by the process' page frame count
+static void run_hand_test(clockpro_state_t *s) {
+  while (s->test_count > 0) {
+    const int page = s->hand_test;
+    s->hand_test = s->next[page];
+
+    if (!s->resident[page]) {
+      end_nonresident_test(s, page);
+      return;
+    } else if (!s->hot[page]) {
+      s->test[page] = false;
+    }
+  }
+}
+
+// demote hot pages while there are more than the frames left for them
+static void balance_hot(const int proc_id, clockpro_state_t *s) {
+  const int hot_target = get_amount_page_frames(proc_id) - s->cold_target;
+
+  while (s->hot_count > 0 && s->hot_count > hot_target) {
+    run_hand_hot(s);
+  }
+}
+
+// set the reference bit of a hit page
+static void lirs_hit_CLOCKPRO(const int proc_id, const int page) {
+  clockpro_state_t *s = get_clockpro_state(proc_id);
+  assert(s->in_clock[page] && s->resident[page]);
+
+  s->ref[page] = true;
+}
+
+// run hand_cold until an unreferenced resident cold page is found. referenced
+// cold pages are promoted if they were in their test period
+static int lirs_select_victim_CLOCKPRO(const int proc_id) {
+  clockpro_state_t *s = get_clockpro_state(proc_id);
+
+  while (true) {
+    if (s->cold_count == 0) {
+      // every resident page is hot, demote one for hand_cold to find
+      run_hand_hot(s);
+      continue;
+    }
+
+    const int page = s->hand_cold;
+    s->hand_cold = s->next[page];
+
+    if (!s->resident[page] || s->hot[page])
+      continue; // hand_cold only stops at resident cold pages
+
+    if (!s->ref[page])
+      return page;
+
+    s->ref[page] = false;
+    if (s->test[page]) {
+      // re-accessed during its test period, so its reuse distance is small
+      s->hot[page] = true;
+      s->test[page] = false;
+      s->cold_count--;
+      s->hot_count++;
+      s->promotions++;
+      balance_hot(proc_id, s);
+    } else {
+      // start a new test period, from the head of the clock
+      s->test[page] = true;
+      clock_remove(s, page);
+      clock_insert(s, page);
+    }
+  }
+}
+
+// insert a page loaded into memory at the head of the clock
+static void lirs_insert_CLOCKPRO(const int proc_id, const int page) {
+  clockpro_state_t *s = get_clockpro_state(proc_id);
+  const int frames = get_amount_page_frames(proc_id);
+
+  if (s->in_clock[page]) {
+    // faulted during its test period, cold pages deserve more frames
+    assert(!s->resident[page]);
+    clock_remove(s, page);
+    s->test_count--;
+    s->test_hits++;
+    if (s->cold_target < frames - 1)
+      s->cold_target++;
+
+    s->hot[page] = true;
+    s->hot_count++;
+    s->promotions++;
+  } else if (s->hot_count < frames - s->cold_target) {
+    // hot set is still being filled
+    s->hot[page] = true;
+    s->hot_count++;
+  } else {
+    s->hot[page] = false;
+    s->cold_count++;
+  }
+
+  s->resident[page] = true;
+  s->ref[page] = false;
+  s->test[page] = !s->hot[page];
+  clock_insert(s, page);
+  balance_hot(proc_id, s);
+}
+
+// update the state of a page leaving memory
+static void lirs_evict_CLOCKPRO(const int proc_id, const int page) {
+  clockpro_state_t *s = get_clockpro_state(proc_id);
+  assert(s->in_clock[page] && s->resident[page]);
+
+  s->resident[page] = false;
+  s->ref[page] = false;
+
+  if (s->hot[page]) {
+    s->hot[page] = false;
+    s->hot_count--;
+    clock_remove(s, page);
+    return;
+  }
+
+  s->cold_count--;
+  if (!s->test[page]) {
+    clock_remove(s, page);
+    return;
+  }
+
+  // stays in the clock until its test period ends
+  s->test_count++;
+  while (s->test_count > get_amount_page_frames(proc_id) &&
+         s->test_count > 0) {
+    run_hand_test(s);
+  }
+}
+
+// hand a resident page's hot, reference and test bits over to another page,
+// dropping a non-resident test entry of the heir without counting a test hit
+static void lirs_move_CLOCKPRO(const int proc_id, const int page,
+                               const int heir_proc, const int heir_page) {
+  clockpro_state_t *s = get_clockpro_state(proc_id);
+  clockpro_state_t *heir = get_clockpro_state(heir_proc);
+  assert(s->in_clock[page] && s->resident[page]);
+  const bool hot = s->hot[page];
+
+  if (hot)
+    s->hot_count--;
+  else
+    s->cold_count--;
+  clock_remove(s, page);
+  s->resident[page] = false;
+  s->hot[page] = false;
+
+  if (heir->in_clock[heir_page]) {
+    assert(!heir->resident[heir_page]);
+    clock_remove(heir, heir_page);
+    heir->test_count--;
+  }
+  if (hot)
+    heir->hot_count++;
+  else
+    heir->cold_count++;
+  heir->resident[heir_page] = true;
+  heir->hot[heir_page] = hot;
+  heir->ref[heir_page] = s->ref[page];
+  heir->test[heir_page] = s->test[page];
+  clock_insert(heir, heir_page);
+  balance_hot(heir_proc, heir);
+
+  s->ref[page] = false;
+  s->test[page] = false;
+}
+
+// drop every CLOCK-Pro entry of a process
+static void lirs_clear_CLOCKPRO(const int proc_id) {
+  clockpro_state_t *s = get_clockpro_state(proc_id);
+
+  for (int i = 0; i < PROC_MAX_PAGES; i++) {
+    s->in_clock[i] = false;
+    s->resident[i] = false;
+    s->hot[i] = false;
+    s->ref[i] = false;
+    s->test[i] = false;
+    s->prev[i] = -1;
+    s->next[i] = -1;
+  }
+
+  s->hand_hot = -1;
+  s->hand_cold = -1;
+  s->hand_test = -1;
+  s->hot_count = 0;
+  s->cold_count = 0;
+  s->test_count = 0;
+  s->cold_target = 1;
+}
+
+void lirs_init(void) {
+  for (int proc_id = 1; proc_id <= 4; proc_id++) {
+    if (algorithm == ALGO_LIRS) {
+      lirs_state[proc_id - 1] = (lirs_state_t){0};
+      lirs_clear_LIRS(proc_id);
+    } else {
+      clockpro_state[proc_id - 1] = (clockpro_state_t){0};
+      lirs_clear_CLOCKPRO(proc_id);
+    }
+  }
+}
+
+void lirs_hit(const int proc_id, const int proc_page_id) {
+  if (algorithm == ALGO_LIRS)
+    lirs_hit_LIRS(proc_id, proc_page_id);
+  else
+    lirs_hit_CLOCKPRO(proc_id, proc_page_id);
+}
+
+int lirs_select_victim(const int proc_id) {
+  if (algorithm == ALGO_LIRS)
+    return lirs_select_victim_LIRS(proc_id);
+
+  return lirs_select_victim_CLOCKPRO(proc_id);
+}
+
+void lirs_insert(const int proc_id, const int proc_page_id) {
+  if (algorithm == ALGO_LIRS)
+    lirs_insert_LIRS(proc_id, proc_page_id);
+  else
+    lirs_insert_CLOCKPRO(proc_id, proc_page_id);
+}
+
+void lirs_evict(const int proc_id, const int proc_page_id) {
+  if (algorithm == ALGO_LIRS)
+    lirs_evict_LIRS(proc_id, proc_page_id);
+  else
+    lirs_evict_CLOCKPRO(proc_id, proc_page_id);
+}
+
+void lirs_move(const int proc_id, const int proc_page_id, const int heir_proc,
+               const int heir_page) {
+  if (algorithm == ALGO_LIRS)
+    lirs_move_LIRS(proc_id, proc_page_id, heir_proc, heir_page);
+  else
+    lirs_move_CLOCKPRO(proc_id, proc_page_id, heir_proc, heir_page);
+}
+
+void lirs_clear(const int proc_id) {
+  if (algorithm == ALGO_LIRS)
+    lirs_clear_LIRS(proc_id);
+  else
+    lirs_clear_CLOCKPRO(proc_id);
+}
+
+int lirs_eviction_rank(const int proc_id, const int proc_page_id) {
+  if (algorithm == ALGO_LIRS) {
+    const lirs_state_t *s = get_lirs_state(proc_id);
+
+    if (s->status[proc_page_id] != LIRS_HIR)
+      return -1;
+
+    // position from the front of Q
+    int rank = 0;
+    for (int i = s->queue_front; i != proc_page_id; i = s->queue_next[i]) {
+      rank++;
+    }
+    return rank;
+  }
+
+  const clockpro_state_t *s = get_clockpro_state(proc_id);
+  return s->hot[proc_page_id] || s->ref[proc_page_id] ? -1 : 0;
+}
+
+void lirs_print_stats(void) {
+  putchar('\n');
+
+  if (algorithm == ALGO_LIRS) {
+    msg("--- LIRS Stats ---");
+    for (int p = 0; p < 4; p++) {
+      const lirs_state_t *s = &lirs_state[p];
+
+      msg("P%d LIR/HIR Pages:   %5d/%d", p + 1, s->lir_count, s->hir_count);
+      msg("P%d Promotions:      %11d", p + 1, s->promotions);
+      msg("P%d Demotions:       %11d", p + 1, s->demotions);
+      msg("P%d Ghost Hits:      %11d", p + 1, s->ghost_hits);
+      msg("P%d Pruned Entries:  %11d", p + 1, s->pruned);
+    }
+  } else {
+    msg("--- CLOCK-Pro Stats ---");
+    for (int p = 0; p < 4; p++) {
+      const clockpro_state_t *s = &clockpro_state[p];
+
+      msg("P%d Hot/Cold Pages:  %5d/%d", p + 1, s->hot_count, s->cold_count);
+      msg("P%d Cold Target:     %11d", p + 1, s->cold_target);
+      msg("P%d Promotions:      %11d", p + 1, s->promotions);
+      msg("P%d Demotions:       %11d", p + 1, s->demotions);
+      msg("P%d Test Hits:       %11d", p + 1, s->test_hits);
+      msg("P%d Test Ends:       %11d", p + 1, s->test_ends);
+    }
+  }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "types.h"
+#include <stdbool.h>
+
+// reset the LIRS or CLOCK-Pro state of every process
+void lirs_init(void);
+
+// update the state after a hit to a resident page
+void lirs_hit(const int proc_id, const int proc_page_id);
+
+// get the page to swap out according to LIRS or CLOCK-Pro
+int lirs_select_victim(const int proc_id);
+
+// track a page being loaded into memory, as LIR/hot or HIR/cold depending on
+// whether it was re-accessed while its metadata was still kept
+void lirs_insert(const int proc_id, const int proc_page_id);
+
+// update the state of a page being swapped out of memory, keeping it as
+// non-resident if its next reuse distance is still being measured
+void lirs_evict(const int proc_id, const int proc_page_id);
+
+// hand a resident page's LIRS status or CLOCK-Pro bits over to another page,
+// which may be of another process, taking over its frame. it isn't counted as
+// an eviction, nor the heir as a ghost or test hit
+void lirs_move(const int proc_id, const int proc_page_id, const int heir_proc,
+               const int heir_page);
+
+// drop every entry of the specified process
+void lirs_clear(const int proc_id);
+
+// rank a resident page by how soon it's likely to be evicted, lower meaning
+// sooner, or -1 if the page is LIR/hot or was referenced
+int lirs_eviction_rank(const int proc_id, const int proc_page_id);
+
+// print the stats of every process
+void lirs_print_stats(void);
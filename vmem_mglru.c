@@ -0,0 +1,303 @@
+#include "vmem_mglru.h"
+#include "types.h"
+#include "util.h"
+#include "vmem_helpers.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// documentation is provided in vmem_mglru.h
+
+extern page_algo_t algorithm;
+extern int current_round;
+extern frame_entry_t frame_table[RAM_MAX_PAGES];
+
+// MGLRU state of each process
+static mglru_state_t mglru_state[4];
+// aging passes done so far
+static int aging_passes;
+// generation sizes of each process from oldest to youngest, sampled every
+// history_interval aging passes
+static int history_sizes[MGLRU_HISTORY][4][MGLRU_GENS];
+static int history_round[MGLRU_HISTORY];
+static int history_len;
+static int history_interval;
+static int passes_since_sample;
+
+// get the MGLRU state of the specified process
+static mglru_state_t *get_mglru_state(const int proc_id) {
+  assert(algorithm == ALGO_MGLRU);
+
+  if (proc_id < 1 || proc_id > 4) {
+    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
+    exit(10);
+  }
+
+  return &mglru_state[proc_id - 1];
+}
+
+// unlink a page from its generation
+static void gen_remove(mglru_state_t *s, const int page) {
+  assert(s->seq[page] != -1);
+  const int slot = s->seq[page] % MGLRU_GENS;
+
+  if (s->prev[page] != -1)
+    s->next[s->prev[page]] = s->next[page];
+  else
+    s->head[slot] = s->next[page];
+
+  if (s->next[page] != -1)
+    s->prev[s->next[page]] = s->prev[page];
+  else
+    s->tail[slot] = s->prev[page];
+
+  s->seq[page] = -1;
+  s->prev[page] = -1;
+  s->next[page] = -1;
+  s->size[slot]--;
+}
+
+// push a page to the tail of a generation, unlinking it first if needed
+static void gen_push(mglru_state_t *s, const int seq, const int page) {
+  const int slot = seq % MGLRU_GENS;
+
+  if (s->seq[page] != -1)
+    gen_remove(s, page);
+
+  s->seq[page] = seq;
+  s->prev[page] = s->tail[slot];
+  s->next[page] = -1;
+
+  if (s->tail[slot] != -1)
+    s->next[s->tail[slot]] = page;
+  else
+    s->head[slot] = page;
+
+  s->tail[slot] = page;
+  s->size[slot]++;
+}
+
+// retire empty generations from the old end
+static void drop_empty_gens(mglru_state_t *s) {
+  while (s->min_seq < s->max_seq && s->size[s->min_seq % MGLRU_GENS] == 0) {
+    s->min_seq++;
+  }
+}
+
+// store the current generation sizes of every process in the history
+static void sample_gen_sizes(void) {
+  passes_since_sample++;
+  if (passes_since_sample < history_interval)
+    return;
+  passes_since_sample = 0;
+
+  if (history_len == MGLRU_HISTORY) {
+    // history is full, keep every other sample, as for ARC's p
+    for (int i = 0; i < MGLRU_HISTORY / 2; i++) {
+      history_round[i] = history_round[i * 2];
+      memcpy(history_sizes[i], history_sizes[i * 2], sizeof(history_sizes[i]));
+    }
+    history_len = MGLRU_HISTORY / 2;
+    history_interval *= 2;
+  }
+
+  for (int p = 0; p < 4; p++) {
+    const mglru_state_t *s = &mglru_state[p];
+
+    for (int g = 0; g < MGLRU_GENS; g++) {
+      const int seq = s->min_seq + g;
+      history_sizes[history_len][p][g] =
+          seq <= s->max_seq ? s->size[seq % MGLRU_GENS] : 0;
+    }
+  }
+  history_round[history_len++] = current_round;
+}
+
+void mglru_init(void) {
+  for (int proc_id = 1; proc_id <= 4; proc_id++) {
+    mglru_state[proc_id - 1] = (mglru_state_t){0};
+    mglru_clear(proc_id);
+  }
+
+  aging_passes = 0;
+  history_len = 0;
+  history_interval = 1;
+  passes_since_sample = 0;
+}
+
+// move the referenced pages of a process to its youngest generation, opening a
+// new one first if there's room
+static void age_process(const int proc_id) {
+  mglru_state_t *s = get_mglru_state(proc_id);
+
+  if (s->max_seq - s->min_seq + 1 < MGLRU_GENS)
+    s->max_seq++;
+
+  for (int f = get_first_resident_frame(proc_id); f != -1;) {
+    const int page = frame_table[f].page_id;
+    f = frame_table[f].next;
+
+    if (get_referenced(proc_id, page) && s->seq[page] != s->max_seq) {
+      gen_push(s, s->max_seq, page);
+      s->promotions++;
+    }
+  }
+
+  drop_empty_gens(s);
+}
+
+void mglru_age(void) {
+  assert(algorithm == ALGO_MGLRU);
+
+  for (int proc_id = 1; proc_id <= 4; proc_id++) {
+    age_process(proc_id);
+  }
+
+  aging_passes++;
+  sample_gen_sizes();
+}
+
+int mglru_select_victim(const int proc_id) {
+  mglru_state_t *s = get_mglru_state(proc_id);
+
+  while (true) {
+    drop_empty_gens(s);
+
+    if (s->min_seq == s->max_seq) {
+      // a single generation left, age it so that referenced pages can move
+      // out of the way
+      s->max_seq++;
+    }
+
+    const int oldest = s->min_seq % MGLRU_GENS;
+    int victim = -1;
+
+    for (int page = s->head[oldest]; page != -1;) {
+      const int next = s->next[page];
+
+      if (get_referenced(proc_id, page)) {
+        // accessed since the last aging pass, no longer old
+        set_referenced(proc_id, page, false);
+        gen_push(s, s->max_seq, page);
+        s->promotions++;
+      } else if (victim == -1 || s->tier[page] < s->tier[victim]) {
+        victim = page;
+      }
+
+      page = next;
+    }
+
+    if (victim != -1)
+      return victim;
+  }
+}
+
+void mglru_insert(const int proc_id, const int proc_page_id) {
+  mglru_state_t *s = get_mglru_state(proc_id);
+
+  if (s->evicted_seq[proc_page_id] != -1 &&
+      s->max_seq - s->evicted_seq[proc_page_id] < MGLRU_GENS) {
+    // evicted while its generation was still young enough to be tracked
+    s->refaults++;
+    if (s->tier[proc_page_id] < MGLRU_TIERS - 1)
+      s->tier[proc_page_id]++;
+  }
+
+  gen_push(s, s->max_seq, proc_page_id);
+}
+
+void mglru_evict(const int proc_id, const int proc_page_id) {
+  mglru_state_t *s = get_mglru_state(proc_id);
+
+  gen_remove(s, proc_page_id);
+  s->evicted_seq[proc_page_id] = s->max_seq;
+  s->tier_evictions[s->tier[proc_page_id]]++;
+}
+
+void mglru_move(const int proc_id, const int proc_page_id,
+                const int heir_proc, const int heir_page) {
+  mglru_state_t *s = get_mglru_state(proc_id);
+  mglru_state_t *heir = get_mglru_state(heir_proc);
+  // the page keeps its age, counted from the youngest generation
+  const int age = s->max_seq - s->seq[proc_page_id];
+  const int seq = heir->max_seq - age > heir->min_seq ? heir->max_seq - age
+                                                      : heir->min_seq;
+
+  gen_remove(s, proc_page_id);
+  drop_empty_gens(s);
+  gen_push(heir, seq, heir_page);
+  heir->tier[heir_page] = s->tier[proc_page_id];
+}
+
+void mglru_clear(const int proc_id) {
+  mglru_state_t *s = get_mglru_state(proc_id);
+
+  for (int i = 0; i < PROC_MAX_PAGES; i++) {
+    s->seq[i] = -1;
+    s->prev[i] = -1;
+    s->next[i] = -1;
+    s->tier[i] = 0;
+    s->evicted_seq[i] = -1;
+  }
+  for (int g = 0; g < MGLRU_GENS; g++) {
+    s->head[g] = -1;
+    s->tail[g] = -1;
+    s->size[g] = 0;
+  }
+
+  s->min_seq = 0;
+  s->max_seq = 0;
+}
+
+int mglru_eviction_rank(const int proc_id, const int proc_page_id) {
+  const mglru_state_t *s = get_mglru_state(proc_id);
+
+  if (s->seq[proc_page_id] != s->min_seq ||
+      get_referenced(proc_id, proc_page_id))
+    return -1;
+
+  return s->tier[proc_page_id];
+}
+
+void mglru_print_stats(void) {
+  char buffer[256];
+
+  putchar('\n');
+  msg("--- MGLRU Stats ---");
+  msg("Aging Passes:      %11d", aging_passes);
+
+  for (int p = 0; p < 4; p++) {
+    const mglru_state_t *s = &mglru_state[p];
+    int len = 0;
+
+    for (int t = 0; t < MGLRU_TIERS; t++) {
+      len += snprintf(buffer + len, sizeof(buffer) - len, "%s%d",
+                      t > 0 ? "/" : "", s->tier_evictions[t]);
+    }
+
+    msg("P%d Generations:    %11d", p + 1, s->max_seq - s->min_seq + 1);
+    msg("P%d Promotions:     %11d", p + 1, s->promotions);
+    msg("P%d Refaults:       %11d", p + 1, s->refaults);
+    msg("P%d Tier Evictions: %11s", p + 1, buffer);
+  }
+
+  // generation sizes over time, from the oldest to the youngest generation
+  putchar('\n');
+  msg("--- MGLRU Generation Sizes (oldest/.../youngest) ---");
+  for (int i = 0; i < history_len; i++) {
+    int len = 0;
+
+    for (int p = 0; p < 4; p++) {
+      len += snprintf(buffer + len, sizeof(buffer) - len, "%sP%d ",
+                      p > 0 ? " | " : "", p + 1);
+      for (int g = 0; g < MGLRU_GENS; g++) {
+        len += snprintf(buffer + len, sizeof(buffer) - len, "%s%d",
+                        g > 0 ? "/" : "", history_sizes[i][p][g]);
+      }
+    }
+
+    msg("Round %5d: %s", history_round[i], buffer);
+  }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "types.h"
+#include <stdbool.h>
+
+// reset the generations of every process
+void mglru_init(void);
+
+// aging pass, moving every page referenced since the last pass to the youngest
+// generation of its process, creating a new one if there's room. must run
+// right before the reference bits are cleared
+void mglru_age(void);
+
+// get the page to swap out from the oldest generation of the process, the
+// unreferenced page in the lowest tier. referenced pages found on the way are
+// moved to the youngest generation
+int mglru_select_victim(const int proc_id);
+
+// add a page being loaded into memory to the youngest generation, moving it up
+// a tier if it's a refault
+void mglru_insert(const int proc_id, const int proc_page_id);
+
+// remove a page being swapped out of memory from its generation
+void mglru_evict(const int proc_id, const int proc_page_id);
+
+// hand a resident page's generation and tier over to another page, which may
+// be of another process, taking over its frame. it isn't counted as an
+// eviction, nor the heir as a refault
+void mglru_move(const int proc_id, const int proc_page_id,
+                const int heir_proc, const int heir_page);
+
+// drop every generation of the specified process, along with its refault data
+void mglru_clear(const int proc_id);
+
+// rank a resident page by how soon it's likely to be evicted, lower meaning
+// sooner, or -1 if the page isn't in the oldest generation or was referenced
+int mglru_eviction_rank(const int proc_id, const int proc_page_id);
+
+// print the generation and tier stats of every process
+void mglru_print_stats(void);
@@ -0,0 +1,241 @@
+#include "vmem_numa.h"
+#include "types.h"
+#include "util.h"
+#include "vmem_helpers.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// documentation is provided in vmem_numa.h
+
+extern numa_policy_t numa_policy;
+extern bool main_memory[RAM_MAX_PAGES];
+extern frame_entry_t frame_table[RAM_MAX_PAGES];
+
+// cost of an access from a node to a page frame on each node
+static const int distances[NUMA_NODES][NUMA_NODES] = NUMA_DISTANCES;
+// node the next interleaved page goes to
+static int interleave_next;
+// accesses to every page of every process from a remote node since the last
+// scan, indexed by process and page
+static int remote_hits[4][PROC_MAX_PAGES];
+// NUMA stats of each process
+static long local_accesses[4];
+static long remote_accesses[4];
+static long access_time[4]; // cost of every access, summed
+static int migrations[4];   // pages moved to another node
+static int failed[4];       // hot pages left remote, with no frame to take
+static int exchanges;       // migrations that swapped two pages' frames
+
+// get the home node of a process, exiting on an invalid process ID
+static inline int get_home(const int proc_id) {
+  if (proc_id < 1 || proc_id > 4) {
+    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
+    exit(10);
+  }
+
+  return (proc_id - 1) % NUMA_NODES;
+}
+
+// get the first free page frame on a node, -1 if there's none
+static int find_free_frame(const int node) {
+  for (int f = node * NUMA_NODE_FRAMES; f < (node + 1) * NUMA_NODE_FRAMES;
+       f++) {
+    if (!main_memory[f])
+      return f;
+  }
+
+  return -1;
+}
+
+// get a free page frame on a node, or on the nearest node with one, -1 if
+// there's none
+static int find_nearest_free_frame(const int node) {
+  int frame = -1, best = -1;
+
+  for (int n = 0; n < NUMA_NODES; n++) {
+    const int f = find_free_frame(n);
+    if (f != -1 && (best == -1 || distances[node][n] < best)) {
+      frame = f;
+      best = distances[node][n];
+    }
+  }
+
+  return frame;
+}
+
+// find a page frame on a node to migrate a hot page of a process into: a free
+// one, or else one holding a base page homed on the node the hot page is on,
+// which the two pages can trade. -1 if there's none
+static int find_target_frame(const int node, const int from) {
+  int target = find_free_frame(node);
+
+  for (int f = node * NUMA_NODE_FRAMES;
+       f < (node + 1) * NUMA_NODE_FRAMES && target == -1; f++) {
+    const frame_entry_t *fe = &frame_table[f];
+
+    if (fe->proc_id != 0 && get_home(fe->proc_id) == from &&
+        !in_huge_page(fe->proc_id, fe->page_id))
+      target = f;
+  }
+
+  return target;
+}
+
+void numa_init(void) {
+  assert(RAM_MAX_PAGES % NUMA_NODES == 0);
+  assert(NUMA_PREFERRED_NODE >= 0 && NUMA_PREFERRED_NODE < NUMA_NODES);
+
+  interleave_next = 0;
+  for (int p = 0; p < 4; p++) {
+    for (int i = 0; i < PROC_MAX_PAGES; i++) {
+      remote_hits[p][i] = 0;
+    }
+
+    local_accesses[p] = 0;
+    remote_accesses[p] = 0;
+    access_time[p] = 0;
+    migrations[p] = 0;
+    failed[p] = 0;
+  }
+  exchanges = 0;
+}
+
+int numa_get_node(const int page_frame) {
+  assert(page_frame >= 0 && page_frame < RAM_MAX_PAGES);
+  return page_frame / NUMA_NODE_FRAMES;
+}
+
+int numa_alloc_frame(const int proc_id) {
+  int node;
+
+  switch (numa_policy) {
+  case NUMA_FIRST_TOUCH:
+    node = get_home(proc_id);
+    break;
+  case NUMA_INTERLEAVE:
+    node = interleave_next;
+    interleave_next = (interleave_next + 1) % NUMA_NODES;
+    break;
+  case NUMA_PREFERRED:
+    node = NUMA_PREFERRED_NODE;
+    break;
+  default:
+    assert(false);
+    return -1;
+  }
+
+  const int page_frame = find_nearest_free_frame(node);
+  // this should never be called when there are no free page frames
+  assert(page_frame != -1);
+
+  return page_frame;
+}
+
+void numa_access(const int proc_id, const int owner_proc,
+                 const int owner_page) {
+  const int home = get_home(proc_id);
+  const int node = numa_get_node(get_page_frame(owner_proc, owner_page));
+
+  access_time[proc_id - 1] += distances[home][node];
+  if (node == home) {
+    local_accesses[proc_id - 1]++;
+    return;
+  }
+
+  remote_accesses[proc_id - 1]++;
+  // only a process' own accesses make its pages hot, as a shared page's frame
+  // can only be close to one of the nodes mapping it
+  if (proc_id == owner_proc)
+    remote_hits[proc_id - 1][owner_page]++;
+}
+
+void numa_scan(void) {
+  for (int proc_id = 1; proc_id <= 4; proc_id++) {
+    const int home = get_home(proc_id);
+
+    for (int page = 0; page < PROC_MAX_PAGES; page++) {
+      const int hits = remote_hits[proc_id - 1][page];
+      remote_hits[proc_id - 1][page] = 0;
+
+      // huge pages stay on their contiguous frames
+      if (hits < NUMA_HOT_ACCESSES || !get_valid(proc_id, page) ||
+          in_huge_page(proc_id, page))
+        continue;
+
+      // the page may have been brought home since, by an exchange or by being
+      // faulted back in
+      const int page_frame = get_page_frame(proc_id, page);
+      const int from = numa_get_node(page_frame);
+      if (from == home)
+        continue;
+
+      const int target = find_target_frame(home, from);
+      if (target == -1) {
+        failed[proc_id - 1]++;
+        continue;
+      }
+
+      const int other_proc = frame_table[target].proc_id;
+      exchange_frames(page_frame, target);
+      migrations[proc_id - 1]++;
+      if (other_proc != 0) {
+        migrations[other_proc - 1]++;
+        exchanges++;
+      }
+
+      dmsg("NUMA: P%d page %02d migrated from frame %02d (node %d) to frame "
+           "%02d (node %d)",
+           proc_id, page, page_frame, from, target, home);
+    }
+  }
+}
+
+void numa_print_stats(void) {
+  static const char *policies[] = {"off", "first-touch", "interleave",
+                                   "preferred"};
+  long total_local = 0, total_remote = 0, total_time = 0;
+  int total_migrations = 0, total_failed = 0, remote_pages = 0;
+
+  putchar('\n');
+  msg("--- NUMA Stats ---");
+  msg("Placement Policy:  %11s", policies[numa_policy]);
+  msg("Nodes x Frames:    %5d x %d", NUMA_NODES, NUMA_NODE_FRAMES);
+
+  for (int p = 0; p < 4; p++) {
+    const long accesses = local_accesses[p] + remote_accesses[p];
+    total_local += local_accesses[p];
+    total_remote += remote_accesses[p];
+    total_time += access_time[p];
+    total_migrations += migrations[p];
+    total_failed += failed[p];
+
+    msg("P%d Remote Ratio:   %10.2f%%", p + 1,
+        accesses > 0 ? (remote_accesses[p] / (double)accesses) * 100 : 0.0);
+  }
+
+  // pages in memory away from their process' home node at the end of the run
+  for (int f = 0; f < RAM_MAX_PAGES; f++) {
+    if (frame_table[f].proc_id != 0 &&
+        get_home(frame_table[f].proc_id) != numa_get_node(f))
+      remote_pages++;
+  }
+
+  // every access costs its distance, and every migration NUMA_MIGRATE_TIME
+  const long accesses = total_local + total_remote;
+  const long stall_time =
+      total_time + (long)total_migrations * NUMA_MIGRATE_TIME;
+
+  msg("Local Accesses:    %11ld", total_local);
+  msg("Remote Accesses:   %11ld", total_remote);
+  msg("Remote Ratio:      %10.2f%%",
+      accesses > 0 ? (total_remote / (double)accesses) * 100 : 0.0);
+  msg("Migrated Pages:    %11d", total_migrations);
+  msg("Page Exchanges:    %11d", exchanges);
+  msg("Failed Migrations: %11d", total_failed);
+  msg("Final Remote Pages: %10d", remote_pages);
+  msg("Memory Stall Time: %11ld", stall_time);
+  msg("Avg Access Cost:   %11.2f",
+      accesses > 0 ? total_time / (double)accesses : 0.0);
+}
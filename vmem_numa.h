@@ -0,0 +1,27 @@
+#pragma once
+
+#include "types.h"
+#include <stdbool.h>
+
+// reset the interleave cursor and the NUMA stats
+void numa_init(void);
+
+// get the node holding a page frame
+int numa_get_node(const int page_frame);
+
+// get a free page frame for a page of a process, according to numa_policy.
+// there must be a free page frame
+int numa_alloc_frame(const int proc_id);
+
+// account an access by a process to a page in memory, which may belong to
+// another process through a shared page, adding its cost to the stall time
+void numa_access(const int proc_id, const int owner_proc, const int owner_page);
+
+// migrate the pages accessed at least NUMA_HOT_ACCESSES times from a remote
+// node since the last scan to their process' home node, into a free frame or
+// in exchange for a page homed on the node being left, then reset the counts
+void numa_scan(void);
+
+// print the local and remote accesses of every process, the migrations and the
+// estimated memory stall time
+void numa_print_stats(void);
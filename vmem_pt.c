@@ -0,0 +1,296 @@
+#include "vmem_pt.h"
+#include "types.h"
+#include "util.h"
+#include "vmem_helpers.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// documentation is provided in vmem_pt.h
+
+extern pt_format_t pt_format;
+
+// first virtual page number of each region of a process' address space: code
+// at 0x400000, heap at 0x1000000, mmap at 0x7f0000000000 and the stack right
+// below 0x800000000000, with 4KiB pages
+static const long region_vpn[] = {0x400, 0x1000, 0x7f0000000,
+                                  0x800000000 - PT_REGION_PAGES};
+#define PT_REGIONS (sizeof(region_vpn) / sizeof(region_vpn[0]))
+
+// root table of each process' radix page table, NULL if not allocated
+static pt_node_t *radix_root[4];
+// radix tables allocated by each process, and the peak of their sum
+static int radix_tables[4];
+static int peak_radix_tables;
+// hashed inverted page table, indexed by page frame, and its chain anchors
+static pt_inverted_entry_t inverted[RAM_MAX_PAGES];
+static int anchor[PT_HASH_BUCKETS];
+// walk stats
+static long walk_count;
+static long walk_steps;
+static int max_chain; // longest hash chain walked
+
+// get the virtual page number of a page, spreading the page IDs over the
+// regions of a sparse address space
+static long get_vpn(const int proc_page_id) {
+  return region_vpn[proc_page_id / PT_REGION_PAGES] +
+         proc_page_id % PT_REGION_PAGES;
+}
+
+// get the index within a radix table of the given level, 0 being the root
+static inline int radix_index(const long vpn, const int level) {
+  return (vpn >> (PT_RADIX_BITS * (PT_RADIX_LEVELS - 1 - level))) &
+         (PT_RADIX_FANOUT - 1);
+}
+
+// get the hash chain of a page
+static inline int hash_bucket(const int proc_id, const long vpn) {
+  return ((unsigned long)vpn * 2654435761u + proc_id) % PT_HASH_BUCKETS;
+}
+
+// allocate an empty radix table
+static pt_node_t *alloc_table(const int proc_id) {
+  pt_node_t *node = malloc(sizeof(pt_node_t));
+  if (node == NULL) {
+    perror("Page table allocation error");
+    exit(1);
+  }
+
+  for (int i = 0; i < PT_RADIX_FANOUT; i++) {
+    node->child[i] = NULL;
+    node->frame[i] = -1;
+  }
+
+  radix_tables[proc_id - 1]++;
+  const int total =
+      radix_tables[0] + radix_tables[1] + radix_tables[2] + radix_tables[3];
+  if (total > peak_radix_tables)
+    peak_radix_tables = total;
+
+  return node;
+}
+
+// free a radix table and every table below it
+static void free_table(pt_node_t *node, const int level) {
+  if (level < PT_RADIX_LEVELS - 1) {
+    for (int i = 0; i < PT_RADIX_FANOUT; i++) {
+      if (node->child[i] != NULL)
+        free_table(node->child[i], level + 1);
+    }
+  }
+
+  free(node);
+}
+
+// get the leaf table of a page, allocating the tables on its path if asked to,
+// or NULL if one is absent. counts a walk step per table visited
+static pt_node_t *get_leaf(const int proc_id, const long vpn,
+                           const bool allocate, int *steps) {
+  if (proc_id < 1 || proc_id > 4) {
+    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
+    exit(10);
+  }
+
+  if (radix_root[proc_id - 1] == NULL) {
+    if (!allocate)
+      return NULL;
+    radix_root[proc_id - 1] = alloc_table(proc_id);
+  }
+
+  pt_node_t *node = radix_root[proc_id - 1];
+  for (int level = 0; level < PT_RADIX_LEVELS - 1; level++) {
+    (*steps)++;
+    pt_node_t **child = &node->child[radix_index(vpn, level)];
+
+    if (*child == NULL) {
+      if (!allocate)
+        return NULL;
+      *child = alloc_table(proc_id);
+    }
+    node = *child;
+  }
+
+  (*steps)++;
+  return node;
+}
+
+// find the frame holding a page in the hashed table, -1 if none. counts a walk
+// step for the anchor and for each entry visited
+static int find_inverted(const int proc_id, const long vpn, int *steps) {
+  (*steps)++;
+  for (int f = anchor[hash_bucket(proc_id, vpn)]; f != -1;
+       f = inverted[f].next) {
+    (*steps)++;
+
+    if (inverted[f].asid == proc_id && inverted[f].vpn == vpn)
+      return f;
+  }
+
+  return -1;
+}
+
+void pt_init(void) {
+  assert(pt_format != PT_FLAT);
+  assert(PROC_MAX_PAGES <= PT_REGIONS * PT_REGION_PAGES);
+
+  for (int p = 0; p < 4; p++) {
+    if (radix_root[p] != NULL)
+      free_table(radix_root[p], 0);
+    radix_root[p] = NULL;
+    radix_tables[p] = 0;
+  }
+  for (int f = 0; f < RAM_MAX_PAGES; f++) {
+    inverted[f] = (pt_inverted_entry_t){0, 0, -1};
+  }
+  for (int b = 0; b < PT_HASH_BUCKETS; b++) {
+    anchor[b] = -1;
+  }
+
+  peak_radix_tables = 0;
+  walk_count = 0;
+  walk_steps = 0;
+  max_chain = 0;
+}
+
+void pt_map(const int proc_id, const int proc_page_id, const int page_frame) {
+  const long vpn = get_vpn(proc_page_id);
+  int steps = 0;
+
+  if (pt_format == PT_RADIX) {
+    pt_node_t *leaf = get_leaf(proc_id, vpn, true, &steps);
+    leaf->frame[radix_index(vpn, PT_RADIX_LEVELS - 1)] = page_frame;
+    return;
+  }
+
+  assert(pt_format == PT_HASHED);
+  assert(inverted[page_frame].asid == 0); // frame should be unmapped
+  const int bucket = hash_bucket(proc_id, vpn);
+
+  inverted[page_frame] = (pt_inverted_entry_t){proc_id, vpn, anchor[bucket]};
+  anchor[bucket] = page_frame;
+}
+
+void pt_unmap(const int proc_id, const int proc_page_id) {
+  const long vpn = get_vpn(proc_page_id);
+  int steps = 0;
+
+  if (pt_format == PT_RADIX) {
+    pt_node_t *leaf = get_leaf(proc_id, vpn, false, &steps);
+    assert(leaf != NULL); // page should be mapped
+    leaf->frame[radix_index(vpn, PT_RADIX_LEVELS - 1)] = -1;
+    return;
+  }
+
+  assert(pt_format == PT_HASHED);
+  const int bucket = hash_bucket(proc_id, vpn);
+  const int page_frame = find_inverted(proc_id, vpn, &steps);
+  assert(page_frame != -1); // page should be mapped
+
+  if (anchor[bucket] == page_frame) {
+    anchor[bucket] = inverted[page_frame].next;
+  } else {
+    int f = anchor[bucket];
+    while (inverted[f].next != page_frame) {
+      f = inverted[f].next;
+    }
+    inverted[f].next = inverted[page_frame].next;
+  }
+
+  inverted[page_frame] = (pt_inverted_entry_t){0, 0, -1};
+}
+
+// translate a page through the selected page table, adding the memory
+// references it took to steps
+static int translate(const int proc_id, const int proc_page_id, int *steps) {
+  const long vpn = get_vpn(proc_page_id);
+
+  if (pt_format == PT_FLAT) {
+    (*steps)++;
+    return get_page_frame(proc_id, proc_page_id);
+  } else if (pt_format == PT_RADIX) {
+    const pt_node_t *leaf = get_leaf(proc_id, vpn, false, steps);
+    return leaf != NULL ? leaf->frame[radix_index(vpn, PT_RADIX_LEVELS - 1)]
+                        : -1;
+  }
+
+  return find_inverted(proc_id, vpn, steps);
+}
+
+int pt_lookup(const int proc_id, const int proc_page_id) {
+  assert(pt_format != PT_FLAT);
+  int steps = 0;
+
+  return translate(proc_id, proc_page_id, &steps);
+}
+
+int pt_walk(const int proc_id, const int proc_page_id) {
+  int steps = 0;
+  const int page_frame = translate(proc_id, proc_page_id, &steps);
+
+  walk_count++;
+  walk_steps += steps;
+  // every step past the anchor is a hash chain entry
+  if (pt_format == PT_HASHED && steps - 1 > max_chain)
+    max_chain = steps - 1;
+
+  return page_frame;
+}
+
+void pt_clear(const int proc_id) {
+  if (pt_format != PT_RADIX)
+    return;
+
+  if (proc_id < 1 || proc_id > 4) {
+    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
+    exit(10);
+  }
+
+  if (radix_root[proc_id - 1] != NULL)
+    free_table(radix_root[proc_id - 1], 0);
+  radix_root[proc_id - 1] = NULL;
+  radix_tables[proc_id - 1] = 0;
+}
+
+void pt_print_stats(void) {
+  const char *format_str[] = {"flat", "radix", "hashed"};
+  long footprint, peak_footprint;
+
+  if (pt_format == PT_FLAT) {
+    footprint = 4L * PROC_MAX_PAGES * PT_ENTRY_SIZE;
+    peak_footprint = footprint;
+  } else if (pt_format == PT_RADIX) {
+    const int tables =
+        radix_tables[0] + radix_tables[1] + radix_tables[2] + radix_tables[3];
+    footprint = (long)tables * PT_RADIX_FANOUT * PT_ENTRY_SIZE;
+    peak_footprint = (long)peak_radix_tables * PT_RADIX_FANOUT * PT_ENTRY_SIZE;
+  } else {
+    footprint = (long)RAM_MAX_PAGES * PT_INVERTED_ENTRY_SIZE +
+                (long)PT_HASH_BUCKETS * PT_ANCHOR_SIZE;
+    peak_footprint = footprint;
+  }
+
+  putchar('\n');
+  msg("--- Page Table Stats ---");
+  msg("Page Table Format: %11s", format_str[pt_format]);
+  msg("Walks:             %11ld", walk_count);
+  msg("Walk Steps:        %11ld", walk_steps);
+  msg("Avg Steps/Walk:    %11.2f",
+      walk_count > 0 ? walk_steps / (double)walk_count : 0.0);
+
+  if (pt_format == PT_RADIX) {
+    msg("Tables (P1-P4):    %5d/%d/%d/%d", radix_tables[0], radix_tables[1],
+        radix_tables[2], radix_tables[3]);
+    msg("Peak Tables:       %11d", peak_radix_tables);
+  } else if (pt_format == PT_HASHED) {
+    msg("Hash Buckets:      %11d", PT_HASH_BUCKETS);
+    msg("Max Chain Walked:  %11d", max_chain);
+  }
+
+  msg("Footprint:         %11ld bytes", footprint);
+  msg("Peak Footprint:    %11ld bytes", peak_footprint);
+  // a flat table indexed by virtual page number would need an entry for every
+  // page up to the top of the address space, instead of one per page ID
+  msg("Sparse Flat Size:  %11ld bytes",
+      4 * (get_vpn(PROC_MAX_PAGES - 1) + 1) * PT_ENTRY_SIZE);
+}
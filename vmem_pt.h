@@ -0,0 +1,29 @@
+#pragma once
+
+#include "types.h"
+
+// reset the radix or hashed page tables and their stats, according to
+// pt_format
+void pt_init(void);
+
+// map a page to a page frame in the radix or hashed page table, allocating the
+// radix tables on its path if needed
+void pt_map(const int proc_id, const int proc_page_id, const int page_frame);
+
+// unmap a page from the radix or hashed page table. radix tables are kept until
+// the process exits, as their other entries may still be in use
+void pt_unmap(const int proc_id, const int proc_page_id);
+
+// get the page frame of a page from the radix or hashed page table, -1 if the
+// page isn't present, without counting it as a walk
+int pt_lookup(const int proc_id, const int proc_page_id);
+
+// translate a page as the MMU would on a TLB miss, counting the walk and the
+// memory references it took. returns the page frame, or -1 on a page fault
+int pt_walk(const int proc_id, const int proc_page_id);
+
+// free the radix tables of an exited process
+void pt_clear(const int proc_id);
+
+// print the walk cost and metadata memory footprint of the page tables
+void pt_print_stats(void);
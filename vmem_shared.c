@@ -0,0 +1,312 @@
+#include "vmem_shared.h"
+#include "types.h"
+#include "util.h"
+#include "vmem_helpers.h"
+#include "vmem_tlb.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// documentation is provided in vmem_shared.h
+
+extern tlb_mode_t tlb_mode;
+
+// every shared page, indexed by shared page ID
+static shared_page_t shared[SHARED_MAX_PAGES];
+// shared page stats
+static int declarations;  // mappings declared by the trace
+static int minor_faults;  // mappings pointed to a frame already in memory
+static int zapped;        // mappings dropped along with their owner's frame
+static int transfers;     // frames handed over to another mapping
+static int cow_faults;    // writes that broke the sharing of a COW page
+static int cow_copies;    // copies made from the frame in memory
+static int cow_reuses;    // writers left alone with the frame, kept in place
+static long saved_sum;    // frames saved by sharing, summed over every round
+static int peak_saved;    // most frames saved at the end of a round
+static int sampled_rounds;
+
+// get the shared page mapped by a page, NULL if it's private
+static shared_page_t *get_shared(const int proc_id, const int proc_page_id) {
+  const int shared_id = get_page_table(proc_id)[proc_page_id].shared_id;
+  return shared_id != -1 ? &shared[shared_id] : NULL;
+}
+
+// returns whether a page is the owner's mapping of its shared page
+static inline bool is_owner(const shared_page_t *s, const int proc_id,
+                            const int proc_page_id) {
+  return s->owner_proc == proc_id && s->owner_page == proc_page_id;
+}
+
+// get the amount of pages declared as mappings of a shared page
+static int get_declared_count(const shared_page_t *s) {
+  int count = 0;
+  for (int p = 0; p < 4; p++) {
+    count += __builtin_popcount(s->declared[p]);
+  }
+
+  return count;
+}
+
+// hand the frame of a shared page over from its owner to another mapping still
+// pointing to it, which inherits the owner's flags. returns whether there was a
+// mapping to hand it to
+static bool transfer_frame(const int proc_id, const int proc_page_id) {
+  shared_page_t *s = get_shared(proc_id, proc_page_id);
+  assert(is_owner(s, proc_id, proc_page_id));
+  int heir_proc = 0, heir_page = -1;
+
+  for (int p = 0; p < 4 && heir_proc == 0; p++) {
+    uint32_t others = s->mapped[p];
+    if (p == proc_id - 1)
+      others &= ~(1u << proc_page_id);
+
+    if (others != 0) {
+      heir_proc = p + 1;
+      heir_page = __builtin_ctz(others);
+    }
+  }
+  if (heir_proc == 0)
+    return false;
+
+  const int page_frame = get_page_frame(proc_id, proc_page_id);
+
+  // the heir becomes the owner first, so that the other mappings survive the
+  // old owner leaving the frame
+  s->owner_proc = heir_proc;
+  s->owner_page = heir_page;
+  hand_over_frame(proc_id, proc_page_id, heir_proc, heir_page);
+  transfers++;
+
+  dmsg("Shared page: frame %02d handed from P%d page %02d to P%d page %02d",
+       page_frame, proc_id, proc_page_id, heir_proc, heir_page);
+  return true;
+}
+
+// remove a page's mapping of its shared page, making it private. if the page
+// owns the frame, the frame is handed over to another mapping pointing to it,
+// or kept by the page if there's none
+static void leave(const int proc_id, const int proc_page_id) {
+  shared_page_t *s = get_shared(proc_id, proc_page_id);
+  const uint32_t bit = 1u << proc_page_id;
+
+  if (is_owner(s, proc_id, proc_page_id)) {
+    if (!transfer_frame(proc_id, proc_page_id)) {
+      s->owner_proc = 0;
+      s->mapped[proc_id - 1] &= ~bit;
+      s->mapcount--;
+      assert(s->mapcount == 0);
+    }
+  } else if (s->mapped[proc_id - 1] & bit) {
+    shared_unmap(proc_id, proc_page_id);
+  }
+
+  s->declared[proc_id - 1] &= ~bit;
+  get_page_table(proc_id)[proc_page_id].shared_id = -1;
+}
+
+void shared_init(void) {
+  for (int i = 0; i < SHARED_MAX_PAGES; i++) {
+    shared[i] = (shared_page_t){0};
+  }
+
+  declarations = 0;
+  minor_faults = 0;
+  zapped = 0;
+  transfers = 0;
+  cow_faults = 0;
+  cow_copies = 0;
+  cow_reuses = 0;
+  saved_sum = 0;
+  peak_saved = 0;
+  sampled_rounds = 0;
+}
+
+void shared_declare(const int proc_id, const int proc_page_id,
+                    const int shared_id, const bool cow) {
+  assert(shared_id >= 0 && shared_id < SHARED_MAX_PAGES);
+  page_table_entry_t *entry = &get_page_table(proc_id)[proc_page_id];
+  shared_page_t *s = &shared[shared_id];
+  const bool in_use = get_declared_count(s) > 0;
+
+  if (get_valid(proc_id, proc_page_id) || entry->shared_id != -1 ||
+      (in_use && s->cow != cow)) {
+    fprintf(stderr, "Error: P%d page %02d can't map %s page %d\n", proc_id,
+            proc_page_id, cow ? "copy-on-write" : "shared", shared_id);
+    exit(12);
+  }
+
+  if (!in_use)
+    s->cow = cow;
+  s->declared[proc_id - 1] |= 1u << proc_page_id;
+  entry->shared_id = shared_id;
+  declarations++;
+
+  dmsg("Shared page: P%d page %02d maps %s page %d", proc_id, proc_page_id,
+       cow ? "copy-on-write" : "shared", shared_id);
+}
+
+bool shared_get_owner(const int proc_id, const int proc_page_id,
+                      int *owner_proc, int *owner_page) {
+  const shared_page_t *s = get_shared(proc_id, proc_page_id);
+
+  if (s == NULL || s->owner_proc == 0 || is_owner(s, proc_id, proc_page_id))
+    return false;
+
+  *owner_proc = s->owner_proc;
+  *owner_page = s->owner_page;
+  return true;
+}
+
+void shared_map(const int proc_id, const int proc_page_id) {
+  shared_page_t *s = get_shared(proc_id, proc_page_id);
+  assert(s != NULL && s->owner_proc != 0);
+  assert(!is_owner(s, proc_id, proc_page_id));
+
+  if (s->mapped[proc_id - 1] & (1u << proc_page_id))
+    return;
+
+  s->mapped[proc_id - 1] |= 1u << proc_page_id;
+  s->mapcount++;
+  minor_faults++;
+
+  msg("Minor fault P%d: %02d -> frame %02d (shared with P%d page %02d)",
+      proc_id, proc_page_id, get_page_frame(s->owner_proc, s->owner_page),
+      s->owner_proc, s->owner_page);
+}
+
+void shared_set_owner(const int proc_id, const int proc_page_id) {
+  shared_page_t *s = get_shared(proc_id, proc_page_id);
+  assert(s != NULL);
+  // the shared page can't be loaded into a second frame
+  assert(s->owner_proc == 0 || is_owner(s, proc_id, proc_page_id));
+
+  s->owner_proc = proc_id;
+  s->owner_page = proc_page_id;
+  if (!(s->mapped[proc_id - 1] & (1u << proc_page_id))) {
+    s->mapped[proc_id - 1] |= 1u << proc_page_id;
+    s->mapcount++;
+  }
+}
+
+void shared_unmap(const int proc_id, const int proc_page_id) {
+  shared_page_t *s = get_shared(proc_id, proc_page_id);
+  assert(s != NULL);
+
+  if (!is_owner(s, proc_id, proc_page_id)) {
+    if (s->mapped[proc_id - 1] & (1u << proc_page_id)) {
+      s->mapped[proc_id - 1] &= ~(1u << proc_page_id);
+      s->mapcount--;
+      if (tlb_mode != TLB_OFF)
+        tlb_shootdown(proc_id, proc_page_id);
+    }
+    return;
+  }
+
+  // every mapping pointing to the frame loses it along with the owner, and
+  // must fault it back in
+  for (int p = 0; p < 4; p++) {
+    for (int page = 0; page < PROC_MAX_PAGES; page++) {
+      if (!(s->mapped[p] & (1u << page)) || is_owner(s, p + 1, page))
+        continue;
+
+      if (tlb_mode != TLB_OFF)
+        tlb_shootdown(p + 1, page);
+      zapped++;
+    }
+    s->mapped[p] = 0;
+  }
+
+  s->owner_proc = 0;
+  s->mapcount = 0;
+}
+
+void shared_shootdown(const int proc_id, const int proc_page_id) {
+  const shared_page_t *s = get_shared(proc_id, proc_page_id);
+  assert(s != NULL);
+
+  if (tlb_mode == TLB_OFF || !is_owner(s, proc_id, proc_page_id))
+    return;
+
+  for (int p = 0; p < 4; p++) {
+    for (int page = 0; page < PROC_MAX_PAGES; page++) {
+      if ((s->mapped[p] & (1u << page)) && !is_owner(s, p + 1, page))
+        tlb_shootdown(p + 1, page);
+    }
+  }
+}
+
+void shared_write(const int proc_id, const int proc_page_id) {
+  const shared_page_t *s = get_shared(proc_id, proc_page_id);
+
+  // a page no other mapping was declared for is as good as private
+  if (s == NULL || !s->cow || get_declared_count(s) < 2)
+    return;
+
+  const bool in_memory = s->owner_proc != 0;
+  cow_faults++;
+  leave(proc_id, proc_page_id);
+
+  if (!in_memory) {
+    // the writer's copy is read from swap by an ordinary page fault
+    msg("COW fault P%d: %02d (not in memory)", proc_id, proc_page_id);
+  } else if (get_valid(proc_id, proc_page_id)) {
+    cow_reuses++;
+    msg("COW fault P%d: %02d -> frame %02d (reused)", proc_id, proc_page_id,
+        get_page_frame(proc_id, proc_page_id));
+  } else {
+    // the writer's copy is faulted in next, copied from the frame in memory
+    cow_copies++;
+    msg("COW fault P%d: %02d (copied)", proc_id, proc_page_id);
+  }
+}
+
+void shared_exit(const int proc_id) {
+  for (int page = 0; page < PROC_MAX_PAGES; page++) {
+    if (get_shared(proc_id, page) != NULL)
+      leave(proc_id, page);
+  }
+}
+
+void shared_sample(void) {
+  int saved = 0;
+
+  // every mapping pointing to a frame past the owner's would take a frame of
+  // its own without sharing
+  for (int i = 0; i < SHARED_MAX_PAGES; i++) {
+    if (shared[i].owner_proc != 0)
+      saved += shared[i].mapcount - 1;
+  }
+
+  saved_sum += saved;
+  sampled_rounds++;
+  if (saved > peak_saved)
+    peak_saved = saved;
+}
+
+int shared_get_copies(void) { return cow_copies; }
+
+void shared_print_stats(void) {
+  int shared_pages = 0, saved = 0;
+  for (int i = 0; i < SHARED_MAX_PAGES; i++) {
+    if (get_declared_count(&shared[i]) > 0)
+      shared_pages++;
+    if (shared[i].owner_proc != 0)
+      saved += shared[i].mapcount - 1;
+  }
+
+  putchar('\n');
+  msg("--- Shared Page Stats ---");
+  msg("Declared Mappings: %11d", declarations);
+  msg("Shared Pages:      %11d", shared_pages);
+  msg("Minor Faults:      %11d", minor_faults);
+  msg("Zapped Mappings:   %11d", zapped);
+  msg("Frame Handovers:   %11d", transfers);
+  msg("COW Faults:        %11d", cow_faults);
+  msg("COW Copies:        %11d", cow_copies);
+  msg("COW Reuses:        %11d", cow_reuses);
+  msg("Saved Frames:      %11d", saved);
+  msg("Avg Saved Frames:  %11.2f",
+      sampled_rounds > 0 ? saved_sum / (double)sampled_rounds : 0.0);
+  msg("Peak Saved Frames: %11d", peak_saved);
+}
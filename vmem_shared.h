@@ -0,0 +1,57 @@
+#pragma once
+
+#include "types.h"
+#include <stdbool.h>
+
+// reset every shared page and their stats
+void shared_init(void);
+
+// declare a page of a running process as a mapping of a shared page, which is
+// copy-on-write if cow is set. the page must not be in memory nor mapping
+// another shared page, and a shared page can't change between shared and
+// copy-on-write, otherwise the simulation exits with code 12
+void shared_declare(const int proc_id, const int proc_page_id,
+                    const int shared_id, const bool cow);
+
+// get the owner's mapping of the shared page mapped by a page, if it's in
+// memory and held by another mapping. returns whether it is, in which case
+// accesses to the page go to the owner's page
+bool shared_get_owner(const int proc_id, const int proc_page_id,
+                      int *owner_proc, int *owner_page);
+
+// point a page to the frame of the shared page it maps, which must be held by
+// another mapping, counting a minor fault if it wasn't pointing to it yet
+void shared_map(const int proc_id, const int proc_page_id);
+
+// make a page that was just loaded into memory the owner of the shared page it
+// maps. called by swap_in_page
+void shared_set_owner(const int proc_id, const int proc_page_id);
+
+// drop the reverse mapping of a page whose frame is going away, or of every
+// mapping if it's the owner's page, shooting down their translations. called by
+// swap_out_page
+void shared_unmap(const int proc_id, const int proc_page_id);
+
+// shoot down the translations of the mappings pointing to an owner's page being
+// moved to another frame
+void shared_shootdown(const int proc_id, const int proc_page_id);
+
+// break the sharing of a copy-on-write page written by one of its mappings,
+// while another process still maps it. the writer's page becomes private: it
+// keeps the frame if no other mapping points to it, otherwise the frame is
+// handed over to one of them and the writer must fault in a copy
+void shared_write(const int proc_id, const int proc_page_id);
+
+// remove every mapping of an exiting process, handing the frames it owns over
+// to other mappings still pointing to them
+void shared_exit(const int proc_id);
+
+// sample the frames saved by sharing, at the end of each round
+void shared_sample(void);
+
+// get the amount of copy-on-write copies made from a frame in memory, which
+// are faults that didn't need a read from swap
+int shared_get_copies(void);
+
+// print the shared page, minor fault and copy-on-write stats
+void shared_print_stats(void);
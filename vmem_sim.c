@@ -1,6 +1,21 @@
+#include "trace.h"
 #include "types.h"
 #include "util.h"
+#include "vmem_arc.h"
+#include "vmem_cgroup.h"
+#include "vmem_duel.h"
+#include "vmem_lfu.h"
 #include "vmem_helpers.h"
+#include "vmem_lirs.h"
+#include "vmem_mglru.h"
+#include "vmem_numa.h"
+#include "vmem_pt.h"
+#include "vmem_shared.h"
+#include "vmem_swapfile.h"
+#include "vmem_tlb.h"
+#include "vmem_workingset.h"
+#include "vmem_wscurve.h"
+#include "vmem_zswap.h"
 #include <assert.h>
 #include <fcntl.h>
 #include <semaphore.h>
@@ -11,6 +26,13 @@
 #include <time.h>
 #include <unistd.h>
 
+// command line usage
+#define USAGE                                                                  \
+  "Usage: ./vmem_sim [-l] [-c] [-r] [-T private|shared] "                      \
+  "[-p flat|radix|hashed] [-H eager|collapse] [-z] "                           \
+  "[-N first-touch|interleave|preferred] [-S <swap_file>] [-g] [-w] [-a] "     \
+  "[-e | -t <trace_file> | -m] <num_rounds> <page_algo> [<k_param>]\n"
+
 // selected page replacement algorithm
 page_algo_t algorithm;
 // pointer to the selected page replacement algorithm's function
@@ -30,21 +52,114 @@ queue_t *page_queue_P1;
 queue_t *page_queue_P2;
 queue_t *page_queue_P3;
 queue_t *page_queue_P4;
-// process working sets for Working Set(k)
-set_t *page_wset_P1;
-set_t *page_wset_P2;
-set_t *page_wset_P3;
-set_t *page_wset_P4;
-// global clock time for Working Set(k) page age comparison,
-// incremented every round
-int clock_counter;
-// whether we've checked that running WS(k) for the given k_param is possible,
-// once main memory is fully occupied
-bool wset_check_performed;
+// virtual time of each process, counting its memory io requests, used for
+// WSClock(k) page age comparison
+int proc_vtime[4];
+// frame under the WSClock hand of each process, the hand moves along the
+// process' resident list and wraps around to its head at -1
+int wsclock_hand[4];
+// pages with a writeback scheduled by the WSClock hand, per process
+int wsclock_pending[4][WSCLOCK_MAX_PENDING];
+int wsclock_pending_count[4];
+// WSClock stats
+int wsclock_hand_steps; // frames passed by the hands
+int wsclock_writebacks; // writebacks scheduled by the hands
+int wsclock_forced;     // faults without a clean page outside the working set
+// whether load control is enabled, swapping out whole processes on thrashing
+bool load_control_enabled;
+// load control state of each process
+load_control_t load_control[4];
+// page faults and requests in the current load control window
+int window_faults;
+int window_requests;
+// current round, counting from 1
+int current_round;
+// reverse mapping of page frames to the pages occupying them
+frame_entry_t frame_table[RAM_MAX_PAGES];
+// first frame and amount of frames in each process' resident list
+int resident_head[4];
+int resident_count[4];
+// whether each process slot currently has a running process, and its PID.
+// slots start with a process running, and the pagelists may exit and spawn
+// processes later on
+bool proc_running[4];
+int proc_pid[4];
+int next_pid;
+// round in which each page frame was freed by a process exiting, -1 if the
+// frame wasn't freed by an exit. used to measure how fast freed memory is
+// reused
+int frame_freed_round[RAM_MAX_PAGES];
+// process lifecycle statistics
+int spawn_count;
+int exit_count;
+int freed_frames_count;
+int reused_frames_count;
+int total_reuse_delay;
+int max_reuse_delay;
+// whether the event-driven scheduler is used instead of strict round-robin
+bool event_mode_enabled;
+// event-driven mode state, see run_event_simulation()
+long sim_time;              // current simulated time
+pqueue_t *event_queue;      // pending events, by process ID
+queue_t *ready_queue;       // processes waiting for the CPU
+queue_t *swap_queue;        // processes waiting for the swap device
+int swap_queue_len;         // amount of processes in swap_queue
+int swap_in_flight;         // swap io requests being served
+proc_sched_t proc_sched[4]; // scheduling data of each process
+long cpu_busy_time;         // total time the CPU spent running requests
+int event_turns;            // CPU turns given so far, 4 make a round
+int swap_io_count;          // swap io requests served
+int dirty_io_count;         // swap io requests that included a writeback
+int max_swap_queue;         // longest swap queue seen
+// interleaved trace to replay, NULL if not replaying one
+char *trace_filename;
+// swap file holding the contents of swapped out pages, NULL if pages have no
+// contents
+char *swap_filename;
+// whether to replay timestamped pagelists, merging them by timestamp
+bool merge_mode_enabled;
+// trace time of the latest replayed request
+long trace_time;
+// trace time at which the current round ends
+long round_end;
+// whether the background page cleaner is enabled
+bool cleaner_enabled;
+// page cleaner stats
+int cleaner_runs;
+int background_writebacks[4]; // dirty pages written back by the cleaner/WSClock
+int cleaned_evictions; // cleaned pages later evicted without a writeback
+int redirtied_pages;   // cleaned pages modified again while still in memory
+// whether readahead is enabled, prefetching pages along each process' stride
+bool readahead_enabled;
+// readahead state of each process
+readahead_t readahead[4];
+// how translations are cached in front of the page tables, TLB_OFF if there's
+// no TLB
+tlb_mode_t tlb_mode;
+// organisation of the page tables holding each page's frame
+pt_format_t pt_format;
+// whether evicted pages are compressed into a zswap pool, in front of the
+// backing store
+bool zswap_enabled;
+// whether processes are grouped into memory cgroups limiting their page frames
+bool cgroups_enabled;
+// whether evicted pages keep shadow entries to measure their refault distance
+bool workingset_enabled;
+// whether the working set curve of every window size k is computed
+bool wscurve_enabled;
+// how page frames are placed on NUMA nodes, NUMA_OFF if there's a single node
+numa_policy_t numa_policy;
+// how regions of pages are promoted to huge pages, HUGE_OFF if they aren't
+huge_policy_t huge_policy;
+// huge page state of each process
+huge_state_t huge_state[4];
+// unused pages of huge pages, summed over every round, for internal
+// fragmentation
+long huge_idle_pages;
 
 // clears the reference bits in each process' page table
 static inline void clear_ref_bits(void) {
-  assert(algorithm != ALGO_2ndC);
+  assert(!algo_uses_queue());
 
   for (int i = 0; i < PROC_MAX_PAGES; i++) {
     page_table_P1[i].flags &= ~PAGE_REFERENCED_BIT;
@@ -67,14 +182,14 @@ static void init_page_data(void) {
     page_table_P3[i].flags = 0;
     page_table_P4[i].flags = 0;
 
-    if (algorithm == ALGO_2ndC) {
+    if (algo_uses_queue()) {
       page_queue_P1 = create_queue();
       page_queue_P2 = create_queue();
       page_queue_P3 = create_queue();
       page_queue_P4 = create_queue();
     }
 
-    if (algorithm == ALGO_LRU) {
+    if (algo_uses_aging()) {
       page_table_P1[i].age_bits = 0;
       page_table_P2[i].age_bits = 0;
       page_table_P3[i].age_bits = 0;
@@ -82,25 +197,32 @@ static void init_page_data(void) {
     }
 
     if (algorithm == ALGO_WS) {
-      wset_check_performed = false;
-      clock_counter = 0;
-
       page_table_P1[i].age_clock = 0;
       page_table_P2[i].age_clock = 0;
       page_table_P3[i].age_clock = 0;
       page_table_P4[i].age_clock = 0;
 
-      page_wset_P1 = create_set();
-      page_wset_P2 = create_set();
-      page_wset_P3 = create_set();
-      page_wset_P4 = create_set();
+      page_table_P1[i].writeback_pending = false;
+      page_table_P2[i].writeback_pending = false;
+      page_table_P3[i].writeback_pending = false;
+      page_table_P4[i].writeback_pending = false;
     }
 
+    page_table_P1[i].last_ref_round = 0;
+    page_table_P2[i].last_ref_round = 0;
+    page_table_P3[i].last_ref_round = 0;
+    page_table_P4[i].last_ref_round = 0;
+
     page_table_P1[i].page_frame = -1;
     page_table_P2[i].page_frame = -1;
     page_table_P3[i].page_frame = -1;
     page_table_P4[i].page_frame = -1;
 
+    page_table_P1[i].shared_id = -1;
+    page_table_P2[i].shared_id = -1;
+    page_table_P3[i].shared_id = -1;
+    page_table_P4[i].shared_id = -1;
+
     page_table_P1[i].read_count = 0;
     page_table_P2[i].read_count = 0;
     page_table_P3[i].read_count = 0;
@@ -120,13 +242,81 @@ static void init_page_data(void) {
     page_table_P2[i].modified_fault_count = 0;
     page_table_P3[i].modified_fault_count = 0;
     page_table_P4[i].modified_fault_count = 0;
+
+    page_table_P1[i].pool_fault_count = 0;
+    page_table_P2[i].pool_fault_count = 0;
+    page_table_P3[i].pool_fault_count = 0;
+    page_table_P4[i].pool_fault_count = 0;
+
+    page_table_P1[i].shadow = 0;
+    page_table_P2[i].shadow = 0;
+    page_table_P3[i].shadow = 0;
+    page_table_P4[i].shadow = 0;
+  }
+
+  for (int p = 0; p < 4; p++) {
+    load_control[p] = (load_control_t){0};
+    resident_head[p] = -1;
+    resident_count[p] = 0;
+    proc_running[p] = true;
+    proc_pid[p] = p + 1;
+    readahead[p] = (readahead_t){0};
+    readahead[p].last_page = -1;
+    readahead[p].window = READAHEAD_INIT_WINDOW;
+    huge_state[p] = (huge_state_t){0};
+    proc_vtime[p] = 0;
+    wsclock_hand[p] = -1;
+    wsclock_pending_count[p] = 0;
+  }
+  window_faults = 0;
+  window_requests = 0;
+  next_pid = 5;
+  huge_idle_pages = 0;
+
+  if (algo_uses_arc())
+    arc_init();
+  else if (algo_uses_lirs())
+    lirs_init();
+  else if (algorithm == ALGO_MGLRU)
+    mglru_init();
+  else if (algo_uses_lfu())
+    lfu_init();
+  else if (algorithm == ALGO_DUEL)
+    duel_init();
+
+  if (tlb_mode != TLB_OFF)
+    tlb_init();
+  if (pt_format != PT_FLAT)
+    pt_init();
+  if (numa_policy != NUMA_OFF)
+    numa_init();
+  if (cgroups_enabled)
+    cgroup_init();
+  if (workingset_enabled)
+    workingset_init();
+  if (wscurve_enabled)
+    wscurve_init();
+  if (trace_filename != NULL)
+    shared_init();
+
+  for (int i = 0; i < RAM_MAX_PAGES; i++) {
+    frame_table[i] = (frame_entry_t){0, -1, -1, -1};
+    frame_freed_round[i] = -1;
+  }
+
+  // the pool's frames are set aside from main memory up front
+  if (zswap_enabled) {
+    zswap_init();
+    for (int i = RAM_MAX_PAGES - ZSWAP_POOL_FRAMES; i < RAM_MAX_PAGES; i++) {
+      main_memory[i] = true;
+    }
   }
 }
 
 // shifts the aging bits in each process' page table, simulating a clock tick,
 // then sets the process' age MSB according to its reference bit
 static inline void shift_aging_bits(void) {
-  assert(algorithm == ALGO_LRU);
+  assert(algo_uses_aging());
 
   for (int i = 0; i < PROC_MAX_PAGES; i++) {
     // shift age bits
@@ -147,8 +337,12 @@ static inline void shift_aging_bits(void) {
   }
 }
 
-// get the index of the first free page frame from main memory
-static int get_free_memory_index(void) {
+// get the index of the first free page frame from main memory, or of the one
+// chosen by the NUMA placement policy for a page of the process
+static int get_free_memory_index(const int proc_id) {
+  if (numa_policy != NUMA_OFF)
+    return numa_alloc_frame(proc_id);
+
   int free_memory = -1;
 
   for (int i = 0; i < RAM_MAX_PAGES; i++) {
@@ -216,160 +410,460 @@ static int get_oldest_page_LRU(const int proc_id) {
   return oldest_page;
 }
 
-// find a valid page that is not in the process' working set
-static int get_page_outside_WS(const int proc_id) {
-  for (int i = 0; i < PROC_MAX_PAGES; i++) {
-    if (get_valid(proc_id, i) && !set_contains_page(proc_id, i)) {
-      return i;
-    }
-  }
+// schedule a background writeback of a dirty page found outside the working
+// set by the WSClock hand, unless one is already pending or too many are in
+// flight. returns whether the writeback is pending
+static bool schedule_writeback_WS(const int proc_id, const int proc_page_id) {
+  page_table_entry_t *entry = &get_page_table(proc_id)[proc_page_id];
 
-  // no page outside WS found, shouldn't happen
-  return -1;
+  if (entry->writeback_pending)
+    return true;
+  if (wsclock_pending_count[proc_id - 1] == WSCLOCK_MAX_PENDING)
+    return false;
+
+  entry->writeback_pending = true;
+  wsclock_pending[proc_id - 1][wsclock_pending_count[proc_id - 1]++] =
+      proc_page_id;
+  wsclock_writebacks++;
+
+  dmsg("WSClock P%d: scheduled writeback of page %02d", proc_id, proc_page_id);
+  return true;
 }
 
-// update the working sets of each process according to the k_param
-static void update_working_sets(void) {
+// complete the writebacks scheduled by the WSClock hands during this round.
+// pages modified or evicted since then had their writeback cancelled
+static void complete_writebacks_WS(void) {
   assert(algorithm == ALGO_WS);
 
-  // for each process, go through all pages and use their age clock to check if
-  // they should be in the process' working set
   for (int proc_id = 1; proc_id <= 4; proc_id++) {
-    for (int page_id = 0; page_id < PROC_MAX_PAGES; page_id++) {
-      if (get_valid(proc_id, page_id) &&
-          (clock_counter - k_param) < get_age_clock(proc_id, page_id)) {
-        // if last page ref was less than k_param clock ticks ago, add to wset
-        set_add_page(proc_id, page_id);
-      } else {
-        // otherwise, remove from wset
-        set_remove_page(proc_id, page_id);
-      }
+    page_table_entry_t *page_table = get_page_table(proc_id);
+
+    for (int i = 0; i < wsclock_pending_count[proc_id - 1]; i++) {
+      const int page = wsclock_pending[proc_id - 1][i];
+
+      if (!page_table[page].writeback_pending)
+        continue;
+
+      page_table[page].writeback_pending = false;
+      if (swap_filename != NULL)
+        swapfile_write(proc_id, page, get_page_frame(proc_id, page));
+      set_modified(proc_id, page, false);
+      page_table[page].cleaned = true;
+      background_writebacks[proc_id - 1]++;
     }
+
+    wsclock_pending_count[proc_id - 1] = 0;
   }
 }
 
-// increment page fault count considering modified pages
-static inline void increment_fault(const vmem_io_request_t req, const int frame,
-                                   const int page) {
-  if (get_modified(req.proc_id, page)) {
+// increment page fault count considering whether the replaced page had to be
+// written back
+static inline req_result_t increment_fault(const vmem_io_request_t req,
+                                           const int frame, const int page,
+                                           const bool dirty) {
+  if (dirty) {
     // dirty
     increment_fault_count(req, true);
     msg("Page fault P%d: %02d -> frame %02d (replaced %02d) (dirty)",
         req.proc_id, req.proc_page_id, frame, page);
+    return REQ_DIRTY_FAULT;
   } else {
     // clean
     increment_fault_count(req, false);
     msg("Page fault P%d: %02d -> frame %02d (replaced %02d) (clean)",
         req.proc_id, req.proc_page_id, frame, page);
+    return REQ_CLEAN_FAULT;
   }
 }
 
-// handle page fault according to Not Recently Used
-static void page_algo_NRU(const vmem_io_request_t req) {
-  const int swap_page = get_lowest_category_page_NRU(req.proc_id);
-  assert(swap_page != -1); // there should always be a page to swap
-  const int swap_frame = get_page_frame(req.proc_id, swap_page);
-  assert(swap_frame != -1); // page to swap should be in memory
+// update frame reuse stats when a free page frame is about to be occupied
+static void note_frame_reuse(const int page_frame) {
+  if (frame_freed_round[page_frame] == -1)
+    return; // frame wasn't freed by a process exit
 
-  // check if we are swapping a modified page
-  increment_fault(req, swap_frame, swap_page);
+  const int delay = current_round - frame_freed_round[page_frame];
+  reused_frames_count++;
+  total_reuse_delay += delay;
+  if (delay > max_reuse_delay)
+    max_reuse_delay = delay;
 
-  // update page frames
-  set_page_frame(req.proc_id, req.proc_page_id, swap_frame);
-  set_page_frame(req.proc_id, swap_page, -1);
+  frame_freed_round[page_frame] = -1;
+}
 
-  // update flag bits
-  set_valid(req.proc_id, req.proc_page_id, true);
-  set_valid(req.proc_id, swap_page, false);
-  set_referenced(req.proc_id, swap_page, false);
-  set_modified(req.proc_id, swap_page, false);
+// get the page to swap out according to Not Recently Used
+static int page_algo_NRU(const int proc_id) {
+  return get_lowest_category_page_NRU(proc_id);
 }
 
-// handle page fault according to Second Chance
-static void page_algo_2ndC(const vmem_io_request_t req) {
-  int oldest_page = dequeue_page(req.proc_id);
+// get the page to swap out according to Second Chance, the page is removed
+// from the process' queue
+static int page_algo_2ndC(const int proc_id) {
+  int oldest_page = dequeue_page(proc_id);
   assert(oldest_page != -1); // there should be a page in queue
-  int oldest_frame;
 
   // find oldest page that hasn't been referenced, giving others a 2nd chance
-  while (get_referenced(req.proc_id, oldest_page)) {
-    set_referenced(req.proc_id, oldest_page, false);
-    enqueue_page(req.proc_id, oldest_page);
-    oldest_page = dequeue_page(req.proc_id);
+  while (get_referenced(proc_id, oldest_page)) {
+    set_referenced(proc_id, oldest_page, false);
+    enqueue_page(proc_id, oldest_page);
+    oldest_page = dequeue_page(proc_id);
     assert(oldest_page != -1); // there should be a page in queue
   }
 
-  oldest_frame = get_page_frame(req.proc_id, oldest_page);
-  assert(oldest_frame != -1); // oldest page should be in memory
+  return oldest_page;
+}
 
-  // check if we are swapping a modified page
-  increment_fault(req, oldest_frame, oldest_page);
+// get the page to swap out according to LRU (Aging)
+static int page_algo_LRU(const int proc_id) {
+  return get_oldest_page_LRU(proc_id);
+}
 
-  // enqueue newest page
-  enqueue_page(req.proc_id, req.proc_page_id);
+// get the page to swap out according to Clean-First LRU. the CFLRU_WINDOW least
+// recently used pages form the clean-first region, where clean pages are
+// evicted before dirty ones, as dropping them needs no writeback
+static int page_algo_CFLRU(const int proc_id) {
+  int sorted[PROC_MAX_PAGES];
+  int count = 0;
 
-  // update page frames
-  set_page_frame(req.proc_id, req.proc_page_id, oldest_frame);
-  set_page_frame(req.proc_id, oldest_page, -1);
+  // insertion sort of the resident pages from oldest to newest age
+  for (int i = 0; i < PROC_MAX_PAGES; i++) {
+    if (!get_valid(proc_id, i))
+      continue;
+
+    int j = count++;
+    while (j > 0 && get_age_bits(proc_id, sorted[j - 1]) >
+                        get_age_bits(proc_id, i)) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = i;
+  }
+  assert(count > 0); // there should be a page in memory
+
+  for (int j = 0; j < count && j < CFLRU_WINDOW; j++) {
+    if (!get_modified(proc_id, sorted[j]))
+      return sorted[j];
+  }
 
-  // update flag bits
-  set_valid(req.proc_id, req.proc_page_id, true);
-  set_valid(req.proc_id, oldest_page, false);
-  set_modified(req.proc_id, oldest_page, false);
+  // every page in the clean-first region is dirty
+  return sorted[0];
 }
 
-// handle page fault according to LRU (Aging)
-static void page_algo_LRU(const vmem_io_request_t req) {
-  int oldest_page = get_oldest_page_LRU(req.proc_id);
-  assert(oldest_page != -1); // there should be an oldest page
-  int oldest_frame = get_page_frame(req.proc_id, oldest_page);
-  assert(oldest_frame != -1); // oldest page should be in memory
+// get the page to swap out according to Aging weighted by write cost. each
+// page's age counts WRITE_COST_FACTOR times as much if it's dirty, so a dirty
+// page is only evicted before a clean one if it's much older
+static int page_algo_LRU_WC(const int proc_id) {
+  int cheapest_page = -1, lowest_cost = 0;
 
-  // check if we are swapping a modified page
-  increment_fault(req, oldest_frame, oldest_page);
-
-  // update page frames
-  set_page_frame(req.proc_id, req.proc_page_id, oldest_frame);
-  set_page_frame(req.proc_id, oldest_page, -1);
-
-  // update flag bits
-  set_valid(req.proc_id, req.proc_page_id, true);
-  set_valid(req.proc_id, oldest_page, false);
-  set_referenced(req.proc_id, oldest_page, false);
-  set_modified(req.proc_id, oldest_page, false);
-  set_age_bits(req.proc_id, oldest_page, 0); // reset age
-}
-
-// handle page fault according to Working Set (k_param)
-static void page_algo_WS(const vmem_io_request_t req) {
-  // because of our WS(k) viability check in handle_vmem_io_request, we know
-  // that there will always be at least one page outside the working set, but
-  // still in main memory, to be replaced
-  int outside_page = get_page_outside_WS(req.proc_id);
-  assert(outside_page != -1); // there should be a page outside the WS
-  int outside_frame = get_page_frame(req.proc_id, outside_page);
-  assert(outside_frame != -1); // outside page should be in memory
+  for (int i = 0; i < PROC_MAX_PAGES; i++) {
+    if (!get_valid(proc_id, i))
+      continue;
+
+    const int cost = (get_age_bits(proc_id, i) + 1) *
+                     (get_modified(proc_id, i) ? WRITE_COST_FACTOR : 1);
+
+    if (cheapest_page == -1 || cost < lowest_cost) {
+      cheapest_page = i;
+      lowest_cost = cost;
+    }
+  }
+
+  return cheapest_page;
+}
+
+// get the page to swap out according to Second Chance weighted by write cost.
+// unreferenced dirty pages are passed over WRITE_COST_FACTOR - 1 times before
+// being evicted, the page is removed from the process' queue
+static int page_algo_2ndC_WC(const int proc_id) {
+  page_table_entry_t *page_table = get_page_table(proc_id);
+  int oldest_page = dequeue_page(proc_id);
+  assert(oldest_page != -1); // there should be a page in queue
+
+  while (get_referenced(proc_id, oldest_page) ||
+         (get_modified(proc_id, oldest_page) &&
+          page_table[oldest_page].clock_passes < WRITE_COST_FACTOR - 1)) {
+    if (get_referenced(proc_id, oldest_page)) {
+      // second chance, and the dirty page's passes start over
+      set_referenced(proc_id, oldest_page, false);
+      page_table[oldest_page].clock_passes = 0;
+    } else {
+      page_table[oldest_page].clock_passes++;
+    }
+
+    enqueue_page(proc_id, oldest_page);
+    oldest_page = dequeue_page(proc_id);
+    assert(oldest_page != -1); // there should be a page in queue
+  }
+
+  return oldest_page;
+}
+
+// get the page to swap out according to ARC, from the LRU end of T1 or T2
+static int page_algo_ARC(const int proc_id) {
+  return arc_select_victim(proc_id);
+}
+
+// get the page to swap out according to CAR, sweeping the T1 or T2 clock
+static int page_algo_CAR(const int proc_id) {
+  return arc_select_victim(proc_id);
+}
+
+// get the page to swap out according to LIRS, the resident HIR page at the
+// front of Q
+static int page_algo_LIRS(const int proc_id) {
+  return lirs_select_victim(proc_id);
+}
+
+// get the page to swap out according to CLOCK-Pro, the first unreferenced cold
+// page found by hand_cold
+static int page_algo_CLOCKPRO(const int proc_id) {
+  return lirs_select_victim(proc_id);
+}
+
+// get the page to swap out according to Multi-Generational LRU, from the oldest
+// generation
+static int page_algo_MGLRU(const int proc_id) {
+  return mglru_select_victim(proc_id);
+}
+
+// get the page to swap out according to LFU, the least recently used page with
+// the lowest access count
+static int page_algo_LFU(const int proc_id) {
+  return lfu_select_victim(proc_id);
+}
+
+// get the page to swap out according to LRFU, the page with the lowest CRF
+static int page_algo_LRFU(const int proc_id) {
+  return lfu_select_victim(proc_id);
+}
+
+// get the page to swap out according to the process' live set dueling policy
+static int page_algo_DUEL(const int proc_id) {
+  return duel_select_victim(proc_id);
+}
+
+// get the page to swap out according to WSClock (k_param). the hand sweeps the
+// process' resident frames from where it last stopped, and claims the first
+// clean page outside the working set. dirty pages outside it get a writeback
+// scheduled instead, so that they're clean by the time the hand comes back. if
+// a whole revolution finds no such clean page, the oldest page outside the
+// working set is taken, or the oldest clean page, or the oldest page at all
+static int page_algo_WS(const int proc_id) {
+  int *hand = &wsclock_hand[proc_id - 1];
+  int oldest_outside = -1, oldest_clean = -1, oldest = -1;
+
+  for (int n = get_amount_page_frames(proc_id); n > 0; n--) {
+    if (*hand == -1)
+      *hand = get_first_resident_frame(proc_id);
+
+    const int page = frame_table[*hand].page_id;
+    const int age_clock = get_age_clock(proc_id, page);
+    const bool dirty = get_modified(proc_id, page);
+    *hand = frame_table[*hand].next;
+    wsclock_hand_steps++;
+
+    if (!in_working_set(proc_id, page)) {
+      if (!dirty)
+        return page;
+
+      schedule_writeback_WS(proc_id, page);
+      if (oldest_outside == -1 ||
+          age_clock < get_age_clock(proc_id, oldest_outside))
+        oldest_outside = page;
+    }
+
+    if (!dirty && (oldest_clean == -1 ||
+                   age_clock < get_age_clock(proc_id, oldest_clean)))
+      oldest_clean = page;
+    if (oldest == -1 || age_clock < get_age_clock(proc_id, oldest))
+      oldest = page;
+  }
+
+  // every page outside the working set is still dirty, or the working set
+  // doesn't fit in the process' frames
+  wsclock_forced++;
+
+  if (oldest_outside != -1)
+    return oldest_outside;
+  return oldest_clean != -1 ? oldest_clean : oldest;
+}
+
+// swap a page out of main memory, compressing it into the zswap pool first when
+// enabled. its page frame is left occupied, as with swap_out_page. returns
+// whether the page was modified and had to be written back to the backing
+// store, which the pool spares it from
+static bool evict_page(const int proc_id, const int proc_page_id) {
+  const bool modified = get_modified(proc_id, proc_page_id);
+  bool stored = false;
+
+  // a shared page's contents don't belong to the mapping holding its frame
+  if (zswap_enabled && get_page_table(proc_id)[proc_page_id].shared_id == -1)
+    stored = zswap_store(proc_id, proc_page_id, modified);
+  if (swap_filename != NULL && modified)
+    swapfile_write(proc_id, proc_page_id,
+                   get_page_frame(proc_id, proc_page_id));
+
+  swap_out_page(proc_id, proc_page_id);
+  return modified && !stored;
+}
+
+// swap a page into a page frame, reading its contents back from the swap file
+// when enabled
+static void load_page(const int proc_id, const int proc_page_id,
+                      const int page_frame) {
+  swap_in_page(proc_id, proc_page_id, page_frame);
+  if (swap_filename != NULL)
+    swapfile_read(proc_id, proc_page_id, page_frame);
+}
+
+// get the pages reclaim looks at to take a frame from a process: the victim,
+// and the referenced pages it must pass over first
+static int count_scanned(const int proc_id) {
+  int scanned = 1;
+  for (int f = get_first_resident_frame(proc_id); f != -1;
+       f = frame_table[f].next) {
+    if (get_referenced(proc_id, frame_table[f].page_id))
+      scanned++;
+  }
+
+  return scanned;
+}
+
+// returns whether a process may take a free page frame, which must be within
+// the hard limits of its memory cgroups
+static bool can_take_free_frame(const int proc_id) {
+  return is_memory_available() &&
+         (!cgroups_enabled || cgroup_can_charge(proc_id));
+}
+
+// take a page frame away from the process holding the most page frames, other
+// than exclude_proc_id, swapping out the page chosen by the selected algorithm.
+// used when a process must be given a frame while main memory is full, but it
+// has no pages of its own to replace. dirty is set to whether the victim had to
+// be written back
+static int reclaim_frame(const int exclude_proc_id, bool *dirty) {
+  int victim_proc = -1;
+  int most_frames = 0;
+
+  for (int pass = 0; pass < 2 && victim_proc == -1; pass++) {
+    for (int proc_id = 1; proc_id <= 4; proc_id++) {
+      int frames = get_amount_page_frames(proc_id);
+
+      // the first pass passes over processes within their cgroup's protection
+      if (pass == 0 && cgroups_enabled && cgroup_is_protected(proc_id))
+        continue;
+
+      if (proc_id != exclude_proc_id && frames > most_frames) {
+        victim_proc = proc_id;
+        most_frames = frames;
+      }
+    }
+  }
+  assert(victim_proc != -1); // main memory is full, someone must hold frames
+
+  const int victim_page = page_algo_func(victim_proc);
+  assert(victim_page != -1); // there should always be a page to swap
+
+  dmsg("Reclaiming frame %02d from P%d page %02d (%s)",
+       get_page_frame(victim_proc, victim_page), victim_proc, victim_page,
+       get_modified(victim_proc, victim_page) ? "dirty" : "clean");
+  if (cgroups_enabled)
+    cgroup_count_reclaim(victim_proc, count_scanned(victim_proc));
+
+  if (get_page_table(victim_proc)[victim_page].cleaned)
+    cleaned_evictions++; // writeback already done by the page cleaner
+
+  const int page_frame = get_page_frame(victim_proc, victim_page);
+  *dirty = evict_page(victim_proc, victim_page);
+  return page_frame;
+}
+
+// handle page fault when main memory is full, replacing a page of the same
+// process according to the selected algorithm
+static req_result_t replace_page(const vmem_io_request_t req) {
+  if (get_amount_page_frames(req.proc_id) == 0) {
+    // process has been swapped out by load control, so it has nothing of its
+    // own to replace, take a frame from another process instead
+    bool dirty;
+    const int page_frame = reclaim_frame(req.proc_id, &dirty);
+
+    increment_fault_count(req, dirty);
+    load_page(req.proc_id, req.proc_page_id, page_frame);
+
+    msg("Page fault P%d: %02d -> frame %02d (reclaimed) (%s)", req.proc_id,
+        req.proc_page_id, page_frame, dirty ? "dirty" : "clean");
+    return dirty ? REQ_DIRTY_FAULT : REQ_CLEAN_FAULT;
+  }
+
+  const int swap_page = page_algo_func(req.proc_id);
+  assert(swap_page != -1); // there should always be a page to swap
+  const int swap_frame = get_page_frame(req.proc_id, swap_page);
+  assert(swap_frame != -1); // page to swap should be in memory
+
+  if (get_page_table(req.proc_id)[swap_page].cleaned)
+    cleaned_evictions++; // writeback already done by the page cleaner
 
   // check if we are swapping a modified page
-  increment_fault(req, outside_frame, outside_page);
+  const bool dirty = evict_page(req.proc_id, swap_page);
+  const req_result_t result =
+      increment_fault(req, swap_frame, swap_page, dirty);
+  load_page(req.proc_id, req.proc_page_id, swap_frame);
+
+  return result;
+}
 
-  // update page frames
-  set_page_frame(req.proc_id, req.proc_page_id, outside_frame);
-  set_page_frame(req.proc_id, outside_page, -1);
+// handle a page fault by taking a frame from a memory cgroup chosen by
+// cgroup_select_victim, replacing a page of one of its processes chosen by the
+// selected algorithm
+static req_result_t reclaim_from_cgroup(const vmem_io_request_t req,
+                                        const int group) {
+  const int victim_proc = cgroup_select_proc(group);
+  const int victim_page = page_algo_func(victim_proc);
+  assert(victim_page != -1); // there should always be a page to swap
+  const int page_frame = get_page_frame(victim_proc, victim_page);
+
+  cgroup_count_reclaim(victim_proc, count_scanned(victim_proc));
+  if (get_page_table(victim_proc)[victim_page].cleaned)
+    cleaned_evictions++; // writeback already done by the page cleaner
+
+  const bool dirty = evict_page(victim_proc, victim_page);
+  increment_fault_count(req, dirty);
+  load_page(req.proc_id, req.proc_page_id, page_frame);
+
+  msg("Page fault P%d: %02d -> frame %02d (replaced P%d %02d, cgroup) (%s)",
+      req.proc_id, req.proc_page_id, page_frame, victim_proc, victim_page,
+      dirty ? "dirty" : "clean");
+  return dirty ? REQ_DIRTY_FAULT : REQ_CLEAN_FAULT;
+}
+
+// count a prefetch hit if the requested page was loaded by readahead, growing
+// the process' window, and track the stride of its accesses
+static void update_readahead(const vmem_io_request_t req) {
+  readahead_t *ra = &readahead[req.proc_id - 1];
+  page_table_entry_t *entry = &get_page_table(req.proc_id)[req.proc_page_id];
+
+  if (is_in_memory(req) && entry->prefetched) {
+    entry->prefetched = false;
+    ra->hits++;
+    ra->window = ra->window * 2 < READAHEAD_MAX_WINDOW ? ra->window * 2
+                                                       : READAHEAD_MAX_WINDOW;
+  }
 
-  // update flag bits
-  set_valid(req.proc_id, req.proc_page_id, true);
-  set_valid(req.proc_id, outside_page, false);
-  set_referenced(req.proc_id, outside_page, false);
-  set_modified(req.proc_id, outside_page, false);
+  if (ra->last_page != -1 && req.proc_page_id != ra->last_page) {
+    // distance in (-PROC_MAX_PAGES / 2, PROC_MAX_PAGES / 2], as page IDs wrap
+    // around like pagelist_gen's neighboring accesses
+    int delta = (req.proc_page_id - ra->last_page + PROC_MAX_PAGES) %
+                PROC_MAX_PAGES;
+    if (delta > PROC_MAX_PAGES / 2)
+      delta -= PROC_MAX_PAGES;
 
-  // reset age clock
-  set_age_clock(req.proc_id, outside_page, 0);
+    ra->stride = abs(delta) <= READAHEAD_MAX_STRIDE ? delta : 0;
+  }
+  ra->last_page = req.proc_page_id;
 }
 
 // handle memory io request from procs_sim, checking if a page fault is
 // necessary and updating page data structures as needed
-static void handle_vmem_io_request(const vmem_io_request_t req) {
+static req_result_t handle_vmem_io_request(const vmem_io_request_t req) {
   // validate data coming from procs_sim
   assert(req.proc_id >= 1 && req.proc_id <= 4);
   assert(req.proc_page_id >= 0 && req.proc_page_id < PROC_MAX_PAGES);
@@ -381,59 +875,1198 @@ static void handle_vmem_io_request(const vmem_io_request_t req) {
   // update flags and stats
   increment_rw_count(req);
   set_referenced(req.proc_id, req.proc_page_id, true);
+  page_table_entry_t *entry = &get_page_table(req.proc_id)[req.proc_page_id];
   if (req.operation == 'W') {
     // page has been modified, so it must be written before being replaced
     set_modified(req.proc_id, req.proc_page_id, true);
-  }
 
-  if (algorithm == ALGO_WS) {
-    if (!wset_check_performed && !is_memory_available()) {
-      // once main memory is full, check if we can run WS(k) for the given
-      // k_param. k must be less than the minimum number of page frames
-      // that a process has occupied
-      dmsg("Main memory is now full, checking WS(%d) viability", k_param);
-
-      if (k_param >= get_min_page_frames()) {
-        fprintf(stderr,
-                "Error: k_param %d is too large for this pagelist's memory "
-                "distribution, minimum frame count is %d\n",
-                k_param, get_min_page_frames());
-        exit(11);
-      }
+    // a writeback scheduled by the WSClock hand would carry stale data
+    entry->writeback_pending = false;
 
-      wset_check_performed = true;
+    if (entry->cleaned) {
+      // the background writeback was wasted
+      redirtied_pages++;
+      entry->cleaned = false;
     }
+  }
+  entry->last_ref_round = current_round;
+  if (huge_policy != HUGE_OFF)
+    huge_state[req.proc_id - 1].touched |= 1u << req.proc_page_id;
+
+  if (readahead_enabled)
+    update_readahead(req);
+
+  // update load control window stats
+  window_requests++;
+  if (!is_in_memory(req)) {
+    window_faults++;
+    load_control[req.proc_id - 1].window_faults++;
+  }
 
-    // update age clock
-    set_age_clock(req.proc_id, req.proc_page_id, clock_counter);
+  if (algorithm == ALGO_WS) {
+    // advance the process' virtual time and update the page's age clock
+    set_age_clock(req.proc_id, req.proc_page_id, ++proc_vtime[req.proc_id - 1]);
   }
 
+  if (algo_uses_arc()) {
+    // ghost hits adapt p before a victim is selected
+    if (is_in_memory(req))
+      arc_hit(req.proc_id, req.proc_page_id);
+    else
+      arc_miss(req.proc_id, req.proc_page_id);
+  } else if (algo_uses_lirs() && is_in_memory(req)) {
+    lirs_hit(req.proc_id, req.proc_page_id);
+  } else if (algo_uses_lfu() && is_in_memory(req)) {
+    lfu_hit(req.proc_id, req.proc_page_id);
+  } else if (algorithm == ALGO_DUEL) {
+    // candidates see every access, hit or not, along with their shadow caches
+    duel_access(req.proc_id, req.proc_page_id, req.operation == 'W');
+  }
+
+  if (is_in_memory(req))
+    return REQ_HIT;
+
+  // a page fault on a page held by the zswap pool is served without swap io.
+  // the page may leave the pool while room is made for the victim, so it's
+  // only known once the page is loaded
+  const int pool_loads = zswap_enabled ? zswap_get_loads() : 0;
+  // the process' memory cgroups may have to be reclaimed from first
+  const int group = cgroups_enabled ? cgroup_select_victim(
+                                          req.proc_id, !is_memory_available())
+                                    : -1;
+  req_result_t result;
+
   // check if a page fault occurred
-  if (!is_in_memory(req) && is_memory_available()) {
+  if (group != -1) {
+    result = reclaim_from_cgroup(req, group);
+  } else if (is_memory_available()) {
     // page fault, but no need to replace a page
 
-    int page_frame = get_free_memory_index();
+    int page_frame = get_free_memory_index(req.proc_id);
 
     // occupy page frame in main memory
-    main_memory[page_frame] = true;
-    set_valid(req.proc_id, req.proc_page_id, true);
-    set_page_frame(req.proc_id, req.proc_page_id, page_frame);
+    note_frame_reuse(page_frame);
+    load_page(req.proc_id, req.proc_page_id, page_frame);
 
     // update page fault stats
     increment_fault_count(req, false);
 
-    if (algorithm == ALGO_2ndC) {
-      // enqueue new page
-      enqueue_page(req.proc_id, req.proc_page_id);
-    }
-
     msg("Page fault P%d: %02d -> frame %02d (replaced none) (clean)",
         req.proc_id, req.proc_page_id, page_frame);
-  } else if (!is_in_memory(req)) {
+    result = REQ_CLEAN_FAULT;
+  } else {
     // page fault, replace a page (from the same process) with the selected
     // algorithm
-    page_algo_func(req);
+    result = replace_page(req);
+  }
+
+  if (zswap_enabled && zswap_get_loads() > pool_loads) {
+    entry->pool_fault_count++;
+    if (result == REQ_CLEAN_FAULT)
+      result = REQ_POOL_FAULT;
   }
+
+  return result;
+}
+
+// free every page frame of an exiting process, along with its algorithm data
+// structures. only the process' resident list is walked, so this is
+// O(resident pages). modified pages are discarded rather than written back, as
+// the process' memory is gone
+static void exit_process(const int proc_id) {
+  int freed = 0;
+  int page_frame;
+
+  // the process' huge pages go away with it, rather than being split to evict
+  // their pages
+  for (int page = 0; page < PROC_MAX_PAGES; page += HUGE_PAGES) {
+    if (in_huge_page(proc_id, page))
+      split_huge_page(proc_id, page);
+  }
+  huge_state[proc_id - 1].touched = 0;
+
+  // frames of shared pages still mapped by other processes stay in memory
+  if (trace_filename != NULL)
+    shared_exit(proc_id);
+  if (zswap_enabled)
+    zswap_clear(proc_id);
+  if (swap_filename != NULL)
+    swapfile_release(proc_id);
+
+  while ((page_frame = get_first_resident_frame(proc_id)) != -1) {
+    swap_out_page(proc_id, frame_table[page_frame].page_id);
+    main_memory[page_frame] = false;
+    frame_freed_round[page_frame] = current_round;
+    freed++;
+  }
+
+  if (algo_uses_queue()) {
+    clear_page_queue(proc_id);
+  } else if (algo_uses_arc()) {
+    arc_clear(proc_id);
+  } else if (algo_uses_lirs()) {
+    lirs_clear(proc_id);
+  } else if (algorithm == ALGO_MGLRU) {
+    mglru_clear(proc_id);
+  } else if (algo_uses_lfu()) {
+    lfu_clear(proc_id);
+  } else if (algorithm == ALGO_DUEL) {
+    duel_clear(proc_id);
+  }
+  pt_clear(proc_id);
+  // the process' pages are gone, they can't refault
+  if (workingset_enabled)
+    workingset_clear(proc_id);
+  if (wscurve_enabled)
+    wscurve_exit(proc_id);
+
+  proc_running[proc_id - 1] = false;
+  exit_count++;
+  freed_frames_count += freed;
+
+  msg("Process P%d (pid %d) exited, freed %d frames", proc_id,
+      proc_pid[proc_id - 1], freed);
+}
+
+// handle a process lifecycle event sent through a process' pipe
+static void handle_proc_event(const vmem_io_request_t req) {
+  assert(req.proc_id >= 1 && req.proc_id <= 4);
+  const bool running = proc_running[req.proc_id - 1];
+
+  dmsg("vmem_sim got P%d: event %c", req.proc_id, req.operation);
+
+  if (req.operation == 'X' && running) {
+    exit_process(req.proc_id);
+  } else if (req.operation == 'S' && !running) {
+    proc_running[req.proc_id - 1] = true;
+    proc_pid[req.proc_id - 1] = next_pid++;
+    spawn_count++;
+
+    msg("Process P%d (pid %d) spawned", req.proc_id, proc_pid[req.proc_id - 1]);
+  } else if ((req.operation == 'M' || req.operation == 'C') && running) {
+    assert(req.proc_page_id >= 0 && req.proc_page_id < PROC_MAX_PAGES);
+    // the page's new contents come from the shared page
+    if (zswap_enabled)
+      zswap_invalidate(req.proc_id, req.proc_page_id);
+    shared_declare(req.proc_id, req.proc_page_id, req.shared_id,
+                   req.operation == 'C');
+  } else if (req.operation != '-' || running) {
+    fprintf(stderr, "Error: invalid event %c for P%d, process is %s\n",
+            req.operation, req.proc_id, running ? "running" : "not running");
+    exit(12);
+  }
+}
+
+// swap the process out of main memory, saving its current working set, made of
+// the pages it referenced during the last load control window, for prepaging
+static void suspend_process(const int proc_id) {
+  load_control_t *lc = &load_control[proc_id - 1];
+  page_table_entry_t *page_table = get_page_table(proc_id);
+  int swapped = 0, dirty = 0;
+
+  lc->wset = 0;
+
+  for (int i = 0; i < PROC_MAX_PAGES; i++) {
+    if (!get_valid(proc_id, i))
+      continue;
+
+    if (page_table[i].last_ref_round > current_round - LOAD_CONTROL_WINDOW)
+      lc->wset |= (1u << i);
+
+    const int page_frame = get_page_frame(proc_id, i);
+    if (evict_page(proc_id, i))
+      dirty++; // must be written back before its frame is freed
+
+    main_memory[page_frame] = false;
+    swapped++;
+  }
+
+  if (algo_uses_queue()) {
+    clear_page_queue(proc_id);
+  }
+
+  lc->suspended = true;
+  lc->suspended_at = current_round;
+  lc->swap_out_count++;
+  lc->swapped_pages += swapped;
+  lc->swapped_dirty += dirty;
+
+  msg("Load control: swapped out P%d, freed %d frames (%d dirty)", proc_id,
+      swapped, dirty);
+}
+
+// resume a swapped out process, prepaging its saved working set in one batch.
+// frames are taken from other processes if main memory is full
+static void resume_process(const int proc_id) {
+  load_control_t *lc = &load_control[proc_id - 1];
+  int prepaged = 0;
+
+  for (int i = 0; i < PROC_MAX_PAGES; i++) {
+    if (!(lc->wset & (1u << i)))
+      continue;
+    // the rest of the working set is faulted in once the process' memory
+    // cgroups have room for it
+    if (cgroups_enabled && !cgroup_can_charge(proc_id))
+      break;
+
+    int page_frame;
+    if (is_memory_available()) {
+      page_frame = get_free_memory_index(proc_id);
+      note_frame_reuse(page_frame);
+    } else {
+      bool dirty;
+      page_frame = reclaim_frame(proc_id, &dirty);
+      lc->prepaged_dirty += dirty;
+    }
+
+    load_page(proc_id, i, page_frame);
+    if (algorithm == ALGO_WS)
+      set_age_clock(proc_id, i, proc_vtime[proc_id - 1]);
+    prepaged++;
+  }
+
+  lc->suspended = false;
+  lc->suspended_rounds += current_round - lc->suspended_at;
+  lc->prepaged_pages += prepaged;
+  lc->wset = 0;
+
+  msg("Load control: resumed P%d, prepaged %d pages", proc_id, prepaged);
+}
+
+// returns whether the process still has requests left and isn't swapped out
+static inline bool is_runnable(const int proc_id, const int *served,
+                               const int num_rounds) {
+  return served[proc_id - 1] < num_rounds &&
+         !load_control[proc_id - 1].suspended;
+}
+
+// detect thrashing from the fault rate of the last window, swapping out the
+// process with the most faults, or resume a swapped out process once the fault
+// rate is low enough or it has waited for too long
+static void run_load_control(const int *served, const int num_rounds) {
+  assert(load_control_enabled);
+  const double fault_rate =
+      window_requests > 0 ? (window_faults / (double)window_requests) * 100
+                          : 0.0;
+  int runnable = 0, busiest_proc = -1, oldest_suspended = -1;
+
+  for (int proc_id = 1; proc_id <= 4; proc_id++) {
+    load_control_t *lc = &load_control[proc_id - 1];
+
+    if (is_runnable(proc_id, served, num_rounds)) {
+      runnable++;
+
+      // only a running process can be swapped out
+      if (!proc_running[proc_id - 1])
+        continue;
+
+      if (busiest_proc == -1 ||
+          lc->window_faults > load_control[busiest_proc - 1].window_faults)
+        busiest_proc = proc_id;
+    } else if (lc->suspended &&
+               (oldest_suspended == -1 ||
+                lc->suspended_at <
+                    load_control[oldest_suspended - 1].suspended_at)) {
+      oldest_suspended = proc_id;
+    }
+  }
+
+  dmsg("Load control: window fault rate %.2f%%, %d runnable", fault_rate,
+       runnable);
+
+  if (oldest_suspended != -1 &&
+      (fault_rate <= LOAD_CONTROL_LOW_PCT || runnable == 0 ||
+       current_round - load_control[oldest_suspended - 1].suspended_at >=
+           LOAD_CONTROL_MAX_SUSPEND)) {
+    resume_process(oldest_suspended);
+  } else if (fault_rate >= LOAD_CONTROL_HIGH_PCT && runnable > 1 &&
+             busiest_proc != -1) {
+    // thrashing, keep at least one process running
+    msg("Load control: thrashing detected, window fault rate %.2f%%",
+        fault_rate);
+    suspend_process(busiest_proc);
+  }
+
+  // start a new window
+  window_faults = 0;
+  window_requests = 0;
+  for (int p = 0; p < 4; p++) {
+    load_control[p].window_faults = 0;
+  }
+}
+
+// position of a page in the process' 2ndC queue, 0 being the next one to be
+// checked for eviction
+static int get_queue_position_2ndC(const int proc_id, const int proc_page_id) {
+  int position = 0;
+
+  for (node_t *n = get_queue(proc_id)->front; n != NULL; n = n->next) {
+    if (n->data == proc_page_id)
+      return position;
+    position++;
+  }
+
+  return position;
+}
+
+// rank a resident page by how soon the selected algorithm is likely to evict
+// it, lower meaning sooner, or -1 if the page isn't cold. cold pages are the
+// ones that weren't referenced recently, or are outside the working set for WS
+static int get_eviction_rank(const int proc_id, const int proc_page_id) {
+  switch (algorithm) {
+  case ALGO_NRU:
+    return get_referenced(proc_id, proc_page_id) ? -1 : 0;
+  case ALGO_2ndC:
+  case ALGO_2ndC_WC:
+    // a referenced page would get a second chance
+    return get_referenced(proc_id, proc_page_id)
+               ? -1
+               : get_queue_position_2ndC(proc_id, proc_page_id);
+  case ALGO_LRU:
+  case ALGO_CFLRU:
+  case ALGO_LRU_WC: {
+    // the MSB holds the reference bit of the last round
+    const page_age_bits_t age = get_age_bits(proc_id, proc_page_id);
+    return (age & 0b10000000) ? -1 : age;
+  }
+  case ALGO_WS:
+    return in_working_set(proc_id, proc_page_id)
+               ? -1
+               : get_age_clock(proc_id, proc_page_id);
+  case ALGO_ARC:
+  case ALGO_CAR:
+    return arc_eviction_rank(proc_id, proc_page_id);
+  case ALGO_LIRS:
+  case ALGO_CLOCKPRO:
+    return lirs_eviction_rank(proc_id, proc_page_id);
+  case ALGO_MGLRU:
+    return mglru_eviction_rank(proc_id, proc_page_id);
+  case ALGO_LFU:
+  case ALGO_LRFU:
+    return lfu_eviction_rank(proc_id, proc_page_id);
+  case ALGO_DUEL:
+    return duel_eviction_rank(proc_id, proc_page_id);
+  default:
+    assert(false);
+    return -1;
+  }
+}
+
+// write back the coldest dirty pages of every process whose cold pages are
+// running out of clean ones, so that evicting them later needs no writeback.
+// the writes happen in the background, without blocking any process
+static void run_page_cleaner(void) {
+  assert(cleaner_enabled);
+  cleaner_runs++;
+
+  for (int proc_id = 1; proc_id <= 4; proc_id++) {
+    page_table_entry_t *page_table = get_page_table(proc_id);
+    int clean_cold = 0;
+
+    for (int f = get_first_resident_frame(proc_id); f != -1;
+         f = frame_table[f].next) {
+      const int page = frame_table[f].page_id;
+
+      if (get_eviction_rank(proc_id, page) != -1 &&
+          !get_modified(proc_id, page))
+        clean_cold++;
+    }
+
+    if (clean_cold >= CLEANER_LOW_WATERMARK)
+      continue;
+
+    for (int n = 0; n < CLEANER_BATCH; n++) {
+      int coldest_page = -1, coldest_rank = 0;
+
+      for (int f = get_first_resident_frame(proc_id); f != -1;
+           f = frame_table[f].next) {
+        const int page = frame_table[f].page_id;
+        const int rank = get_eviction_rank(proc_id, page);
+
+        if (rank != -1 && get_modified(proc_id, page) &&
+            (coldest_page == -1 || rank < coldest_rank)) {
+          coldest_page = page;
+          coldest_rank = rank;
+        }
+      }
+
+      if (coldest_page == -1)
+        break; // no cold dirty pages left
+
+      if (swap_filename != NULL)
+        swapfile_write(proc_id, coldest_page,
+                       get_page_frame(proc_id, coldest_page));
+      set_modified(proc_id, coldest_page, false);
+      page_table[coldest_page].cleaned = true;
+      background_writebacks[proc_id - 1]++;
+
+      dmsg("Page cleaner: wrote back P%d page %02d", proc_id, coldest_page);
+    }
+  }
+}
+
+// get the resident page of a process that its algorithm is most likely to evict
+// next, or -1 if every page is hot. the exclude_count pages from exclude_first,
+// which are being loaded, and pages prefetched but not yet accessed are left
+// alone
+static int get_coldest_page(const int proc_id, const int exclude_first,
+                            const int exclude_count) {
+  int coldest_page = -1, coldest_rank = 0;
+
+  for (int f = get_first_resident_frame(proc_id); f != -1;
+       f = frame_table[f].next) {
+    const int page = frame_table[f].page_id;
+    if ((page >= exclude_first && page < exclude_first + exclude_count) ||
+        get_page_table(proc_id)[page].prefetched)
+      continue;
+
+    const int rank = get_eviction_rank(proc_id, page);
+    if (rank != -1 && (coldest_page == -1 || rank < coldest_rank)) {
+      coldest_page = page;
+      coldest_rank = rank;
+    }
+  }
+
+  return coldest_page;
+}
+
+// prefetch the pages following a faulted one along its process' stride, up to
+// the process' readahead window. they're read along with the faulted page, and
+// take free frames, or the frames of the process' cold pages, so that
+// prefetching never evicts a page the algorithm considers hot
+static void run_readahead(const int proc_id, const int proc_page_id) {
+  assert(readahead_enabled);
+  readahead_t *ra = &readahead[proc_id - 1];
+
+  if (ra->stride == 0)
+    return;
+
+  for (int n = 1; n <= ra->window; n++) {
+    const int page =
+        ((proc_page_id + n * ra->stride) % PROC_MAX_PAGES + PROC_MAX_PAGES) %
+        PROC_MAX_PAGES;
+    // shared pages may already be in memory through another mapping
+    if (get_valid(proc_id, page) ||
+        get_page_table(proc_id)[page].shared_id != -1)
+      continue;
+
+    int page_frame;
+    if (can_take_free_frame(proc_id)) {
+      page_frame = get_free_memory_index(proc_id);
+      note_frame_reuse(page_frame);
+    } else {
+      const int victim = get_coldest_page(proc_id, proc_page_id, 1);
+      if (victim == -1)
+        break; // nothing cold left to make room with
+
+      ra->evictions++;
+      if (get_page_table(proc_id)[victim].cleaned)
+        cleaned_evictions++;
+
+      if (algo_uses_queue())
+        remove_queued_page(proc_id, victim);
+      page_frame = get_page_frame(proc_id, victim);
+      if (evict_page(proc_id, victim))
+        ra->dirty_evictions++;
+    }
+
+    load_page(proc_id, page, page_frame);
+    get_page_table(proc_id)[page].prefetched = true;
+    ra->prefetched++;
+
+    dmsg("Readahead P%d: prefetched %02d -> frame %02d", proc_id, page,
+         page_frame);
+  }
+}
+
+// get the pages of a huge page region that weren't used since being loaded, as
+// a bitmask
+static inline uint32_t get_idle_pages(const int proc_id, const int region) {
+  const uint32_t pages = ((1u << HUGE_PAGES) - 1) << (region * HUGE_PAGES);
+  return pages & ~huge_state[proc_id - 1].touched;
+}
+
+// promote a region of a process to a huge page. its missing pages are read into
+// free frames, or into the frames of the process' cold pages outside the
+// region, as for readahead. then, out of the aligned blocks of frames not
+// holding another huge page, the one already holding the most pages of the
+// region in place is chosen, and the pages in the way are migrated. returns
+// whether the region was promoted
+static bool promote_region(const int proc_id, const int region) {
+  huge_state_t *hs = &huge_state[proc_id - 1];
+  const int first = region * HUGE_PAGES;
+  int block = -1, block_score = -1;
+  assert(!hs->huge[region]);
+
+  // a shared page's frame belongs to a single mapping, so it can't be part of
+  // a huge page
+  for (int i = 0; i < HUGE_PAGES; i++) {
+    if (get_page_table(proc_id)[first + i].shared_id != -1) {
+      hs->failed_promotions++;
+      return false;
+    }
+  }
+
+  for (int b = 0; b < RAM_MAX_PAGES; b += HUGE_PAGES) {
+    bool taken = false;
+    int score = 0;
+
+    for (int i = 0; i < HUGE_PAGES; i++) {
+      const frame_entry_t *f = &frame_table[b + i];
+
+      // frames set aside for the zswap pool can't be moved either
+      if ((f->proc_id != 0 && in_huge_page(f->proc_id, f->page_id)) ||
+          (f->proc_id == 0 && main_memory[b + i]))
+        taken = true;
+      else if (f->proc_id == proc_id && f->page_id == first + i)
+        score++;
+    }
+
+    if (!taken && score > block_score) {
+      block = b;
+      block_score = score;
+    }
+  }
+
+  // make sure there are enough frames to take before reading anything
+  int missing = 0, available = 0;
+  for (int i = 0; i < HUGE_PAGES; i++) {
+    if (!get_valid(proc_id, first + i))
+      missing++;
+  }
+  for (int f = 0; f < RAM_MAX_PAGES; f++) {
+    if (!main_memory[f])
+      available++;
+  }
+  for (int f = get_first_resident_frame(proc_id); f != -1;
+       f = frame_table[f].next) {
+    const int page = frame_table[f].page_id;
+
+    if ((page < first || page >= first + HUGE_PAGES) &&
+        !get_page_table(proc_id)[page].prefetched &&
+        get_eviction_rank(proc_id, page) != -1)
+      available++;
+  }
+
+  if (block == -1 || available < missing) {
+    hs->failed_promotions++;
+    dmsg("Huge page P%d: can't promote region %02d", proc_id, region);
+    return false;
+  }
+
+  for (int i = 0; i < HUGE_PAGES; i++) {
+    const int page = first + i;
+    if (get_valid(proc_id, page))
+      continue;
+
+    int page_frame;
+    if (can_take_free_frame(proc_id)) {
+      page_frame = get_free_memory_index(proc_id);
+      note_frame_reuse(page_frame);
+    } else {
+      const int victim = get_coldest_page(proc_id, first, HUGE_PAGES);
+      if (victim == -1) {
+        // evictions made the remaining pages hot, the pages read so far stay
+        // as base pages
+        hs->failed_promotions++;
+        return false;
+      }
+
+      if (get_page_table(proc_id)[victim].cleaned)
+        cleaned_evictions++;
+
+      if (algo_uses_queue())
+        remove_queued_page(proc_id, victim);
+      page_frame = get_page_frame(proc_id, victim);
+      if (evict_page(proc_id, victim))
+        hs->dirty_evictions++;
+    }
+
+    load_page(proc_id, page, page_frame);
+    hs->bloat_reads++;
+  }
+
+  for (int i = 0; i < HUGE_PAGES; i++) {
+    const int target = block + i;
+    const int page_frame = get_page_frame(proc_id, first + i);
+    if (page_frame == target)
+      continue;
+
+    hs->migrations += frame_table[target].proc_id != 0 ? 2 : 1;
+    exchange_frames(target, page_frame);
+  }
+
+  // the huge page's translation replaces those of its pages
+  if (tlb_mode != TLB_OFF) {
+    for (int i = 0; i < HUGE_PAGES; i++) {
+      tlb_shootdown(proc_id, first + i);
+    }
+  }
+
+  hs->huge[region] = true;
+  hs->promoted_round[region] = current_round;
+  hs->promotions++;
+
+  dmsg("Huge page P%d: promoted region %02d -> frames %02d-%02d", proc_id,
+       region, block, block + HUGE_PAGES - 1);
+  return true;
+}
+
+// split the huge pages that still have HUGE_MAX_IDLE unused pages a scan
+// interval after their promotion, swapping those pages out. with collapse
+// promotion, also promote the first region of each process with at least
+// HUGE_COLLAPSE_MIN resident pages
+static void run_huge_scan(void) {
+  for (int proc_id = 1; proc_id <= 4; proc_id++) {
+    huge_state_t *hs = &huge_state[proc_id - 1];
+
+    for (int region = 0; region < PROC_MAX_PAGES / HUGE_PAGES; region++) {
+      if (!hs->huge[region] ||
+          current_round - hs->promoted_round[region] < HUGE_SCAN_INTERVAL)
+        continue;
+
+      const uint32_t idle = get_idle_pages(proc_id, region);
+      if (__builtin_popcount(idle) < HUGE_MAX_IDLE)
+        continue;
+
+      split_huge_page(proc_id, region * HUGE_PAGES);
+      hs->idle_splits++;
+
+      for (int page = region * HUGE_PAGES;
+           page < (region + 1) * HUGE_PAGES; page++) {
+        if (!(idle & (1u << page)))
+          continue;
+
+        // never used, so never modified either
+        if (algo_uses_queue())
+          remove_queued_page(proc_id, page);
+        const int page_frame = get_page_frame(proc_id, page);
+        evict_page(proc_id, page);
+        main_memory[page_frame] = false;
+        hs->idle_freed++;
+      }
+    }
+
+    if (huge_policy != HUGE_COLLAPSE || !proc_running[proc_id - 1] ||
+        load_control[proc_id - 1].suspended)
+      continue;
+
+    for (int region = 0; region < PROC_MAX_PAGES / HUGE_PAGES; region++) {
+      int resident = 0;
+      for (int i = 0; i < HUGE_PAGES; i++) {
+        if (get_valid(proc_id, region * HUGE_PAGES + i))
+          resident++;
+      }
+
+      if (!hs->huge[region] && resident >= HUGE_COLLAPSE_MIN) {
+        promote_region(proc_id, region);
+        break;
+      }
+    }
+  }
+}
+
+// post the process' semaphore and read its next memory io request from its pipe
+static vmem_io_request_t read_request(const int proc_id, sem_t **sems,
+                                      const int *pipe_reads) {
+  vmem_io_request_t req;
+
+  sem_post(sems[proc_id - 1]);
+
+  const ssize_t bytes = read(pipe_reads[proc_id - 1], &req, sizeof(req));
+  if (bytes == -1) {
+    perror("Pipe read error");
+    exit(9);
+  } else if (bytes != sizeof(req)) {
+    // the process exited before sending its request
+    fprintf(stderr, "Error: P%d closed its pipe early\n", proc_id);
+    exit(9);
+  }
+
+  return req;
+}
+
+// handle a request read from a process' pipe, which may be a memory io request
+// or a lifecycle event
+static req_result_t service_request(const vmem_io_request_t req) {
+  if (req.operation == 'R' || req.operation == 'W') {
+    if (!proc_running[req.proc_id - 1]) {
+      fprintf(stderr, "Error: P%d has no running process\n", req.proc_id);
+      exit(12);
+    }
+
+    // a write to a copy-on-write page first gives the writer a private page
+    if (req.operation == 'W' && trace_filename != NULL)
+      shared_write(req.proc_id, req.proc_page_id);
+
+    // accesses through a mapping of a shared page held by another mapping go
+    // to the owner's page, which is the one charged for the frame. the first
+    // one points the mapping to the frame, without any io
+    vmem_io_request_t target = req;
+    if (trace_filename != NULL &&
+        shared_get_owner(req.proc_id, req.proc_page_id, &target.proc_id,
+                         &target.proc_page_id))
+      shared_map(req.proc_id, req.proc_page_id);
+
+    // translations of evicted pages are shot down, so a TLB hit is always for
+    // a page in memory
+    const bool tlb_hit =
+        tlb_mode != TLB_OFF && tlb_lookup(req.proc_id, req.proc_page_id);
+    assert(!tlb_hit || is_in_memory(target));
+    if (!tlb_hit) {
+      // a shared page's mappings point to the same frame as its owner's page,
+      // so the owner's translation is walked instead of keeping aliases in
+      // the page tables, which the inverted table couldn't hold
+      const int page_frame = pt_walk(target.proc_id, target.proc_page_id);
+      assert((page_frame != -1) == is_in_memory(target));
+    }
+
+    const req_result_t result = handle_vmem_io_request(target);
+    if (req.operation == 'W' && swap_filename != NULL)
+      swapfile_touch(target.proc_id, target.proc_page_id,
+                     get_page_frame(target.proc_id, target.proc_page_id));
+    if (huge_policy == HUGE_EAGER && result != REQ_HIT)
+      promote_region(target.proc_id, target.proc_page_id >> HUGE_ORDER);
+    if (readahead_enabled && result != REQ_HIT)
+      run_readahead(target.proc_id, target.proc_page_id);
+    if (tlb_mode != TLB_OFF && !tlb_hit)
+      tlb_fill(req.proc_id, req.proc_page_id);
+    // the access is made from the requesting process' node
+    if (numa_policy != NUMA_OFF)
+      numa_access(req.proc_id, target.proc_id, target.proc_page_id);
+    if (cgroups_enabled)
+      cgroup_count_request(req.proc_id, result != REQ_HIT);
+    if (wscurve_enabled)
+      wscurve_access(req.proc_id, req.proc_page_id);
+
+    return result;
+  }
+
+  handle_proc_event(req);
+  return REQ_HIT;
+}
+
+// periodic work done at the end of each round: R bit clearing, aging, working
+// set updates, page cleaning and load control
+static void end_round(const int *served, const int num_rounds) {
+  if (algo_uses_aging()) {
+    // shift aging bits after each round, and clear ref bits
+    shift_aging_bits();
+    clear_ref_bits();
+  } else if (current_round % REF_CLEAR_INTERVAL == 0 &&
+             !algo_uses_queue()) {
+    if (algorithm == ALGO_MGLRU) {
+      // pages referenced since the last pass move to the youngest generation
+      mglru_age();
+    }
+
+    // periodically clear reference bits
+    clear_ref_bits();
+  }
+
+  if (algorithm == ALGO_DUEL) {
+    // age the candidates and, at the end of an epoch, pick the live ones
+    duel_tick();
+  }
+
+  if (algorithm == ALGO_LFU && current_round % LFU_AGING_INTERVAL == 0) {
+    // halve access counts, so that old popularity fades away
+    lfu_age();
+  }
+
+  if (algorithm == ALGO_WS) {
+    // writebacks scheduled by the WSClock hands are done by now
+    complete_writebacks_WS();
+  }
+
+  if (algo_uses_arc()) {
+    // track how p adapts over the run
+    arc_sample_p();
+  }
+
+  if (cleaner_enabled && current_round % CLEANER_INTERVAL == 0) {
+    run_page_cleaner();
+  }
+
+  if (trace_filename != NULL) {
+    // mappings of shared pages pointing to the same frame save frames
+    shared_sample();
+  }
+
+  if (huge_policy != HUGE_OFF) {
+    // huge pages' unused pages are memory wasted by internal fragmentation
+    for (int proc_id = 1; proc_id <= 4; proc_id++) {
+      for (int region = 0; region < PROC_MAX_PAGES / HUGE_PAGES; region++) {
+        if (huge_state[proc_id - 1].huge[region])
+          huge_idle_pages +=
+              __builtin_popcount(get_idle_pages(proc_id, region));
+      }
+    }
+
+    if (current_round % HUGE_SCAN_INTERVAL == 0)
+      run_huge_scan();
+  }
+
+  if (numa_policy != NUMA_OFF && current_round % NUMA_SCAN_INTERVAL == 0) {
+    // move hot pages accessed from a remote node closer to their process
+    numa_scan();
+  }
+
+  if (cgroups_enabled)
+    cgroup_sample();
+  if (workingset_enabled)
+    workingset_sample();
+
+  if (load_control_enabled) {
+    bool any_runnable = false;
+    for (int proc_id = 1; proc_id <= 4; proc_id++) {
+      any_runnable = any_runnable || is_runnable(proc_id, served, num_rounds);
+    }
+
+    // don't wait for the window to end when only swapped out processes have
+    // requests left
+    if (current_round % LOAD_CONTROL_WINDOW == 0 || !any_runnable) {
+      run_load_control(served, num_rounds);
+    }
+  }
+
+  dmsg("vmem_sim finished round %d", current_round);
+}
+
+// main loop, post sem and read memory io requests from processes' pipes. each
+// iteration is a round, meaning one IO request from each process that isn't
+// swapped out by load control. without load control there are exactly
+// num_rounds rounds
+static void run_round_robin_simulation(sem_t **sems, const int *pipe_reads,
+                                       const int num_rounds) {
+  // requests served so far for each process, a process is done once it has
+  // sent num_rounds requests
+  int served[4] = {0};
+  int total_served = 0;
+
+  for (current_round = 1; total_served < num_rounds * 4; current_round++) {
+    for (int proc_id = 1; proc_id <= 4; proc_id++) {
+      if (!is_runnable(proc_id, served, num_rounds))
+        continue;
+
+      service_request(read_request(proc_id, sems, pipe_reads));
+
+      served[proc_id - 1]++;
+      total_served++;
+    }
+
+    end_round(served, num_rounds);
+  }
+}
+
+// hand a blocked process' swap io to the swap device, or queue it if the
+// device is already serving EVENT_SWAP_QUEUE_DEPTH requests
+static void submit_swap_io(const int proc_id) {
+  proc_sched_t *ps = &proc_sched[proc_id - 1];
+
+  if (swap_in_flight < EVENT_SWAP_QUEUE_DEPTH) {
+    swap_in_flight++;
+    ps->in_device = true;
+    pq_push(event_queue, sim_time + ps->io_time, proc_id);
+  } else {
+    ps->in_device = false;
+    enqueue(swap_queue, proc_id);
+
+    if (++swap_queue_len > max_swap_queue)
+      max_swap_queue = swap_queue_len;
+  }
+}
+
+// make a process ready for the CPU again, or done if it has no requests left
+static void make_ready(const int proc_id, const int *served,
+                       const int num_rounds) {
+  proc_sched_t *ps = &proc_sched[proc_id - 1];
+
+  if (served[proc_id - 1] >= num_rounds) {
+    ps->state = PROC_DONE;
+  } else {
+    ps->state = PROC_READY;
+    enqueue(ready_queue, proc_id);
+  }
+}
+
+// give the CPU to a process for one request. a page fault blocks the process
+// once its CPU time is over, until the swap io is done
+static void run_turn(const int proc_id, sem_t **sems, const int *pipe_reads,
+                     int *served, const int num_rounds) {
+  proc_sched_t *ps = &proc_sched[proc_id - 1];
+  const vmem_io_request_t req = read_request(proc_id, sems, pipe_reads);
+  served[proc_id - 1]++;
+
+  if (req.operation == '-') {
+    // empty process slot, wait a turn without using the CPU
+    service_request(req);
+    ps->state = PROC_SLEEPING;
+    pq_push(event_queue, sim_time + EVENT_ACCESS_TIME, proc_id);
+  } else {
+    const req_result_t result = service_request(req);
+    // a page in the zswap pool is decompressed by the CPU, without swap io
+    const int turn_time =
+        EVENT_ACCESS_TIME + (result == REQ_POOL_FAULT ? ZSWAP_LOAD_TIME : 0);
+
+    ps->state = PROC_RUNNING;
+    ps->io_time = 0;
+    if (result == REQ_CLEAN_FAULT || result == REQ_DIRTY_FAULT) {
+      ps->io_dirty = result == REQ_DIRTY_FAULT;
+      ps->io_time = EVENT_SWAP_IN_TIME +
+                    (ps->io_dirty ? EVENT_WRITEBACK_TIME : 0);
+    }
+
+    ps->cpu_time += turn_time;
+    cpu_busy_time += turn_time;
+    pq_push(event_queue, sim_time + turn_time, proc_id);
+  }
+
+  // keep rounds comparable with round-robin mode, for periodic work
+  if (++event_turns % 4 == 0) {
+    end_round(served, num_rounds);
+    current_round++;
+
+    // put processes resumed by load control back in the ready queue
+    for (int p = 1; p <= 4; p++) {
+      if (proc_sched[p - 1].state == PROC_PARKED &&
+          !load_control[p - 1].suspended)
+        make_ready(p, served, num_rounds);
+    }
+  }
+}
+
+// handle the pending event of a process, according to its scheduling state
+static void handle_event(const int proc_id, const int *served,
+                         const int num_rounds, bool *cpu_busy) {
+  proc_sched_t *ps = &proc_sched[proc_id - 1];
+
+  switch (ps->state) {
+  case PROC_RUNNING:
+    // CPU turn is over
+    *cpu_busy = false;
+
+    if (ps->io_time > 0) {
+      ps->state = PROC_BLOCKED;
+      ps->block_start = sim_time;
+      submit_swap_io(proc_id);
+    } else {
+      make_ready(proc_id, served, num_rounds);
+    }
+    break;
+  case PROC_BLOCKED: {
+    // swap io is done, free the device slot for the next queued io
+    const long blocked = sim_time - ps->block_start;
+    ps->queued_time += blocked - ps->io_time;
+    if (ps->io_dirty) {
+      ps->dirty_blocked_time += blocked;
+      dirty_io_count++;
+    } else {
+      ps->clean_blocked_time += blocked;
+    }
+    swap_io_count++;
+    swap_in_flight--;
+    ps->in_device = false;
+
+    int next = dequeue(swap_queue);
+    if (next != -1) {
+      swap_queue_len--;
+      swap_in_flight++;
+      proc_sched[next - 1].in_device = true;
+      pq_push(event_queue, sim_time + proc_sched[next - 1].io_time, next);
+    }
+
+    make_ready(proc_id, served, num_rounds);
+    break;
+  }
+  case PROC_SLEEPING:
+    make_ready(proc_id, served, num_rounds);
+    break;
+  default:
+    // no other state has a pending event
+    assert(false);
+  }
+}
+
+// discrete-event simulation. a single CPU runs ready processes in round-robin,
+// one request per turn, while faulting processes block on a swap device that
+// serves up to EVENT_SWAP_QUEUE_DEPTH requests at once. simulated time jumps
+// from one event to the next, popped from a priority queue
+static void run_event_simulation(sem_t **sems, const int *pipe_reads,
+                                 const int num_rounds) {
+  int served[4] = {0};
+  bool cpu_busy = false;
+
+  event_queue = create_pqueue();
+  ready_queue = create_queue();
+  swap_queue = create_queue();
+  sim_time = 0;
+  current_round = 1;
+
+  for (int proc_id = 1; proc_id <= 4; proc_id++) {
+    proc_sched[proc_id - 1] = (proc_sched_t){0};
+    make_ready(proc_id, served, num_rounds);
+  }
+
+  while (true) {
+    // dispatch the next ready process if the CPU is free
+    while (!cpu_busy) {
+      int proc_id = dequeue(ready_queue);
+      if (proc_id == -1)
+        break;
+
+      if (load_control[proc_id - 1].suspended) {
+        // swapped out, leave it out of the ready queue until resumed
+        proc_sched[proc_id - 1].state = PROC_PARKED;
+        continue;
+      }
+
+      run_turn(proc_id, sems, pipe_reads, served, num_rounds);
+      cpu_busy = proc_sched[proc_id - 1].state == PROC_RUNNING;
+    }
+
+    long event_time;
+    int proc_id = pq_pop(event_queue, &event_time);
+
+    if (proc_id == -1) {
+      // the CPU and swap device are idle and the ready queue is empty, so
+      // there's nothing left to run, unless processes are parked by load
+      // control
+      bool parked = false;
+      for (int p = 1; p <= 4; p++) {
+        parked = parked || proc_sched[p - 1].state == PROC_PARKED;
+      }
+      if (!parked)
+        break;
+
+      run_load_control(served, num_rounds);
+      for (int p = 1; p <= 4; p++) {
+        if (proc_sched[p - 1].state == PROC_PARKED &&
+            !load_control[p - 1].suspended)
+          make_ready(p, served, num_rounds);
+      }
+      continue;
+    }
+
+    assert(event_time >= sim_time);
+    sim_time = event_time;
+    handle_event(proc_id, served, num_rounds, &cpu_busy);
+  }
+
+  free_pqueue(event_queue);
+  free_queue(ready_queue);
+  free_queue(swap_queue);
+}
+
+// push processes resumed by load control back into the merge queue
+static void unpark_resumed(pqueue_t *merge_queue, bool *parked,
+                           const vmem_io_request_t *heads) {
+  for (int p = 0; p < 4; p++) {
+    if (parked[p] && !load_control[p].suspended) {
+      parked[p] = false;
+      pq_push(merge_queue, heads[p].timestamp, p + 1);
+    }
+  }
+}
+
+// move the trace clock up to timestamp, running the periodic work for every
+// round it went through. requests of resumed processes may be older than the
+// trace clock
+static void advance_trace_clock(const long timestamp, const int *served,
+                                const int num_rounds, pqueue_t *merge_queue,
+                                bool *parked, const vmem_io_request_t *heads) {
+  if (timestamp > trace_time)
+    trace_time = timestamp;
+
+  while (trace_time >= round_end) {
+    end_round(served, num_rounds);
+    current_round++;
+    round_end += TRACE_ROUND_TIME;
+
+    if (merge_queue != NULL)
+      unpark_resumed(merge_queue, parked, heads);
+  }
+}
+
+// replay timestamped requests in the order they arrived, rather than strict
+// round-robin. with an interleaved trace the records are replayed in file
+// order. with timestamped pagelists, the next request of each process is kept
+// in a priority queue by timestamp and the earliest one is replayed (k-way
+// merge), skipping processes swapped out by load control. the periodic end of
+// round work follows the trace clock, running once every TRACE_ROUND_TIME
+static void run_replay_simulation(sem_t **sems, const int *pipe_reads,
+                                  const int num_rounds) {
+  int served[4] = {0};  // requests replayed for each process
+  int fetched[4] = {0}; // requests read from each process' pipe
+  bool parked[4] = {false};
+  vmem_io_request_t heads[4];
+  pqueue_t *merge_queue = NULL;
+  trace_file_t *trace = NULL;
+  int total_served = 0;
+
+  current_round = 1;
+  trace_time = 0;
+  round_end = TRACE_ROUND_TIME;
+
+  if (trace_filename != NULL) {
+    trace = trace_open(trace_filename);
+  } else {
+    merge_queue = create_pqueue();
+    for (int proc_id = 1; proc_id <= 4; proc_id++) {
+      heads[proc_id - 1] = read_request(proc_id, sems, pipe_reads);
+      fetched[proc_id - 1]++;
+      pq_push(merge_queue, heads[proc_id - 1].timestamp, proc_id);
+    }
+  }
+
+  while (total_served < num_rounds * 4) {
+    vmem_io_request_t req;
+
+    if (trace != NULL) {
+      trace_record_t rec;
+      if (!trace_read(trace, &rec))
+        break;
+      req = trace_record_to_request(&rec);
+      advance_trace_clock(req.timestamp, served, num_rounds, NULL, NULL, NULL);
+    } else {
+      const int proc_id = pq_pop(merge_queue, NULL);
+
+      if (proc_id == -1) {
+        // only swapped out processes have requests left
+        run_load_control(served, num_rounds);
+        unpark_resumed(merge_queue, parked, heads);
+        continue;
+      } else if (load_control[proc_id - 1].suspended) {
+        parked[proc_id - 1] = true;
+        continue;
+      }
+
+      advance_trace_clock(heads[proc_id - 1].timestamp, served, num_rounds,
+                          merge_queue, parked, heads);
+      if (load_control[proc_id - 1].suspended) {
+        // swapped out by the rounds that just ended, keep the request for
+        // when it's resumed
+        parked[proc_id - 1] = true;
+        continue;
+      }
+
+      req = heads[proc_id - 1];
+      if (fetched[proc_id - 1] < num_rounds) {
+        heads[proc_id - 1] = read_request(proc_id, sems, pipe_reads);
+        fetched[proc_id - 1]++;
+        pq_push(merge_queue, heads[proc_id - 1].timestamp, proc_id);
+      }
+    }
+
+    service_request(req);
+    served[req.proc_id - 1]++;
+    total_served++;
+  }
+
+  if (trace != NULL)
+    trace_close(trace);
+  if (merge_queue != NULL)
+    free_pqueue(merge_queue);
 }
 
 // print the bit vector representation of page_flags_t to a buffer
@@ -516,29 +2149,35 @@ static void print_page_tables(void) {
       char valid = get_valid(proc_id, i) ? 'V' : '-';
       flags_to_str(page_table[i].flags, flags_str, sizeof(flags_str));
 
-      if (algorithm == ALGO_LRU) {
+      if (algo_uses_aging()) {
         age_bits_to_str(page_table[i].age_bits, age_bits_str,
                         sizeof(age_bits_str));
 
         msg("Page %02d: Frame %02d | Flags %s (%c%c%c) | Age bits %s",
-            page_table[i].page_id, page_table[i].page_frame, flags_str,
+            page_table[i].page_id, get_page_frame(proc_id, i), flags_str,
             modified, referenced, valid, age_bits_str);
       } else if (algorithm == ALGO_WS) {
         msg("Page %02d: Frame %02d | Flags %s (%c%c%c) | Age clock %d",
-            page_table[i].page_id, page_table[i].page_frame, flags_str,
+            page_table[i].page_id, get_page_frame(proc_id, i), flags_str,
             modified, referenced, valid, page_table[i].age_clock);
       } else {
         msg("Page %02d: Frame %02d | Flags %s (%c%c%c)", page_table[i].page_id,
-            page_table[i].page_frame, flags_str, modified, referenced, valid);
+            get_page_frame(proc_id, i), flags_str, modified, referenced, valid);
       }
     }
 
     // print additional data structures
-    if (algorithm == ALGO_2ndC) {
+    if (algo_uses_queue()) {
       queue_to_str(get_queue(proc_id), buffer, sizeof(buffer));
       msg("Process FIFO Queue: %s", buffer);
     } else if (algorithm == ALGO_WS) {
-      set_to_str(get_set(proc_id), buffer, sizeof(buffer));
+      set_t wset = {0};
+      for (int i = 0; i < PROC_MAX_PAGES; i++) {
+        if (get_valid(proc_id, i) && in_working_set(proc_id, i))
+          set_add(&wset, i);
+      }
+
+      set_to_str(&wset, buffer, sizeof(buffer));
       msg("Process Working Set: %s", buffer);
     }
 
@@ -551,22 +2190,31 @@ static void print_stats(void) {
   int total_reads = 0, total_writes = 0, total_page_faults = 0,
       total_modified_faults = 0;
   int total_requests = 0;
+  int total_swapped_pages = 0, total_swapped_dirty = 0, total_prepaged = 0;
+  int total_prepaged_dirty = 0;
+  readahead_t total_ra = {0};
+  huge_state_t total_huge = {0};
+  int total_background = 0;
+  int total_pool_faults = 0;
   page_table_entry_t *page_tables[] = {page_table_P1, page_table_P2,
                                        page_table_P3, page_table_P4};
 
   // sum and print stats from each process table
   for (int p = 0; p < 4; p++) {
     int reads = 0, writes = 0, page_faults = 0, modified_faults = 0;
+    int pool_faults = 0;
     for (int i = 0; i < PROC_MAX_PAGES; i++) {
       reads += page_tables[p][i].read_count;
       writes += page_tables[p][i].write_count;
       page_faults += page_tables[p][i].page_fault_count;
       modified_faults += page_tables[p][i].modified_fault_count;
+      pool_faults += page_tables[p][i].pool_fault_count;
     }
     total_reads += reads;
     total_writes += writes;
     total_page_faults += page_faults;
     total_modified_faults += modified_faults;
+    total_pool_faults += pool_faults;
     total_requests += (reads + writes);
 
     putchar('\n');
@@ -575,6 +2223,53 @@ static void print_stats(void) {
     msg("Writes:            %11d", writes);
     msg("Page Faults:       %11d", page_faults);
     msg("Modified Faults:   %11d", modified_faults);
+    if (zswap_enabled)
+      msg("Pool Faults:       %11d", pool_faults);
+
+    if (load_control_enabled) {
+      const load_control_t *lc = &load_control[p];
+      total_swapped_pages += lc->swapped_pages;
+      total_swapped_dirty += lc->swapped_dirty;
+      total_prepaged += lc->prepaged_pages;
+      total_prepaged_dirty += lc->prepaged_dirty;
+
+      msg("Swap Outs:         %11d", lc->swap_out_count);
+      msg("Swapped Pages:     %11d", lc->swapped_pages);
+      msg("Prepaged Pages:    %11d", lc->prepaged_pages);
+      msg("Suspended Rounds:  %11d", lc->suspended_rounds);
+    }
+
+    if (cleaner_enabled || algorithm == ALGO_WS) {
+      total_background += background_writebacks[p];
+      msg("Background Writes: %11d", background_writebacks[p]);
+    }
+
+    if (readahead_enabled) {
+      const readahead_t *ra = &readahead[p];
+      total_ra.prefetched += ra->prefetched;
+      total_ra.hits += ra->hits;
+      total_ra.wasted += ra->wasted;
+      total_ra.evictions += ra->evictions;
+      total_ra.dirty_evictions += ra->dirty_evictions;
+
+      msg("Prefetched Pages:  %11d", ra->prefetched);
+      msg("Prefetch Hits:     %11d", ra->hits);
+    }
+
+    if (huge_policy != HUGE_OFF) {
+      const huge_state_t *hs = &huge_state[p];
+      total_huge.promotions += hs->promotions;
+      total_huge.failed_promotions += hs->failed_promotions;
+      total_huge.bloat_reads += hs->bloat_reads;
+      total_huge.dirty_evictions += hs->dirty_evictions;
+      total_huge.migrations += hs->migrations;
+      total_huge.splits += hs->splits;
+      total_huge.idle_splits += hs->idle_splits;
+      total_huge.idle_freed += hs->idle_freed;
+
+      msg("Huge Promotions:   %11d", hs->promotions);
+      msg("Huge Splits:       %11d", hs->splits + hs->idle_splits);
+    }
   }
 
   // print combined stats
@@ -589,52 +2284,403 @@ static void print_stats(void) {
       (total_page_faults / (double)total_requests) * 100);
   msg("Dirty Fault Rate:  %10.2f%%",
       (total_modified_faults / (double)total_requests) * 100);
+  // every page read from swap costs 1, and every page written back costs
+  // WRITE_COST_FACTOR, including the ones moved by load control, the cleaner,
+  // readahead, huge page promotion and the zswap pool. copy-on-write copies
+  // made from a frame in memory and pages loaded from the pool are reads that
+  // didn't touch the backing store
+  const int copies = trace_filename != NULL ? shared_get_copies() : 0;
+  msg("Total I/O Cost:    %11d",
+      total_page_faults - copies + total_prepaged + total_ra.prefetched +
+          total_huge.bloat_reads -
+          (zswap_enabled ? zswap_get_loads() : 0) +
+          (total_modified_faults + total_swapped_dirty + total_prepaged_dirty +
+           total_background + total_ra.dirty_evictions +
+           total_huge.dirty_evictions +
+           (zswap_enabled ? zswap_get_writebacks() : 0)) *
+              WRITE_COST_FACTOR);
+
+  if (tlb_mode != TLB_OFF)
+    tlb_print_stats();
+  pt_print_stats();
+  if (numa_policy != NUMA_OFF)
+    numa_print_stats();
+  if (cgroups_enabled)
+    cgroup_print_stats();
+  if (workingset_enabled)
+    workingset_print_stats();
+  if (wscurve_enabled)
+    wscurve_print_stats();
+
+  if (algo_uses_arc())
+    arc_print_stats();
+  else if (algo_uses_lirs())
+    lirs_print_stats();
+  else if (algorithm == ALGO_MGLRU)
+    mglru_print_stats();
+  else if (algo_uses_lfu())
+    lfu_print_stats();
+  else if (algorithm == ALGO_DUEL)
+    duel_print_stats();
+
+  if (algorithm == ALGO_WS) {
+    putchar('\n');
+    msg("--- WSClock Stats ---");
+    msg("Hand Steps:        %11d", wsclock_hand_steps);
+    msg("Avg Steps/Fault:   %11.2f",
+        total_page_faults > 0 ? wsclock_hand_steps / (double)total_page_faults
+                              : 0.0);
+    msg("Writebacks Issued: %11d", wsclock_writebacks);
+    msg("Background Writes: %11d", total_background);
+    msg("Cleaned Evictions: %11d", cleaned_evictions);
+    msg("Forced Evictions:  %11d", wsclock_forced);
+  }
+
+  if (event_mode_enabled) {
+    // the time processes spend blocked on dirty faults shows their real cost
+    long clean_blocked = 0, dirty_blocked = 0, queued = 0;
+    for (int p = 0; p < 4; p++) {
+      clean_blocked += proc_sched[p].clean_blocked_time;
+      dirty_blocked += proc_sched[p].dirty_blocked_time;
+      queued += proc_sched[p].queued_time;
+    }
+    const int clean_io_count = swap_io_count - dirty_io_count;
+
+    putchar('\n');
+    msg("--- Event-Driven Stats ---");
+    msg("Simulated Time:    %11ld", sim_time);
+    msg("CPU Busy Time:     %11ld", cpu_busy_time);
+    msg("CPU Utilisation:   %10.2f%%",
+        sim_time > 0 ? (cpu_busy_time / (double)sim_time) * 100 : 0.0);
+    msg("Throughput:        %11.2f requests/1000 time units",
+        sim_time > 0 ? (total_requests / (double)sim_time) * 1000 : 0.0);
+    msg("Swap IOs:          %11d", swap_io_count);
+    msg("Dirty Swap IOs:    %11d", dirty_io_count);
+    msg("Max Swap Queue:    %11d", max_swap_queue);
+    msg("Avg Swap Queue Wait: %9.2f",
+        swap_io_count > 0 ? queued / (double)swap_io_count : 0.0);
+    msg("Avg Clean Block:   %11.2f",
+        clean_io_count > 0 ? clean_blocked / (double)clean_io_count : 0.0);
+    msg("Avg Dirty Block:   %11.2f",
+        dirty_io_count > 0 ? dirty_blocked / (double)dirty_io_count : 0.0);
+    msg("Dirty Blocked Share: %8.2f%%",
+        clean_blocked + dirty_blocked > 0
+            ? (dirty_blocked / (double)(clean_blocked + dirty_blocked)) * 100
+            : 0.0);
+  }
+
+  if (cleaner_enabled) {
+    // modified faults are the foreground writebacks a faulting process has to
+    // wait for, while the cleaner's writebacks happen in the background
+    putchar('\n');
+    msg("--- Page Cleaner Stats ---");
+    msg("Cleaner Runs:      %11d", cleaner_runs);
+    msg("Foreground Writes: %11d", total_modified_faults);
+    msg("Background Writes: %11d", total_background);
+    msg("Cleaned Evictions: %11d", cleaned_evictions);
+    msg("Redirtied Pages:   %11d", redirtied_pages);
+    msg("Total Write Rate:  %10.2f%%",
+        ((total_modified_faults + total_background) / (double)total_requests) *
+            100);
+  }
+
+  if (readahead_enabled) {
+    // prefetched pages cost a read each, which pays off only when they're hit
+    // before being evicted
+    putchar('\n');
+    msg("--- Readahead Stats ---");
+    msg("Prefetched Pages:  %11d", total_ra.prefetched);
+    msg("Prefetch Hits:     %11d", total_ra.hits);
+    msg("Wasted Prefetches: %11d", total_ra.wasted);
+    msg("Displaced Pages:   %11d", total_ra.evictions);
+    msg("Dirty Evictions:   %11d", total_ra.dirty_evictions);
+    msg("Prefetch Accuracy: %10.2f%%",
+        total_ra.prefetched > 0
+            ? (total_ra.hits / (double)total_ra.prefetched) * 100
+            : 0.0);
+    msg("Final Windows:     %5d/%d/%d/%d", readahead[0].window,
+        readahead[1].window, readahead[2].window, readahead[3].window);
+  }
+
+  if (huge_policy != HUGE_OFF) {
+    int huge_pages = 0;
+    for (int p = 0; p < 4; p++) {
+      for (int region = 0; region < PROC_MAX_PAGES / HUGE_PAGES; region++) {
+        huge_pages += huge_state[p].huge[region];
+      }
+    }
+
+    // pages read only to complete a huge page cost a read each, and the ones
+    // that stay unused waste the frames they hold
+    putchar('\n');
+    msg("--- Huge Page Stats ---");
+    msg("Promotion Policy:  %11s",
+        huge_policy == HUGE_EAGER ? "eager" : "collapse");
+    msg("Huge Page Size:    %11d pages", HUGE_PAGES);
+    msg("Promotions:        %11d", total_huge.promotions);
+    msg("Failed Promotions: %11d", total_huge.failed_promotions);
+    msg("Bloat Reads:       %11d", total_huge.bloat_reads);
+    msg("Dirty Evictions:   %11d", total_huge.dirty_evictions);
+    msg("Migrated Pages:    %11d", total_huge.migrations);
+    msg("Eviction Splits:   %11d", total_huge.splits);
+    msg("Idle Splits:       %11d", total_huge.idle_splits);
+    msg("Idle Pages Freed:  %11d", total_huge.idle_freed);
+    msg("Final Huge Pages:  %11d", huge_pages);
+    msg("Avg Unused Frames: %11.2f",
+        current_round > 1 ? huge_idle_pages / (double)(current_round - 1)
+                          : 0.0);
+    msg("Frame Waste:       %10.2f%%",
+        current_round > 1 ? (huge_idle_pages / (double)(current_round - 1)) /
+                                RAM_MAX_PAGES * 100
+                          : 0.0);
+  }
+
+  if (trace_filename != NULL)
+    shared_print_stats();
+
+  if (swap_filename != NULL)
+    swapfile_print_stats();
+
+  if (zswap_enabled)
+    zswap_print_stats(total_pool_faults,
+                      total_page_faults - total_pool_faults - copies);
+
+  if (trace_filename != NULL || merge_mode_enabled) {
+    putchar('\n');
+    msg("--- Replay Stats ---");
+    msg("Trace Duration:    %11ld", trace_time);
+    msg("Clock Rounds:      %11d", current_round - 1);
+    msg("Avg Interarrival:  %11.2f",
+        total_requests > 1 ? trace_time / (double)(total_requests - 1) : 0.0);
+  }
+
+  if (spawn_count > 0 || exit_count > 0) {
+    putchar('\n');
+    msg("--- Process Lifecycle Stats ---");
+    msg("Spawns:            %11d", spawn_count);
+    msg("Exits:             %11d", exit_count);
+    msg("Frames Freed:      %11d", freed_frames_count);
+    msg("Frames Reused:     %11d", reused_frames_count);
+    msg("Avg Reuse Delay:   %11.2f rounds",
+        reused_frames_count > 0
+            ? total_reuse_delay / (double)reused_frames_count
+            : 0.0);
+    msg("Max Reuse Delay:   %11d rounds", max_reuse_delay);
+  }
+
+  if (load_control_enabled) {
+    // swapping whole processes out and prepaging them back in also costs page
+    // transfers, which must be counted to compare against a run without load
+    // control
+    putchar('\n');
+    msg("--- Load Control Stats ---");
+    msg("Total Rounds:      %11d", current_round - 1);
+    msg("Swapped Pages:     %11d", total_swapped_pages);
+    msg("Swapped Dirty:     %11d", total_swapped_dirty);
+    msg("Prepaged Pages:    %11d", total_prepaged);
+    msg("Prepaged Dirty:    %11d", total_prepaged_dirty);
+    msg("Swap In Rate:      %10.2f%%",
+        ((total_page_faults + total_prepaged) / (double)total_requests) * 100);
+    msg("Writeback Rate:    %10.2f%%",
+        ((total_modified_faults + total_swapped_dirty + total_prepaged_dirty) /
+         (double)total_requests) *
+            100);
+  }
 }
 
 int main(int argc, char **argv) {
   dmsg("vmem_sim started");
 
-  // parse command line args
-  if (!(argc == 3 || argc == 4)) {
-    fprintf(stderr, "Usage: ./vmem_sim <num_rounds> <page_algo> [<k_param>]\n");
+  // parse command line options
+  int opt;
+  while ((opt = getopt(argc, argv, "lecrT:p:H:zN:S:gwat:m")) != -1) {
+    switch (opt) {
+    case 'l':
+      load_control_enabled = true;
+      break;
+    case 'e':
+      event_mode_enabled = true;
+      break;
+    case 'c':
+      cleaner_enabled = true;
+      break;
+    case 'r':
+      readahead_enabled = true;
+      break;
+    case 'T':
+      if (strcasecmp(optarg, "private") == 0) {
+        tlb_mode = TLB_PRIVATE;
+      } else if (strcasecmp(optarg, "shared") == 0) {
+        tlb_mode = TLB_SHARED;
+      } else {
+        fprintf(stderr, "Error: Invalid TLB mode %s\n", optarg);
+        fprintf(stderr, USAGE);
+        exit(3);
+      }
+      break;
+    case 'p':
+      if (strcasecmp(optarg, "flat") == 0) {
+        pt_format = PT_FLAT;
+      } else if (strcasecmp(optarg, "radix") == 0) {
+        pt_format = PT_RADIX;
+      } else if (strcasecmp(optarg, "hashed") == 0) {
+        pt_format = PT_HASHED;
+      } else {
+        fprintf(stderr, "Error: Invalid page table format %s\n", optarg);
+        fprintf(stderr, USAGE);
+        exit(3);
+      }
+      break;
+    case 'H':
+      if (strcasecmp(optarg, "eager") == 0) {
+        huge_policy = HUGE_EAGER;
+      } else if (strcasecmp(optarg, "collapse") == 0) {
+        huge_policy = HUGE_COLLAPSE;
+      } else {
+        fprintf(stderr, "Error: Invalid huge page policy %s\n", optarg);
+        fprintf(stderr, USAGE);
+        exit(3);
+      }
+      // huge pages must tile both the address spaces and main memory
+      assert(HUGE_ORDER >= 1 && HUGE_ORDER <= 4);
+      assert(PROC_MAX_PAGES % HUGE_PAGES == 0);
+      assert(RAM_MAX_PAGES % HUGE_PAGES == 0);
+      break;
+    case 'z':
+      zswap_enabled = true;
+      break;
+    case 'N':
+      if (strcasecmp(optarg, "first-touch") == 0) {
+        numa_policy = NUMA_FIRST_TOUCH;
+      } else if (strcasecmp(optarg, "interleave") == 0) {
+        numa_policy = NUMA_INTERLEAVE;
+      } else if (strcasecmp(optarg, "preferred") == 0) {
+        numa_policy = NUMA_PREFERRED;
+      } else {
+        fprintf(stderr, "Error: Invalid NUMA placement policy %s\n", optarg);
+        fprintf(stderr, USAGE);
+        exit(3);
+      }
+      break;
+    case 'S':
+      swap_filename = optarg;
+      break;
+    case 'g':
+      cgroups_enabled = true;
+      break;
+    case 'w':
+      workingset_enabled = true;
+      break;
+    case 'a':
+      wscurve_enabled = true;
+      break;
+    case 't':
+      trace_filename = optarg;
+      break;
+    case 'm':
+      merge_mode_enabled = true;
+      break;
+    default:
+      fprintf(stderr, USAGE);
+      exit(3);
+    }
+  }
+
+  const bool replay_mode = trace_filename != NULL || merge_mode_enabled;
+  if (replay_mode && event_mode_enabled) {
+    fprintf(stderr, "Error: trace replay can't be used in event-driven mode\n");
+    exit(3);
+  } else if (trace_filename != NULL &&
+             (merge_mode_enabled || load_control_enabled)) {
+    // an interleaved trace can't delay a swapped out process' requests
+    fprintf(stderr, "Error: -t can't be used with -m or -l\n");
+    exit(3);
+  } else if (swap_filename != NULL && zswap_enabled) {
+    // pages compressed into the pool would need contents of their own
+    fprintf(stderr, "Error: -S can't be used with -z\n");
+    exit(3);
+  }
+
+  // remaining positional args
+  char **args = argv + optind;
+  const int num_args = argc - optind;
+
+  if (!(num_args == 2 || num_args == 3)) {
+    fprintf(stderr, USAGE);
     exit(3);
   }
 
   // one round represents one memory io request from each process,
   // so four requests total
-  const int num_rounds = atoi(argv[1]);
+  const int num_rounds = atoi(args[0]);
   assert(num_rounds > 0);
 
-  if (argc == 4) {
+  if (num_args == 3) {
     // set k parameter for working set
-    k_param = atoi(argv[3]);
+    k_param = atoi(args[2]);
     assert(k_param > 0);
     assert(k_param <= RAM_MAX_PAGES);
   }
 
   // parse selected paging algorithm
-  if (strcasecmp(argv[2], "nru") == 0) {
+  if (strcasecmp(args[1], "nru") == 0) {
     algorithm = ALGO_NRU;
     page_algo_func = page_algo_NRU;
-  } else if (strcasecmp(argv[2], "2ndc") == 0) {
+  } else if (strcasecmp(args[1], "2ndc") == 0) {
     algorithm = ALGO_2ndC;
     page_algo_func = page_algo_2ndC;
-  } else if (strcasecmp(argv[2], "lru") == 0) {
+  } else if (strcasecmp(args[1], "lru") == 0) {
     algorithm = ALGO_LRU;
     page_algo_func = page_algo_LRU;
-  } else if (strcasecmp(argv[2], "ws") == 0) {
+  } else if (strcasecmp(args[1], "cflru") == 0) {
+    algorithm = ALGO_CFLRU;
+    page_algo_func = page_algo_CFLRU;
+  } else if (strcasecmp(args[1], "lru-wc") == 0) {
+    algorithm = ALGO_LRU_WC;
+    page_algo_func = page_algo_LRU_WC;
+  } else if (strcasecmp(args[1], "2ndc-wc") == 0) {
+    algorithm = ALGO_2ndC_WC;
+    page_algo_func = page_algo_2ndC_WC;
+  } else if (strcasecmp(args[1], "arc") == 0) {
+    algorithm = ALGO_ARC;
+    page_algo_func = page_algo_ARC;
+  } else if (strcasecmp(args[1], "car") == 0) {
+    algorithm = ALGO_CAR;
+    page_algo_func = page_algo_CAR;
+  } else if (strcasecmp(args[1], "lirs") == 0) {
+    algorithm = ALGO_LIRS;
+    page_algo_func = page_algo_LIRS;
+  } else if (strcasecmp(args[1], "clock-pro") == 0) {
+    algorithm = ALGO_CLOCKPRO;
+    page_algo_func = page_algo_CLOCKPRO;
+  } else if (strcasecmp(args[1], "mglru") == 0) {
+    algorithm = ALGO_MGLRU;
+    page_algo_func = page_algo_MGLRU;
+  } else if (strcasecmp(args[1], "lfu") == 0) {
+    algorithm = ALGO_LFU;
+    page_algo_func = page_algo_LFU;
+  } else if (strcasecmp(args[1], "lrfu") == 0) {
+    algorithm = ALGO_LRFU;
+    page_algo_func = page_algo_LRFU;
+  } else if (strcasecmp(args[1], "duel") == 0 ||
+             strcasecmp(args[1], "adaptive") == 0) {
+    algorithm = ALGO_DUEL;
+    page_algo_func = page_algo_DUEL;
+  } else if (strcasecmp(args[1], "ws") == 0 ||
+             strcasecmp(args[1], "wsclock") == 0) {
     algorithm = ALGO_WS;
     page_algo_func = page_algo_WS;
 
-    if (argc != 4) {
-      fprintf(stderr, "Error: Working Set algorithm requires a k parameter\n");
-      fprintf(stderr,
-              "Usage: ./vmem_sim <num_rounds> <page_algo> [<k_param>]\n");
+    if (num_args != 3) {
+      fprintf(stderr, "Error: WSClock algorithm requires a k parameter\n");
+      fprintf(stderr, USAGE);
       exit(3);
     }
   } else {
-    fprintf(stderr, "Error: Invalid page algorithm %s\n", argv[2]);
-    fprintf(stderr, "Available algorithms: NRU, 2ndC, LRU, WS\n");
+    fprintf(stderr, "Error: Invalid page algorithm %s\n", args[1]);
+    fprintf(stderr, "Available algorithms: NRU, 2ndC, LRU, WS, CFLRU, LRU-WC, "
+                    "2ndC-WC, ARC, CAR, LIRS, CLOCK-Pro, MGLRU, LFU, LRFU, "
+                    "Duel\n");
     exit(4);
   }
 
@@ -688,39 +2734,44 @@ int main(int argc, char **argv) {
     exit(2);
   }
 
-  // spawn processes (P1, P2, P3, P4) simulator
-  pid_t procs_pid = fork();
-  if (procs_pid < 0) {
-    perror("Fork error");
-    exit(5);
-  } else if (procs_pid == 0) {
-    // child
-
-    // using environment variables to pass pipe fds and num rounds
-    char pipe_P1_read_str[12], pipe_P1_write_str[12], pipe_P2_read_str[12],
-        pipe_P2_write_str[12], pipe_P3_read_str[12], pipe_P3_write_str[12],
-        pipe_P4_read_str[12], pipe_P4_write_str[12], num_rounds_str[12];
-    sprintf(pipe_P1_read_str, "%d", pipe_P1[PIPE_READ]);
-    sprintf(pipe_P1_write_str, "%d", pipe_P1[PIPE_WRITE]);
-    sprintf(pipe_P2_read_str, "%d", pipe_P2[PIPE_READ]);
-    sprintf(pipe_P2_write_str, "%d", pipe_P2[PIPE_WRITE]);
-    sprintf(pipe_P3_read_str, "%d", pipe_P3[PIPE_READ]);
-    sprintf(pipe_P3_write_str, "%d", pipe_P3[PIPE_WRITE]);
-    sprintf(pipe_P4_read_str, "%d", pipe_P4[PIPE_READ]);
-    sprintf(pipe_P4_write_str, "%d", pipe_P4[PIPE_WRITE]);
-    sprintf(num_rounds_str, "%d", num_rounds);
-
-    setenv("PIPE_P1_READ", pipe_P1_read_str, 1);
-    setenv("PIPE_P1_WRITE", pipe_P1_write_str, 1);
-    setenv("PIPE_P2_READ", pipe_P2_read_str, 1);
-    setenv("PIPE_P2_WRITE", pipe_P2_write_str, 1);
-    setenv("PIPE_P3_READ", pipe_P3_read_str, 1);
-    setenv("PIPE_P3_WRITE", pipe_P3_write_str, 1);
-    setenv("PIPE_P4_READ", pipe_P4_read_str, 1);
-    setenv("PIPE_P4_WRITE", pipe_P4_write_str, 1);
-    setenv("NUM_ROUNDS", num_rounds_str, 1);
-
-    execl("./procs_sim", "procs_sim", NULL);
+  // spawn processes (P1, P2, P3, P4) simulator, unless replaying an
+  // interleaved trace, which already holds the requests of every process
+  if (trace_filename == NULL) {
+    pid_t procs_pid = fork();
+    if (procs_pid < 0) {
+      perror("Fork error");
+      exit(5);
+    } else if (procs_pid == 0) {
+      // child
+
+      // using environment variables to pass pipe fds and num rounds
+      char pipe_P1_read_str[12], pipe_P1_write_str[12], pipe_P2_read_str[12],
+          pipe_P2_write_str[12], pipe_P3_read_str[12], pipe_P3_write_str[12],
+          pipe_P4_read_str[12], pipe_P4_write_str[12], num_rounds_str[12];
+      sprintf(pipe_P1_read_str, "%d", pipe_P1[PIPE_READ]);
+      sprintf(pipe_P1_write_str, "%d", pipe_P1[PIPE_WRITE]);
+      sprintf(pipe_P2_read_str, "%d", pipe_P2[PIPE_READ]);
+      sprintf(pipe_P2_write_str, "%d", pipe_P2[PIPE_WRITE]);
+      sprintf(pipe_P3_read_str, "%d", pipe_P3[PIPE_READ]);
+      sprintf(pipe_P3_write_str, "%d", pipe_P3[PIPE_WRITE]);
+      sprintf(pipe_P4_read_str, "%d", pipe_P4[PIPE_READ]);
+      sprintf(pipe_P4_write_str, "%d", pipe_P4[PIPE_WRITE]);
+      sprintf(num_rounds_str, "%d", num_rounds);
+
+      setenv("PIPE_P1_READ", pipe_P1_read_str, 1);
+      setenv("PIPE_P1_WRITE", pipe_P1_write_str, 1);
+      setenv("PIPE_P2_READ", pipe_P2_read_str, 1);
+      setenv("PIPE_P2_WRITE", pipe_P2_write_str, 1);
+      setenv("PIPE_P3_READ", pipe_P3_read_str, 1);
+      setenv("PIPE_P3_WRITE", pipe_P3_write_str, 1);
+      setenv("PIPE_P4_READ", pipe_P4_read_str, 1);
+      setenv("PIPE_P4_WRITE", pipe_P4_write_str, 1);
+      setenv("NUM_ROUNDS", num_rounds_str, 1);
+      if (merge_mode_enabled)
+        setenv("TIMESTAMPED", "1", 1);
+
+      execl("./procs_sim", "procs_sim", NULL);
+    }
   }
 
   // close pipe writes, as we will only be reading here
@@ -730,6 +2781,8 @@ int main(int argc, char **argv) {
   close(pipe_P4[PIPE_WRITE]);
 
   init_page_data();
+  if (swap_filename != NULL)
+    swapfile_open(swap_filename);
 
   if (algorithm == ALGO_WS) {
     msg("--- Simulating %d rounds using %s with k=%d, clear/shift every %d "
@@ -739,69 +2792,34 @@ int main(int argc, char **argv) {
     msg("--- Simulating %d rounds using %s, clear/shift every %d rounds ---",
         num_rounds, PAGE_ALGO_STR[algorithm], REF_CLEAR_INTERVAL);
   }
+  msg("--- Load control %s ---", load_control_enabled ? "enabled" : "disabled");
+  if (trace_filename != NULL) {
+    msg("--- Replaying interleaved trace %s ---", trace_filename);
+  } else if (merge_mode_enabled) {
+    msg("--- Replaying timestamped pagelists ---");
+  }
+  if (swap_filename != NULL)
+    msg("--- Swapping page contents to %s ---", swap_filename);
+  if (event_mode_enabled) {
+    msg("--- Event-driven mode, swap in %d, writeback %d, swap queue depth %d "
+        "---",
+        EVENT_SWAP_IN_TIME, EVENT_WRITEBACK_TIME, EVENT_SWAP_QUEUE_DEPTH);
+  }
 
   // track elapsed time
   struct timespec start, end;
   clock_gettime(CLOCK_MONOTONIC, &start);
 
-  // main loop, post sem and read memory io requests from processes'
-  // pipes. each iteration is a round, meaning one IO request from each
-  // process
-  for (int i = 1; i <= num_rounds; i++) {
-    vmem_io_request_t req;
-
-    // Process 1
-    sem_post(sem_P1);
-
-    if (read(pipe_P1[PIPE_READ], &req, sizeof(req)) == -1) {
-      perror("Pipe read error");
-      exit(9);
-    }
-    handle_vmem_io_request(req);
-
-    // Process 2
-    sem_post(sem_P2);
-
-    if (read(pipe_P2[PIPE_READ], &req, sizeof(req)) == -1) {
-      perror("Pipe read error");
-      exit(9);
-    }
-    handle_vmem_io_request(req);
-
-    // Process 3
-    sem_post(sem_P3);
-
-    if (read(pipe_P3[PIPE_READ], &req, sizeof(req)) == -1) {
-      perror("Pipe read error");
-      exit(9);
-    }
-    handle_vmem_io_request(req);
+  sem_t *sems[] = {sem_P1, sem_P2, sem_P3, sem_P4};
+  const int pipe_reads[] = {pipe_P1[PIPE_READ], pipe_P2[PIPE_READ],
+                            pipe_P3[PIPE_READ], pipe_P4[PIPE_READ]};
 
-    // Process 4
-    sem_post(sem_P4);
-
-    if (read(pipe_P4[PIPE_READ], &req, sizeof(req)) == -1) {
-      perror("Pipe read error");
-      exit(9);
-    }
-    handle_vmem_io_request(req);
-
-    if (algorithm == ALGO_LRU) {
-      // shift aging bits after each round, and clear ref bits
-      shift_aging_bits();
-      clear_ref_bits();
-    } else if (i % REF_CLEAR_INTERVAL == 0 && algorithm != ALGO_2ndC) {
-      // periodically clear reference bits
-      clear_ref_bits();
-    }
-
-    if (algorithm == ALGO_WS) {
-      // update working sets and increment global clock counter
-      update_working_sets();
-      clock_counter++;
-    }
-
-    dmsg("vmem_sim finished round %d", i);
+  if (event_mode_enabled) {
+    run_event_simulation(sems, pipe_reads, num_rounds);
+  } else if (replay_mode) {
+    run_replay_simulation(sems, pipe_reads, num_rounds);
+  } else {
+    run_round_robin_simulation(sems, pipe_reads, num_rounds);
   }
 
   // print results
@@ -809,6 +2827,8 @@ int main(int argc, char **argv) {
   double elapsed_time_ms = (end.tv_sec - start.tv_sec) * 1000.0 +
                            (end.tv_nsec - start.tv_nsec) / 1e6;
   msg("--- Simulation finished after %dms ---", (int)(elapsed_time_ms));
+  if (swap_filename != NULL)
+    swapfile_close();
 
   print_page_tables();
   print_stats();
@@ -835,18 +2855,13 @@ int main(int argc, char **argv) {
   unsetenv("PIPE_P4_READ");
   unsetenv("PIPE_P4_WRITE");
   unsetenv("NUM_ROUNDS");
-  if (algorithm == ALGO_2ndC) {
+  unsetenv("TIMESTAMPED");
+  if (algo_uses_queue()) {
     free_queue(page_queue_P1);
     free_queue(page_queue_P2);
     free_queue(page_queue_P3);
     free_queue(page_queue_P4);
   }
-  if (algorithm == ALGO_WS) {
-    free_set(page_wset_P1);
-    free_set(page_wset_P2);
-    free_set(page_wset_P3);
-    free_set(page_wset_P4);
-  }
 
   dmsg("vmem_sim finished");
 
@@ -0,0 +1,597 @@
+#include "vmem_swapfile.h"
+#include "types.h"
+#include "util.h"
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+// documentation is provided in vmem_swapfile.h
+
+// pages of the arena: one per page frame, and a copy of every page being
+// written out, for both halves of the request queue
+#define ARENA_PAGES (RAM_MAX_PAGES + 2 * SWAPFILE_BATCH)
+
+static const char *path;
+static int fd = -1;
+// contents of every page frame, and copies of the pages being written out
+static uint8_t *arena;
+static uint8_t *bounce;
+// swap slot of every page of every process, -1 if it was never written out
+static int slot_of[4][PROC_MAX_PAGES];
+// free swap slots, as a stack, and the sequence number of each slot's latest
+// write
+static int free_slots[SWAPFILE_SLOTS];
+static int free_count;
+static uint32_t slot_seq[SWAPFILE_SLOTS];
+static uint32_t write_seq;
+// writes to every page of every process, stamped in its contents
+static uint32_t versions[4][PROC_MAX_PAGES];
+
+// io requests. one half of the queue takes new requests while the batch in the
+// other half is in flight. the frames and slots they touch can't be used again
+// until they're done
+static swapfile_io_t requests[2][SWAPFILE_BATCH];
+static int queued_half;   // half of the queue taking new requests
+static int queued;        // requests queued in it so far
+static int inflight;      // requests of the batch in flight, 0 if none
+static long submitted_at; // time the batch in flight was submitted
+static bool frame_pending[RAM_MAX_PAGES];
+static bool slot_pending[SWAPFILE_SLOTS];
+
+// io_uring instance serving the batches, if SWAPFILE_URING is set and the
+// kernel allows it: the submission and completion rings and the submission
+// entries, mapped from the kernel, and the buffer of every request
+static bool uring;
+static int ring_fd = -1;
+static void *sq_ring = MAP_FAILED;
+static void *cq_ring = MAP_FAILED;
+static struct io_uring_sqe *sqes = MAP_FAILED;
+static size_t sq_ring_size, cq_ring_size, sqes_size;
+static unsigned *sq_tail, *sq_mask, *sq_array;
+static unsigned *cq_head, *cq_tail, *cq_mask;
+static struct io_uring_cqe *cqes;
+static struct iovec iovecs[2 * SWAPFILE_BATCH];
+static int reaped; // requests of the batch in flight completed so far
+
+// worker threads otherwise, serving the requests of the batch in flight in any
+// order
+static pthread_t workers[SWAPFILE_THREADS];
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t submitted = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t completed = PTHREAD_COND_INITIALIZER;
+static swapfile_io_t *serving; // batch in flight
+static int serving_len;        // requests in it
+static int next_request;       // next request of the batch to be taken
+static int done_count;         // requests of the batch completed so far
+static bool stopping;          // whether the workers must exit
+
+// swap file stats
+static long reads;
+static long writes;
+static long zero_fills;      // faults on pages never written out
+static long batches;         // batches submitted
+static long read_time;       // latency of every read, summed, in nanoseconds
+static long write_time;      // latency of every write, summed, in nanoseconds
+static long wait_time;       // wall time the simulation stalled on batches
+static long busy_time;       // wall time batches were in flight
+static long read_hist[SWAPFILE_HIST_BUCKETS];
+static long write_hist[SWAPFILE_HIST_BUCKETS];
+static int peak_slots;       // most swap slots in use at once
+static int verify_errors;    // pages read back with unexpected contents
+
+// get the current time of the monotonic clock, in nanoseconds
+static long now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+// get the contents of a page frame
+static inline uint8_t *get_frame(const int page_frame) {
+  assert(page_frame >= 0 && page_frame < RAM_MAX_PAGES);
+  return arena + (long)page_frame * SWAPFILE_PAGE_SIZE;
+}
+
+// get the histogram bucket of a latency: under 1us, under 2us, under 4us, and
+// so on, the last one holding everything slower
+static int get_bucket(const long latency) {
+  int bucket = 0;
+  for (long us = latency / 1000; us > 0 && bucket < SWAPFILE_HIST_BUCKETS - 1;
+       us >>= 1) {
+    bucket++;
+  }
+
+  return bucket;
+}
+
+// exit on an io error of a request
+static void io_failed(const swapfile_io_t *io) {
+  fprintf(stderr, "Error: swap file %s failed on slot %d\n",
+          io->write ? "write" : "read", io->slot);
+  exit(6);
+}
+
+// serve a single io request with pread or pwrite, exiting on an io error
+static void serve(swapfile_io_t *io) {
+  const off_t offset = (off_t)io->slot * SWAPFILE_PAGE_SIZE;
+  io->start = now();
+  const ssize_t size = io->write
+                           ? pwrite(fd, io->buf, SWAPFILE_PAGE_SIZE, offset)
+                           : pread(fd, io->buf, SWAPFILE_PAGE_SIZE, offset);
+
+  if (size != SWAPFILE_PAGE_SIZE)
+    io_failed(io);
+  io->latency = now() - io->start;
+}
+
+// worker thread, taking requests of the batch in flight until it's done
+static void *worker(void *arg) {
+  (void)arg;
+  pthread_mutex_lock(&lock);
+
+  while (true) {
+    while (!stopping && next_request == serving_len) {
+      pthread_cond_wait(&submitted, &lock);
+    }
+    if (stopping)
+      break;
+
+    swapfile_io_t *io = &serving[next_request++];
+    pthread_mutex_unlock(&lock);
+    serve(io);
+    pthread_mutex_lock(&lock);
+
+    if (++done_count == serving_len)
+      pthread_cond_signal(&completed);
+  }
+
+  pthread_mutex_unlock(&lock);
+  return NULL;
+}
+
+// unmap the rings of the io_uring instance and close it
+static void uring_close(void) {
+  if (sqes != MAP_FAILED)
+    munmap(sqes, sqes_size);
+  if (cq_ring != MAP_FAILED && cq_ring != sq_ring)
+    munmap(cq_ring, cq_ring_size);
+  if (sq_ring != MAP_FAILED)
+    munmap(sq_ring, sq_ring_size);
+  close(ring_fd);
+  ring_fd = -1;
+}
+
+// set up an io_uring instance with room for a batch, through the raw system
+// calls, and map its rings. returns whether it succeeded, the kernel may not
+// support io_uring or may have it disabled
+static bool uring_setup(void) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd = (int)syscall(__NR_io_uring_setup, SWAPFILE_BATCH, &params);
+  if (ring_fd < 0)
+    return false;
+
+  sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  // newer kernels map both rings at once
+  const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap && cq_ring_size > sq_ring_size)
+    sq_ring_size = cq_ring_size;
+
+  sq_ring = mmap(NULL, sq_ring_size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  cq_ring = single_mmap ? sq_ring
+                        : mmap(NULL, cq_ring_size, PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_POPULATE, ring_fd,
+                               IORING_OFF_CQ_RING);
+  sqes = mmap(NULL, sqes_size, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (sq_ring == MAP_FAILED || cq_ring == MAP_FAILED || sqes == MAP_FAILED) {
+    uring_close();
+    return false;
+  }
+
+  sq_tail = (unsigned *)((char *)sq_ring + params.sq_off.tail);
+  sq_mask = (unsigned *)((char *)sq_ring + params.sq_off.ring_mask);
+  sq_array = (unsigned *)((char *)sq_ring + params.sq_off.array);
+  cq_head = (unsigned *)((char *)cq_ring + params.cq_off.head);
+  cq_tail = (unsigned *)((char *)cq_ring + params.cq_off.tail);
+  cq_mask = (unsigned *)((char *)cq_ring + params.cq_off.ring_mask);
+  cqes = (struct io_uring_cqe *)((char *)cq_ring + params.cq_off.cqes);
+  return true;
+}
+
+// submit requests to the io_uring instance and/or wait for completions,
+// exiting if it fails
+static void uring_enter(const unsigned to_submit, const unsigned min_complete,
+                        const unsigned flags) {
+  long submitted_count;
+  do {
+    submitted_count = syscall(__NR_io_uring_enter, ring_fd, to_submit,
+                              min_complete, flags, NULL, 0);
+  } while (submitted_count == -1 && errno == EINTR);
+
+  if (submitted_count != (long)to_submit) {
+    fprintf(stderr, "Error: swap file io_uring_enter failed\n");
+    exit(6);
+  }
+}
+
+// submit a batch to the io_uring instance, as vectored reads and writes, which
+// every kernel with io_uring supports
+static void uring_submit(swapfile_io_t *batch, const int len) {
+  unsigned tail = *sq_tail;
+  const long start = now();
+
+  for (int i = 0; i < len; i++) {
+    const unsigned index = tail++ & *sq_mask;
+    struct io_uring_sqe *sqe = &sqes[index];
+    struct iovec *iov = &iovecs[&batch[i] - requests[0]];
+
+    *iov = (struct iovec){batch[i].buf, SWAPFILE_PAGE_SIZE};
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = batch[i].write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)iov;
+    sqe->len = 1;
+    sqe->off = (uint64_t)batch[i].slot * SWAPFILE_PAGE_SIZE;
+    sqe->user_data = (uint64_t)i;
+    sq_array[index] = index;
+    batch[i].start = start;
+  }
+
+  reaped = 0;
+  // the kernel must see the entries before the new tail
+  __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+  uring_enter(len, 0, 0);
+}
+
+// take the completions of the batch in flight posted so far, stamping their
+// latencies, and with wait, block until the whole batch is done. latencies are
+// only as precise as how soon the completions are looked at
+static void uring_reap(swapfile_io_t *batch, const bool wait) {
+  while (true) {
+    unsigned head = *cq_head;
+    const unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+
+    if (head != tail) {
+      const long end = now();
+      for (; head != tail; head++) {
+        const struct io_uring_cqe *cqe = &cqes[head & *cq_mask];
+        swapfile_io_t *io = &batch[cqe->user_data];
+
+        if (cqe->res != SWAPFILE_PAGE_SIZE)
+          io_failed(io);
+        io->latency = end - io->start;
+        reaped++;
+      }
+      __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    if (!wait || reaped == inflight)
+      return;
+    uring_enter(0, 1, IORING_ENTER_GETEVENTS);
+  }
+}
+
+// wait for the batch in flight, if any, and account for its requests
+static void wait_inflight(void) {
+  if (inflight == 0)
+    return;
+
+  swapfile_io_t *batch = requests[queued_half ^ 1];
+  const long start = now();
+  if (uring) {
+    uring_reap(batch, true);
+  } else {
+    pthread_mutex_lock(&lock);
+    while (done_count < serving_len) {
+      pthread_cond_wait(&completed, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+  }
+  wait_time += now() - start;
+
+  long last_end = submitted_at;
+  for (int i = 0; i < inflight; i++) {
+    const swapfile_io_t *io = &batch[i];
+    slot_pending[io->slot] = false;
+    if (io->start + io->latency > last_end)
+      last_end = io->start + io->latency;
+
+    if (io->write) {
+      writes++;
+      write_time += io->latency;
+      write_hist[get_bucket(io->latency)]++;
+      continue;
+    }
+
+    reads++;
+    read_time += io->latency;
+    read_hist[get_bucket(io->latency)]++;
+    frame_pending[io->frame] = false;
+
+    if (memcmp(io->buf, &io->expected, sizeof(swapfile_header_t)) != 0) {
+      verify_errors++;
+      dmsg("Swap file: unexpected contents in slot %d", io->slot);
+    }
+  }
+
+  busy_time += last_end - submitted_at;
+  inflight = 0;
+}
+
+// submit the queued requests as a batch, once the previous one is done, and
+// have new requests queued in the other half while it's in flight
+static void submit_queued(void) {
+  wait_inflight();
+  if (queued == 0)
+    return;
+
+  swapfile_io_t *batch = requests[queued_half];
+  submitted_at = now();
+  inflight = queued;
+  if (uring) {
+    uring_submit(batch, queued);
+  } else {
+    pthread_mutex_lock(&lock);
+    serving = batch;
+    serving_len = queued;
+    next_request = 0;
+    done_count = 0;
+    pthread_cond_broadcast(&submitted);
+    pthread_mutex_unlock(&lock);
+  }
+
+  batches++;
+  queued_half ^= 1;
+  queued = 0;
+}
+
+// take a free swap slot
+static int alloc_slot(void) {
+  // there's a slot for every page of every process
+  assert(free_count > 0);
+  const int slot = free_slots[--free_count];
+
+  if (SWAPFILE_SLOTS - free_count > peak_slots)
+    peak_slots = SWAPFILE_SLOTS - free_count;
+  return slot;
+}
+
+// queue an io request, submitting the queued batch first if it's full
+static swapfile_io_t *queue_io(void) {
+  // stamp the completions posted since the last look
+  if (uring && inflight > 0)
+    uring_reap(requests[queued_half ^ 1], false);
+  if (queued == SWAPFILE_BATCH)
+    submit_queued();
+
+  return &requests[queued_half][queued++];
+}
+
+void swapfile_open(const char *filename) {
+  assert(SWAPFILE_PAGE_SIZE >= (int)sizeof(swapfile_header_t));
+  // the file is removed on close, so it must be one we created ourselves
+  const int flags = O_RDWR | O_CREAT | O_EXCL | (SWAPFILE_SYNC ? O_DSYNC : 0);
+
+  path = filename;
+  fd = open(filename, flags, 0600);
+  if (fd == -1) {
+    if (errno == EEXIST)
+      fprintf(stderr, "Error: swap file %s already exists\n", filename);
+    else
+      fprintf(stderr, "Error: can't create swap file %s\n", filename);
+    exit(6);
+  }
+  if (ftruncate(fd, (off_t)SWAPFILE_SLOTS * SWAPFILE_PAGE_SIZE)) {
+    fprintf(stderr, "Error: can't create swap file %s\n", filename);
+    unlink(filename);
+    exit(6);
+  }
+
+  arena = mmap(NULL, (size_t)ARENA_PAGES * SWAPFILE_PAGE_SIZE,
+               PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (arena == MAP_FAILED) {
+    fprintf(stderr, "Error: can't map the page frame arena\n");
+    exit(6);
+  }
+  bounce = arena + (long)RAM_MAX_PAGES * SWAPFILE_PAGE_SIZE;
+
+  for (int p = 0; p < 4; p++) {
+    for (int i = 0; i < PROC_MAX_PAGES; i++) {
+      slot_of[p][i] = -1;
+      versions[p][i] = 0;
+    }
+  }
+  // lower slots are taken first, keeping the file dense
+  for (int i = 0; i < SWAPFILE_SLOTS; i++) {
+    free_slots[i] = SWAPFILE_SLOTS - 1 - i;
+  }
+  free_count = SWAPFILE_SLOTS;
+
+  uring = SWAPFILE_URING && uring_setup();
+  for (int i = 0; !uring && i < SWAPFILE_THREADS; i++) {
+    if (pthread_create(&workers[i], NULL, worker, NULL) != 0) {
+      fprintf(stderr, "Error: can't start swap file io threads\n");
+      exit(6);
+    }
+  }
+
+  if (uring)
+    dmsg("Swap file: %s, %d slots, io_uring", filename, SWAPFILE_SLOTS);
+  else
+    dmsg("Swap file: %s, %d slots, %d io threads", filename, SWAPFILE_SLOTS,
+         SWAPFILE_THREADS);
+}
+
+void swapfile_close(void) {
+  swapfile_flush();
+
+  if (uring) {
+    uring_close();
+  } else {
+    pthread_mutex_lock(&lock);
+    stopping = true;
+    pthread_cond_broadcast(&submitted);
+    pthread_mutex_unlock(&lock);
+    for (int i = 0; i < SWAPFILE_THREADS; i++) {
+      pthread_join(workers[i], NULL);
+    }
+  }
+
+  munmap(arena, (size_t)ARENA_PAGES * SWAPFILE_PAGE_SIZE);
+  close(fd);
+  unlink(path);
+}
+
+void swapfile_touch(const int proc_id, const int proc_page_id,
+                    const int page_frame) {
+  if (frame_pending[page_frame])
+    swapfile_flush();
+
+  uint8_t *contents = get_frame(page_frame);
+  const uint32_t version = ++versions[proc_id - 1][proc_page_id];
+  // every version of a page fills it with a different byte
+  memset(contents, (proc_id * PROC_MAX_PAGES + proc_page_id + version) & 0xff,
+         SWAPFILE_PAGE_SIZE);
+  *(swapfile_header_t *)contents =
+      (swapfile_header_t){proc_id, proc_page_id, version, 0};
+}
+
+void swapfile_write(const int proc_id, const int proc_page_id,
+                    const int page_frame) {
+  int *slot = &slot_of[proc_id - 1][proc_page_id];
+
+  if (frame_pending[page_frame] || (*slot != -1 && slot_pending[*slot]))
+    swapfile_flush();
+  if (*slot == -1)
+    *slot = alloc_slot();
+
+  swapfile_io_t *io = queue_io();
+  uint8_t *contents = get_frame(page_frame);
+  swapfile_header_t *header = (swapfile_header_t *)contents;
+
+  // the page may not have been written to since it was zero filled
+  *header = (swapfile_header_t){proc_id, proc_page_id,
+                                versions[proc_id - 1][proc_page_id],
+                                ++write_seq};
+  slot_seq[*slot] = write_seq;
+  slot_pending[*slot] = true;
+
+  uint8_t *copy = bounce + (long)(io - requests[0]) * SWAPFILE_PAGE_SIZE;
+  *io = (swapfile_io_t){true, *slot, -1, copy, 0, 0, *header};
+  memcpy(io->buf, contents, SWAPFILE_PAGE_SIZE);
+}
+
+void swapfile_read(const int proc_id, const int proc_page_id,
+                   const int page_frame) {
+  const int slot = slot_of[proc_id - 1][proc_page_id];
+
+  if (frame_pending[page_frame] || (slot != -1 && slot_pending[slot]))
+    swapfile_flush();
+
+  if (slot == -1) {
+    memset(get_frame(page_frame), 0, SWAPFILE_PAGE_SIZE);
+    zero_fills++;
+    return;
+  }
+
+  swapfile_io_t *io = queue_io();
+  *io = (swapfile_io_t){false, slot, page_frame, get_frame(page_frame), 0, 0,
+                        (swapfile_header_t){proc_id, proc_page_id,
+                                            versions[proc_id - 1][proc_page_id],
+                                            slot_seq[slot]}};
+  frame_pending[page_frame] = true;
+  slot_pending[slot] = true;
+}
+
+void swapfile_exchange(const int frame_a, const int frame_b) {
+  static uint8_t tmp[SWAPFILE_PAGE_SIZE];
+
+  if (frame_pending[frame_a] || frame_pending[frame_b])
+    swapfile_flush();
+
+  memcpy(tmp, get_frame(frame_a), SWAPFILE_PAGE_SIZE);
+  memcpy(get_frame(frame_a), get_frame(frame_b), SWAPFILE_PAGE_SIZE);
+  memcpy(get_frame(frame_b), tmp, SWAPFILE_PAGE_SIZE);
+}
+
+void swapfile_release(const int proc_id) {
+  // queued writes of the process' pages still point to its slots
+  swapfile_flush();
+
+  for (int page = 0; page < PROC_MAX_PAGES; page++) {
+    if (slot_of[proc_id - 1][page] != -1)
+      free_slots[free_count++] = slot_of[proc_id - 1][page];
+
+    slot_of[proc_id - 1][page] = -1;
+    versions[proc_id - 1][page] = 0;
+  }
+}
+
+void swapfile_flush(void) {
+  submit_queued();
+  wait_inflight();
+}
+
+void swapfile_print_stats(void) {
+  const long bytes = (reads + writes) * SWAPFILE_PAGE_SIZE;
+  const double read_lat = reads > 0 ? read_time / (double)reads / 1000 : 0.0;
+  const double write_lat =
+      writes > 0 ? write_time / (double)writes / 1000 : 0.0;
+
+  putchar('\n');
+  msg("--- Swap File Stats ---");
+  msg("Swap File:         %11s", path);
+  msg("IO Backend:        %11s", uring ? "io_uring" : "threads");
+  if (!uring)
+    msg("IO Threads:        %11d", SWAPFILE_THREADS);
+  msg("Peak Slots Used:   %11d", peak_slots);
+  msg("Pages Read:        %11ld", reads);
+  msg("Pages Written:     %11ld", writes);
+  msg("Zero Fills:        %11ld", zero_fills);
+  msg("Batches:           %11ld", batches);
+  msg("Avg Batch Size:    %11.2f",
+      batches > 0 ? (reads + writes) / (double)batches : 0.0);
+  msg("Verify Errors:     %11d", verify_errors);
+  // the simulation only stalls on a batch still in flight when it needs the
+  // queue's other half, or a frame or slot the batch touches
+  msg("Stall Time:        %11.2f ms", wait_time / 1e6);
+  // bytes moved over the wall time batches were in flight, with the requests
+  // of a batch overlapping
+  msg("Throughput:        %11.2f MB/s",
+      busy_time > 0 ? bytes / (busy_time / 1e9) / 1e6 : 0.0);
+  msg("Avg Read Latency:  %11.2f us", read_lat);
+  msg("Avg Write Latency: %11.2f us", write_lat);
+  // measured counterpart of WRITE_COST_FACTOR, the cost of a writeback
+  // relative to a read
+  msg("Write/Read Cost:   %11.2f (simulated %d)",
+      read_lat > 0 ? write_lat / read_lat : 0.0, WRITE_COST_FACTOR);
+
+  msg("Latency (us)       Reads     Writes");
+  for (int b = 0; b < SWAPFILE_HIST_BUCKETS; b++) {
+    if (read_hist[b] == 0 && write_hist[b] == 0)
+      continue;
+
+    if (b == SWAPFILE_HIST_BUCKETS - 1)
+      msg("  >= %-8ld %10ld %10ld", 1L << (b - 1), read_hist[b],
+          write_hist[b]);
+    else
+      msg("  <  %-8ld %10ld %10ld", 1L << b, read_hist[b], write_hist[b]);
+  }
+}
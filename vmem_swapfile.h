@@ -0,0 +1,41 @@
+#pragma once
+
+#include "types.h"
+#include <stdbool.h>
+
+// create the swap file at the given path, which must not exist yet, map the
+// page frame arena and set up the io_uring instance, or start the io worker
+// threads. exits with code 6 if any of them fails
+void swapfile_open(const char *filename);
+
+// wait for the queued io, close the io_uring instance or stop the worker
+// threads, and remove the swap file
+void swapfile_close(void);
+
+// fill the contents of a page held by a page frame, on a write to it
+void swapfile_touch(const int proc_id, const int proc_page_id,
+                    const int page_frame);
+
+// queue the write of a modified page's contents, held by a page frame, to its
+// swap slot, allocating one if it has none yet
+void swapfile_write(const int proc_id, const int proc_page_id,
+                    const int page_frame);
+
+// queue the read of a page's contents from its swap slot into the page frame
+// it's being loaded into, or zero the frame if the page was never written out
+void swapfile_read(const int proc_id, const int proc_page_id,
+                   const int page_frame);
+
+// swap the contents of two page frames, along with the pages they hold
+void swapfile_exchange(const int frame_a, const int frame_b);
+
+// free the swap slots of an exiting process' pages
+void swapfile_release(const int proc_id);
+
+// submit the queued io and wait for it and the batch in flight to complete,
+// checking the contents read back
+void swapfile_flush(void);
+
+// print the measured throughput and latency histograms of the swap file io,
+// and the write/read latency ratio next to the simulated WRITE_COST_FACTOR
+void swapfile_print_stats(void);
@@ -0,0 +1,207 @@
+#include "vmem_tlb.h"
+#include "types.h"
+#include "util.h"
+#include "vmem_helpers.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// documentation is provided in vmem_tlb.h
+
+extern tlb_mode_t tlb_mode;
+extern huge_policy_t huge_policy;
+
+// every TLB entry. private TLBs take TLB_ENTRIES / 4 consecutive entries each,
+// and sets take TLB_WAYS consecutive entries within their TLB
+static tlb_entry_t entries[TLB_ENTRIES];
+// lookups done so far, used as the LRU clock
+static long lookup_count;
+// pages mapped by the valid entries, and its sum over every lookup
+static int reach;
+static long reach_sum;
+// TLB stats of each process
+static long hits[4];
+static long huge_hits[4]; // hits on huge page entries
+static long misses[4];
+static long replacements[4]; // valid entries replaced by a fill
+static long shootdowns[4];   // cached translations dropped on eviction
+
+// get the amount of sets of each TLB
+static inline int get_set_count(void) {
+  const int tlb_entries =
+      tlb_mode == TLB_PRIVATE ? TLB_ENTRIES / 4 : TLB_ENTRIES;
+  return tlb_entries / TLB_WAYS;
+}
+
+// get the first way of the set that may cache the translation of a page, or of
+// a huge page region
+static tlb_entry_t *get_set(const int proc_id, const int tag) {
+  assert(tlb_mode != TLB_OFF);
+
+  if (proc_id < 1 || proc_id > 4) {
+    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
+    exit(10);
+  }
+
+  const int sets = get_set_count();
+
+  if (tlb_mode == TLB_PRIVATE) {
+    const int base = (proc_id - 1) * (TLB_ENTRIES / 4);
+    return &entries[base + (tag % sets) * TLB_WAYS];
+  }
+
+  // skew the index by the ASID, so that the same page of different processes
+  // doesn't always compete for the same set
+  return &entries[((tag + proc_id - 1) % sets) * TLB_WAYS];
+}
+
+// find the entry caching the translation of a page, or of the huge page holding
+// it, NULL if there's none
+static tlb_entry_t *find_entry(const int proc_id, const int proc_page_id,
+                               const bool huge) {
+  const int tag = huge ? proc_page_id >> HUGE_ORDER : proc_page_id;
+  tlb_entry_t *set = get_set(proc_id, tag);
+
+  for (int w = 0; w < TLB_WAYS; w++) {
+    if (set[w].valid && set[w].huge == huge && set[w].asid == proc_id &&
+        set[w].page_id == tag)
+      return &set[w];
+  }
+
+  return NULL;
+}
+
+// drop an entry, updating the reach
+static void invalidate(tlb_entry_t *entry) {
+  reach -= entry->huge ? HUGE_PAGES : 1;
+  entry->valid = false;
+}
+
+void tlb_init(void) {
+  assert(tlb_mode != TLB_OFF);
+  assert(TLB_ENTRIES % (4 * TLB_WAYS) == 0);
+
+  lookup_count = 0;
+  reach = 0;
+  reach_sum = 0;
+
+  for (int i = 0; i < TLB_ENTRIES; i++) {
+    entries[i] = (tlb_entry_t){0};
+  }
+  for (int p = 0; p < 4; p++) {
+    hits[p] = 0;
+    huge_hits[p] = 0;
+    misses[p] = 0;
+    replacements[p] = 0;
+    shootdowns[p] = 0;
+  }
+}
+
+bool tlb_lookup(const int proc_id, const int proc_page_id) {
+  tlb_entry_t *entry = find_entry(proc_id, proc_page_id, false);
+  lookup_count++;
+  reach_sum += reach;
+
+  if (entry == NULL && huge_policy != HUGE_OFF) {
+    entry = find_entry(proc_id, proc_page_id, true);
+    if (entry != NULL)
+      huge_hits[proc_id - 1]++;
+  }
+
+  if (entry == NULL) {
+    misses[proc_id - 1]++;
+    return false;
+  }
+
+  entry->last_use = lookup_count;
+  hits[proc_id - 1]++;
+  return true;
+}
+
+void tlb_fill(const int proc_id, const int proc_page_id) {
+  const bool huge = in_huge_page(proc_id, proc_page_id);
+  assert(find_entry(proc_id, proc_page_id, huge) == NULL);
+  const int tag = huge ? proc_page_id >> HUGE_ORDER : proc_page_id;
+  tlb_entry_t *set = get_set(proc_id, tag);
+  tlb_entry_t *victim = &set[0];
+
+  // take a free way if there's one, otherwise the least recently used one
+  for (int w = 0; w < TLB_WAYS && victim->valid; w++) {
+    if (!set[w].valid || set[w].last_use < victim->last_use)
+      victim = &set[w];
+  }
+
+  if (victim->valid) {
+    replacements[victim->asid - 1]++;
+    dmsg("TLB P%d: %s %02d replaced by P%d page %02d", victim->asid,
+         victim->huge ? "huge page" : "page", victim->page_id, proc_id,
+         proc_page_id);
+    invalidate(victim);
+  }
+
+  *victim = (tlb_entry_t){.valid = true,
+                          .huge = huge,
+                          .asid = proc_id,
+                          .page_id = tag,
+                          .last_use = lookup_count};
+  reach += huge ? HUGE_PAGES : 1;
+}
+
+void tlb_shootdown(const int proc_id, const int proc_page_id) {
+  // the page may be mapped by its own entry, or by the entry of a huge page
+  // that's being split
+  for (int huge = 0; huge <= 1; huge++) {
+    tlb_entry_t *entry = find_entry(proc_id, proc_page_id, huge);
+
+    if (entry != NULL) {
+      invalidate(entry);
+      shootdowns[proc_id - 1]++;
+    }
+  }
+}
+
+void tlb_print_stats(void) {
+  long total_hits = 0, total_huge_hits = 0, total_misses = 0,
+       total_replacements = 0, total_shootdowns = 0;
+
+  putchar('\n');
+  msg("--- TLB Stats ---");
+  msg("TLB Mode:          %11s",
+      tlb_mode == TLB_PRIVATE ? "private" : "shared");
+  msg("Sets x Ways:       %5d x %d", get_set_count(), TLB_WAYS);
+
+  for (int p = 0; p < 4; p++) {
+    const long lookups = hits[p] + misses[p];
+    total_hits += hits[p];
+    total_huge_hits += huge_hits[p];
+    total_misses += misses[p];
+    total_replacements += replacements[p];
+    total_shootdowns += shootdowns[p];
+
+    msg("P%d Hit Rate:       %10.2f%%", p + 1,
+        lookups > 0 ? (hits[p] / (double)lookups) * 100 : 0.0);
+  }
+
+  // every lookup costs TLB_HIT_CYCLES, plus a page walk when it misses, and
+  // every shootdown of a cached translation costs TLB_SHOOTDOWN_CYCLES
+  const long lookups = total_hits + total_misses;
+  const long cycles = lookups * TLB_HIT_CYCLES +
+                      total_misses * TLB_WALK_CYCLES +
+                      total_shootdowns * TLB_SHOOTDOWN_CYCLES;
+
+  msg("Lookups:           %11ld", lookups);
+  msg("Misses:            %11ld", total_misses);
+  msg("Replacements:      %11ld", total_replacements);
+  msg("Shootdowns:        %11ld", total_shootdowns);
+  msg("TLB Hit Rate:      %10.2f%%",
+      lookups > 0 ? (total_hits / (double)lookups) * 100 : 0.0);
+  if (huge_policy != HUGE_OFF)
+    msg("Huge Page Hits:    %11ld", total_huge_hits);
+  // pages translated by the valid entries at the time of each lookup
+  msg("Avg TLB Reach:     %11.2f pages",
+      lookups > 0 ? reach_sum / (double)lookups : 0.0);
+  msg("Translation Cycles: %10ld", cycles);
+  msg("Avg Cycles/Access: %11.2f",
+      lookups > 0 ? cycles / (double)lookups : 0.0);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "types.h"
+#include <stdbool.h>
+
+// reset the TLBs and their stats, either one TLB per process or a single one
+// shared through ASIDs, according to tlb_mode
+void tlb_init(void);
+
+// look up the translation of a page, updating its set's LRU order on a hit.
+// returns whether the translation was cached
+bool tlb_lookup(const int proc_id, const int proc_page_id);
+
+// cache the translation of a page after a TLB miss, or of the huge page holding
+// it, replacing the LRU entry of its set if it's full
+void tlb_fill(const int proc_id, const int proc_page_id);
+
+// drop the cached translations of a page being swapped out or moved, if any,
+// including the translation of a huge page holding it
+void tlb_shootdown(const int proc_id, const int proc_page_id);
+
+// print the hit rate and estimated translation cycles of every process
+void tlb_print_stats(void);
@@ -0,0 +1,166 @@
+#include "vmem_workingset.h"
+#include "types.h"
+#include "util.h"
+#include "vmem_helpers.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// documentation is provided in vmem_workingset.h
+
+extern int current_round;
+
+// a shadow entry is the eviction counter in its low bits, the eviction round
+// above it, and a marker bit telling it apart from an empty entry
+#define EVICTION_MASK ((1u << WORKINGSET_EVICTION_BITS) - 1)
+#define ROUND_MASK ((1u << WORKINGSET_ROUND_BITS) - 1)
+#define SHADOW_PRESENT                                                         \
+  (1u << (WORKINGSET_EVICTION_BITS + WORKINGSET_ROUND_BITS))
+
+// workingset state and stats of each process
+static uint32_t evictions[4];    // pages evicted, the eviction counter
+static int refaults[4];          // faults on pages with a shadow entry
+static int ws_refaults[4];       // refaults within the process' memory
+static long refault_rounds[4];   // rounds from eviction to refault, summed
+static int window_refaults[4];   // workingset refaults in this window
+static int thrashing_windows[4]; // windows the process was thrashing in
+static int hist[4][WORKINGSET_HIST_BUCKETS]; // refault distances
+
+// get the index of a process, exiting on an invalid process ID
+static inline int get_index(const int proc_id) {
+  if (proc_id < 1 || proc_id > 4) {
+    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
+    exit(10);
+  }
+
+  return proc_id - 1;
+}
+
+// get the histogram bucket of a refault distance: 0, 1, under 4, under 8, and
+// so on, the last one holding every larger distance
+static int get_bucket(const uint32_t distance) {
+  int bucket = 0;
+  for (uint32_t d = distance; d > 0 && bucket < WORKINGSET_HIST_BUCKETS - 1;
+       d >>= 1) {
+    bucket++;
+  }
+
+  return bucket;
+}
+
+void workingset_init(void) {
+  for (int p = 0; p < 4; p++) {
+    evictions[p] = 0;
+    refaults[p] = 0;
+    ws_refaults[p] = 0;
+    refault_rounds[p] = 0;
+    window_refaults[p] = 0;
+    thrashing_windows[p] = 0;
+    for (int b = 0; b < WORKINGSET_HIST_BUCKETS; b++) {
+      hist[p][b] = 0;
+    }
+  }
+}
+
+void workingset_evict(const int proc_id, const int proc_page_id) {
+  const int p = get_index(proc_id);
+
+  get_page_table(proc_id)[proc_page_id].shadow =
+      SHADOW_PRESENT |
+      (((uint32_t)current_round & ROUND_MASK) << WORKINGSET_EVICTION_BITS) |
+      (evictions[p] & EVICTION_MASK);
+  evictions[p]++;
+}
+
+void workingset_refault(const int proc_id, const int proc_page_id) {
+  const int p = get_index(proc_id);
+  page_table_entry_t *entry = &get_page_table(proc_id)[proc_page_id];
+  const uint32_t shadow = entry->shadow;
+
+  if (!(shadow & SHADOW_PRESENT))
+    return;
+  entry->shadow = 0;
+
+  // the counters wrap around, the difference of their low bits is the distance
+  // as long as it fits in them
+  const uint32_t distance = (evictions[p] - shadow) & EVICTION_MASK;
+  const uint32_t rounds =
+      ((uint32_t)current_round - (shadow >> WORKINGSET_EVICTION_BITS)) &
+      ROUND_MASK;
+  const bool in_workingset =
+      distance <= (uint32_t)get_amount_page_frames(proc_id);
+
+  refaults[p]++;
+  refault_rounds[p] += rounds;
+  hist[p][get_bucket(distance)]++;
+  if (in_workingset) {
+    ws_refaults[p]++;
+    window_refaults[p]++;
+  }
+
+  dmsg("Refault P%d: %02d, distance %u, evicted %u rounds ago%s", proc_id,
+       proc_page_id, distance, rounds, in_workingset ? " (workingset)" : "");
+}
+
+void workingset_clear(const int proc_id) {
+  page_table_entry_t *page_table = get_page_table(proc_id);
+
+  for (int page = 0; page < PROC_MAX_PAGES; page++) {
+    page_table[page].shadow = 0;
+  }
+}
+
+void workingset_sample(void) {
+  if (current_round % WORKINGSET_WINDOW != 0)
+    return;
+
+  for (int p = 0; p < 4; p++) {
+    if (window_refaults[p] >= WORKINGSET_THRASH_REFAULTS) {
+      thrashing_windows[p]++;
+      msg("Workingset: P%d thrashing, %d workingset refaults in %d rounds",
+          p + 1, window_refaults[p], WORKINGSET_WINDOW);
+    }
+    window_refaults[p] = 0;
+  }
+}
+
+void workingset_print_stats(void) {
+  putchar('\n');
+  msg("--- Workingset Stats ---");
+
+  for (int p = 0; p < 4; p++) {
+    int shadows = 0;
+    for (int page = 0; page < PROC_MAX_PAGES; page++) {
+      if (get_page_table(p + 1)[page].shadow & SHADOW_PRESENT)
+        shadows++;
+    }
+
+    if (p > 0)
+      putchar('\n');
+    msg("Process:           %11d", p + 1);
+    msg("Evictions:         %11u", evictions[p]);
+    msg("Shadow Entries:    %11d", shadows);
+    msg("Refaults:          %11d", refaults[p]);
+    msg("Workingset Faults: %11d", ws_refaults[p]);
+    msg("Workingset Rate:   %10.2f%%",
+        refaults[p] > 0 ? (ws_refaults[p] / (double)refaults[p]) * 100 : 0.0);
+    msg("Avg Refault Time:  %11.2f rounds",
+        refaults[p] > 0 ? refault_rounds[p] / (double)refaults[p] : 0.0);
+    msg("Thrashing Windows: %11d", thrashing_windows[p]);
+
+    // a refault at distance d would have been a hit with about d more frames
+    msg("Refault Distance   Refaults");
+    for (int b = 0; b < WORKINGSET_HIST_BUCKETS; b++) {
+      if (hist[p][b] == 0)
+        continue;
+
+      if (b == 0)
+        msg("  =  %-8d %10d", 0, hist[p][b]);
+      else if (b == WORKINGSET_HIST_BUCKETS - 1)
+        msg("  >= %-8d %10d", 1 << (b - 1), hist[p][b]);
+      else
+        msg("  <  %-8d %10d", 1 << b, hist[p][b]);
+    }
+  }
+}
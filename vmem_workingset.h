@@ -0,0 +1,26 @@
+#pragma once
+
+#include "types.h"
+#include <stdbool.h>
+
+// reset the eviction counters and the workingset stats
+void workingset_init(void);
+
+// record the shadow entry of a page being evicted, in its page table entry
+void workingset_evict(const int proc_id, const int proc_page_id);
+
+// account the refault of a page being loaded back, if it has a shadow entry,
+// from its refault distance and the page frames its process holds, dropping
+// the shadow entry
+void workingset_refault(const int proc_id, const int proc_page_id);
+
+// drop the shadow entries of an exiting process' pages
+void workingset_clear(const int proc_id);
+
+// flag the processes thrashing during the window ending with this round, at the
+// end of each round
+void workingset_sample(void);
+
+// print the evictions, refaults, refault distance histogram and thrashing
+// windows of every process
+void workingset_print_stats(void);
@@ -0,0 +1,138 @@
+#include "vmem_wscurve.h"
+#include "types.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// documentation is provided in vmem_wscurve.h
+
+// a reference at virtual time t to a page next referenced at t + g is in the
+// working set of window k for min(k, g) references, and the next one faults
+// for every k < g. the last reference to a page stays in it until the end of
+// the reference string, or min(k, T - t) references. summing both over the
+// gaps gives the working set size of every k in O(WSCURVE_MAX_K), with
+// s(k + 1) = s(k) + m(k) as Denning showed, but without the boundary error
+
+// reference string state and gap histograms of each process, gaps past
+// WSCURVE_MAX_K kept in the last bucket
+static long vtime[4];                         // references made
+static long last_ref[4][PROC_MAX_PAGES];      // -1 if never referenced
+static long first_refs[4];                    // references with no gap
+static long gaps[4][WSCURVE_MAX_K + 2];       // gaps between two references
+static long residuals[4][WSCURVE_MAX_K + 2];  // gaps from a last reference
+
+// get the index of a process, exiting on an invalid process ID
+static inline int get_index(const int proc_id) {
+  if (proc_id < 1 || proc_id > 4) {
+    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
+    exit(10);
+  }
+
+  return proc_id - 1;
+}
+
+// get the histogram bucket of a gap
+static inline int get_bucket(const long gap) {
+  return gap > WSCURVE_MAX_K ? WSCURVE_MAX_K + 1 : (int)gap;
+}
+
+// get the average working set size of a process with window k
+static double get_ws_size(const int p, const int k) {
+  long covered = 0;
+  for (int g = 1; g <= WSCURVE_MAX_K + 1; g++) {
+    covered += (gaps[p][g] + residuals[p][g]) * (g < k ? g : k);
+  }
+
+  return vtime[p] > 0 ? covered / (double)vtime[p] : 0.0;
+}
+
+// get the references of a process that fault with window k
+static long get_ws_faults(const int p, const int k) {
+  long faults = first_refs[p];
+  for (int g = k + 1; g <= WSCURVE_MAX_K + 1; g++) {
+    faults += gaps[p][g];
+  }
+
+  return faults;
+}
+
+void wscurve_init(void) {
+  for (int p = 0; p < 4; p++) {
+    vtime[p] = 0;
+    first_refs[p] = 0;
+    for (int page = 0; page < PROC_MAX_PAGES; page++) {
+      last_ref[p][page] = -1;
+    }
+    for (int g = 0; g <= WSCURVE_MAX_K + 1; g++) {
+      gaps[p][g] = 0;
+      residuals[p][g] = 0;
+    }
+  }
+}
+
+void wscurve_access(const int proc_id, const int proc_page_id) {
+  const int p = get_index(proc_id);
+
+  if (last_ref[p][proc_page_id] == -1)
+    first_refs[p]++;
+  else
+    gaps[p][get_bucket(vtime[p] - last_ref[p][proc_page_id])]++;
+
+  last_ref[p][proc_page_id] = vtime[p]++;
+}
+
+void wscurve_exit(const int proc_id) {
+  const int p = get_index(proc_id);
+
+  for (int page = 0; page < PROC_MAX_PAGES; page++) {
+    if (last_ref[p][page] == -1)
+      continue;
+
+    residuals[p][get_bucket(vtime[p] - last_ref[p][page])]++;
+    last_ref[p][page] = -1;
+  }
+}
+
+void wscurve_print_stats(void) {
+  // the reference strings of running processes end here
+  for (int proc_id = 1; proc_id <= 4; proc_id++) {
+    wscurve_exit(proc_id);
+  }
+
+  long total_refs = 0;
+  for (int p = 0; p < 4; p++) {
+    total_refs += vtime[p];
+  }
+
+  putchar('\n');
+  msg("--- Working Set Curve ---");
+  msg("  k    P1    P2    P3    P4  Total    P1%%    P2%%    P3%%    P4%%"
+      "   All%%");
+
+  int best_k = 0;
+  for (int k = 1; k <= WSCURVE_MAX_K; k++) {
+    double size[4], rate[4], total_size = 0;
+    long total_faults = 0;
+
+    for (int p = 0; p < 4; p++) {
+      const long faults = get_ws_faults(p, k);
+
+      size[p] = get_ws_size(p, k);
+      rate[p] = vtime[p] > 0 ? (faults / (double)vtime[p]) * 100 : 0.0;
+      total_size += size[p];
+      total_faults += faults;
+    }
+
+    // the processes' working sets fit in main memory on average, and k is one
+    // WS accepts
+    if (total_size <= RAM_MAX_PAGES && k <= RAM_MAX_PAGES)
+      best_k = k;
+
+    msg("%3d %5.2f %5.2f %5.2f %5.2f %6.2f %6.2f %6.2f %6.2f %6.2f %6.2f", k,
+        size[0], size[1], size[2], size[3], total_size, rate[0], rate[1],
+        rate[2], rate[3],
+        total_refs > 0 ? (total_faults / (double)total_refs) * 100 : 0.0);
+  }
+
+  msg("Largest Fitting k: %11d", best_k);
+}
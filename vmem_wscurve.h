@@ -0,0 +1,19 @@
+#pragma once
+
+#include "types.h"
+#include <stdbool.h>
+
+// reset the reference times and gap histograms of every process
+void wscurve_init(void);
+
+// record a reference by a process to one of its pages, adding the gap since
+// the page's previous reference
+void wscurve_access(const int proc_id, const int proc_page_id);
+
+// close the reference string of an exiting process, whose pages start over
+// if it's spawned again
+void wscurve_exit(const int proc_id);
+
+// print the average working set size and fault rate of every process for
+// every window size k, and the largest k whose working sets fit in main memory
+void wscurve_print_stats(void);
@@ -0,0 +1,205 @@
+#include "vmem_zswap.h"
+#include "types.h"
+#include "util.h"
+#include "vmem_helpers.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// documentation is provided in vmem_zswap.h
+
+// pool entry of every page of every process, indexed by get_index()
+static zswap_entry_t entries[4 * PROC_MAX_PAGES];
+// least and most recently stored entries, -1 if the pool is empty
+static int lru_head;
+static int lru_tail;
+// compressed size of the stored pages, in percent of a page
+static int pool_used;
+// pool stats
+static int stores;         // pages compressed into the pool
+static int dirty_stores;   // those whose writeback the pool took over
+static int rejected;       // pages compressing too poorly to be stored
+static int loads;          // pages loaded back from the pool
+static int writebacks;     // dirty pages written back to make room
+static int dropped;        // clean pages dropped to make room
+static long stored_size;   // compressed size of every stored page, summed
+static int peak_used;      // most of the pool in use at once
+
+// get the pool capacity, in percent of a page
+static inline int get_capacity(void) { return ZSWAP_POOL_FRAMES * 100; }
+
+// get the index of a page's entry
+static inline int get_index(const int proc_id, const int proc_page_id) {
+  if (proc_id < 1 || proc_id > 4) {
+    fprintf(stderr, "Invalid process ID: %d\n", proc_id);
+    exit(10);
+  }
+
+  return (proc_id - 1) * PROC_MAX_PAGES + proc_page_id;
+}
+
+// get the compressed size of a page, in percent of a page. simulated pages
+// have no contents, so the size is drawn from a hash of the page and of its
+// write count, so that it stays the same until the page is written to
+static int get_compressed_size(const int proc_id, const int proc_page_id) {
+  uint32_t h = (uint32_t)get_index(proc_id, proc_page_id) * 2654435761u ^
+               (uint32_t)get_page_table(proc_id)[proc_page_id].write_count *
+                   2246822519u;
+  h ^= h >> 15;
+  h *= 2246822519u;
+  h ^= h >> 13;
+
+  return ZSWAP_MIN_SIZE_PCT +
+         (int)(h % (ZSWAP_MAX_SIZE_PCT - ZSWAP_MIN_SIZE_PCT + 1));
+}
+
+// remove an entry from the pool
+static void remove_entry(const int index) {
+  zswap_entry_t *entry = &entries[index];
+  assert(entry->stored);
+
+  if (entry->prev != -1)
+    entries[entry->prev].next = entry->next;
+  else
+    lru_head = entry->next;
+
+  if (entry->next != -1)
+    entries[entry->next].prev = entry->prev;
+  else
+    lru_tail = entry->prev;
+
+  pool_used -= entry->size;
+  *entry = (zswap_entry_t){false, false, 0, -1, -1};
+}
+
+// make room in the pool by writing back its least recently stored page, or
+// dropping it if the backing store already holds its contents
+static void shrink_pool(void) {
+  assert(lru_head != -1);
+  const int index = lru_head;
+
+  if (entries[index].dirty)
+    writebacks++;
+  else
+    dropped++;
+
+  dmsg("zswap: %s P%d page %02d",
+       entries[index].dirty ? "wrote back" : "dropped",
+       index / PROC_MAX_PAGES + 1, index % PROC_MAX_PAGES);
+  remove_entry(index);
+}
+
+void zswap_init(void) {
+  assert(ZSWAP_POOL_FRAMES >= 1 && ZSWAP_POOL_FRAMES < RAM_MAX_PAGES);
+  assert(ZSWAP_MIN_SIZE_PCT > 0 && ZSWAP_MIN_SIZE_PCT <= ZSWAP_MAX_SIZE_PCT);
+  assert(ZSWAP_MAX_SIZE_PCT <= 100);
+
+  for (int i = 0; i < 4 * PROC_MAX_PAGES; i++) {
+    entries[i] = (zswap_entry_t){false, false, 0, -1, -1};
+  }
+
+  lru_head = -1;
+  lru_tail = -1;
+  pool_used = 0;
+  stores = 0;
+  dirty_stores = 0;
+  rejected = 0;
+  loads = 0;
+  writebacks = 0;
+  dropped = 0;
+  stored_size = 0;
+  peak_used = 0;
+}
+
+bool zswap_store(const int proc_id, const int proc_page_id, const bool dirty) {
+  const int index = get_index(proc_id, proc_page_id);
+  const int size = get_compressed_size(proc_id, proc_page_id);
+  assert(!entries[index].stored); // a page in memory isn't in the pool
+
+  if (size > ZSWAP_REJECT_PCT) {
+    rejected++;
+    return false;
+  }
+
+  while (pool_used + size > get_capacity()) {
+    shrink_pool();
+  }
+
+  entries[index] = (zswap_entry_t){true, dirty, size, lru_tail, -1};
+  if (lru_tail != -1)
+    entries[lru_tail].next = index;
+  else
+    lru_head = index;
+  lru_tail = index;
+
+  pool_used += size;
+  if (pool_used > peak_used)
+    peak_used = pool_used;
+  stores++;
+  stored_size += size;
+  if (dirty)
+    dirty_stores++;
+
+  dmsg("zswap: stored P%d page %02d (%d%%)", proc_id, proc_page_id, size);
+  return true;
+}
+
+bool zswap_load(const int proc_id, const int proc_page_id) {
+  const int index = get_index(proc_id, proc_page_id);
+  if (!entries[index].stored)
+    return false;
+
+  if (entries[index].dirty)
+    set_modified(proc_id, proc_page_id, true);
+  remove_entry(index);
+  loads++;
+
+  return true;
+}
+
+void zswap_invalidate(const int proc_id, const int proc_page_id) {
+  const int index = get_index(proc_id, proc_page_id);
+
+  if (entries[index].stored)
+    remove_entry(index);
+}
+
+void zswap_clear(const int proc_id) {
+  for (int page = 0; page < PROC_MAX_PAGES; page++) {
+    zswap_invalidate(proc_id, page);
+  }
+}
+
+int zswap_get_loads(void) { return loads; }
+
+int zswap_get_writebacks(void) { return writebacks; }
+
+void zswap_print_stats(const int pool_faults, const int swap_faults) {
+  const int faults = pool_faults + swap_faults;
+  const long latency = (long)pool_faults * ZSWAP_LOAD_TIME +
+                       (long)swap_faults * EVENT_SWAP_IN_TIME;
+
+  putchar('\n');
+  msg("--- Zswap Stats ---");
+  msg("Pool Frames:       %11d", ZSWAP_POOL_FRAMES);
+  msg("Stored Pages:      %11d", stores);
+  msg("Dirty Stores:      %11d", dirty_stores);
+  msg("Rejected Pages:    %11d", rejected);
+  msg("Loaded Pages:      %11d", loads);
+  msg("Pool Writebacks:   %11d", writebacks);
+  msg("Dropped Pages:     %11d", dropped);
+  msg("Compression Ratio: %11.2f",
+      stored_size > 0 ? stores * 100 / (double)stored_size : 0.0);
+  msg("Final Pool Usage:  %10.2f%%", pool_used / (double)get_capacity() * 100);
+  msg("Peak Pool Usage:   %10.2f%%", peak_used / (double)get_capacity() * 100);
+  // faults by the tier holding the faulting page, with their latency in
+  // event-driven time units, without queueing on the swap device
+  msg("Pool Faults:       %11d", pool_faults);
+  msg("Swap Faults:       %11d", swap_faults);
+  msg("Pool Fault Share:  %10.2f%%",
+      faults > 0 ? (pool_faults / (double)faults) * 100 : 0.0);
+  msg("Fault Latency:     %11ld", latency);
+  msg("Avg Fault Latency: %11.2f", faults > 0 ? latency / (double)faults : 0.0);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "types.h"
+#include <stdbool.h>
+
+// empty the zswap pool and reset its stats
+void zswap_init(void);
+
+// compress a page being evicted into the pool, writing back or dropping the
+// least recently stored pages until it fits. returns whether the page was
+// stored, or rejected for compressing too poorly
+bool zswap_store(const int proc_id, const int proc_page_id, const bool dirty);
+
+// take a page being loaded into memory out of the pool, if it's there. a page
+// whose latest contents were only in the pool is marked modified, as it must
+// be written back before being replaced. returns whether it was in the pool
+bool zswap_load(const int proc_id, const int proc_page_id);
+
+// drop a page from the pool, without writing it back, as its contents are gone
+void zswap_invalidate(const int proc_id, const int proc_page_id);
+
+// drop every page of an exiting process from the pool
+void zswap_clear(const int proc_id);
+
+// get the amount of pages loaded from the pool, each saving a read from the
+// backing store
+int zswap_get_loads(void);
+
+// get the amount of dirty pages written back from the pool to the backing store
+int zswap_get_writebacks(void);
+
+// print the pool usage and compression stats, and the latency of faults by
+// tier, given the faults served from the pool and from the backing store
+void zswap_print_stats(const int pool_faults, const int swap_faults);